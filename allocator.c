@@ -90,18 +90,16 @@ static struct CJSON_ArenaNode *CJSON_ArenaNode_new(const unsigned size) {
     return node;
 }
 
-static bool CJSON_Arena_create_next_node(struct CJSON_Arena *const arena, const unsigned size) {
+//when grow is true the new node is at least twice as big as the current one so an arena that wasn't reserved up front
+//only needs a logarithmic number of nodes
+static bool CJSON_Arena_create_next_node(struct CJSON_Arena *const arena, const unsigned size, const bool grow) {
     assert(arena != NULL);
     assert(size > 0);
 
     unsigned node_size = arena->current->size;
-    if(node_size < size) {
-        if(node_size > UINT_MAX / 2U) {
-            node_size = size;
-        } else do {
-            node_size *= 2U;
-        } while(node_size < size);
-    }
+    if(grow || node_size < size) do {
+        node_size = node_size > UINT_MAX / 2U ? MAX(node_size, size) : node_size * 2U;
+    } while(node_size < size);
 
     struct CJSON_ArenaNode *const current = arena->current;
     struct CJSON_ArenaNode *const next    = current->next;
@@ -134,6 +132,8 @@ static bool CJSON_Arena_create_next_node(struct CJSON_Arena *const arena, const
         return false;
     }
 
+    //a node emptied by CJSON_Arena_reset
+    arena->current = next;
     return true;
 }
 
@@ -195,8 +195,46 @@ EXTERN_C void CJSON_Arena_free(struct CJSON_Arena *const arena) {
 EXTERN_C void CJSON_Arena_reset(struct CJSON_Arena *const arena) {
     assert(arena != NULL);
     
-    arena->current      = arena->head;
-    arena->head->offset = 0U;
+    //the memory given by an arena is zeroed like a new node, the objects rely on it for their empty entries
+    for(struct CJSON_ArenaNode *node = arena->head; node != NULL; node = node->next) {
+        memset(CJSON_GET_DATA(node), 0, (size_t)node->offset);
+        node->offset = 0U;
+    }
+
+    arena->current = arena->head;
+}
+
+EXTERN_C void CJSON_Arena_merge(struct CJSON_Arena *const arena, struct CJSON_Arena *const other) {
+    assert(arena != NULL);
+    assert(other != NULL);
+    assert(arena != other);
+
+    if(other->head == NULL) {
+        return;
+    }
+
+    if(arena->head == NULL) {
+        arena->head       = other->head;
+        arena->current    = other->current;
+        arena->node_count = other->node_count;
+    } else {
+        //the nodes after the current one are empty and stay after the merged ones
+        struct CJSON_ArenaNode *tail = other->head;
+        while(tail->next != NULL) {
+            tail = tail->next;
+        }
+
+        tail->next            = arena->current->next;
+        arena->current->next  = other->head;
+        arena->current        = other->current;
+        arena->node_count    += other->node_count;
+    }
+
+#ifndef NDEBUG
+    CJSON_Arena_init(other, other->node_max, other->name);
+#else
+    CJSON_Arena_init(other, other->node_max, NULL);
+#endif
 }
 
 EXTERN_C void *CJSON_Arena_alloc_objects(struct CJSON_Arena *const arena, const unsigned count, const unsigned size, const unsigned alignment) {
@@ -229,7 +267,7 @@ EXTERN_C void *CJSON_Arena_alloc(struct CJSON_Arena *const arena, const unsigned
     unsigned padding              = (unsigned)(aligned_address - start_address);
 
     if(arena->current->offset + padding + size > arena->current->size) {
-        if(!CJSON_Arena_create_next_node(arena, size)) {
+        if(!CJSON_Arena_create_next_node(arena, size, true)) {
             return NULL;
         }
 
@@ -262,7 +300,7 @@ bool CJSON_Arena_reserve(struct CJSON_Arena *const arena, const unsigned size, u
         return true;
     }
 
-    return CJSON_Arena_create_next_node(arena, size);
+    return CJSON_Arena_create_next_node(arena, size, false);
 }
 
 
@@ -285,4 +323,23 @@ EXTERN_C char *CJSON_Arena_strdup(struct CJSON_Arena *const arena, const char *c
     }
     
     return strcpy(copy, str);
+}
+
+EXTERN_C char *CJSON_Arena_strndup(struct CJSON_Arena *const arena, const char *const str, const unsigned length) {
+    assert(arena != NULL);
+    assert(str != NULL);
+
+    if(length == UINT_MAX) {
+        return NULL;
+    }
+
+    char *const copy = CJSON_ARENA_ALLOC(arena, length + 1U, char);
+    if(copy == NULL) {
+        return NULL;
+    }
+
+    memcpy(copy, str, (size_t)length);
+    copy[length] = '\0';
+
+    return copy;
 }
\ No newline at end of file
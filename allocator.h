@@ -42,10 +42,14 @@ void  CJSON_Arena_init         (struct CJSON_Arena*, unsigned node_max, const ch
 bool  CJSON_Arena_create_node  (struct CJSON_Arena*, unsigned size);
 void  CJSON_Arena_free         (struct CJSON_Arena*);
 void  CJSON_Arena_reset        (struct CJSON_Arena*);
+//moves the nodes of the other arena in this one, the other arena is left empty
+void  CJSON_Arena_merge        (struct CJSON_Arena*, struct CJSON_Arena *other);
 void *CJSON_Arena_alloc_objects(struct CJSON_Arena*, unsigned count, unsigned size, unsigned alignment);
 void *CJSON_Arena_alloc        (struct CJSON_Arena*, unsigned size, unsigned alignment);
 bool  CJSON_Arena_reserve      (struct CJSON_Arena*, unsigned size, unsigned alignment);
 char *CJSON_Arena_strdup       (struct CJSON_Arena*, const char *str, unsigned *length);
+//copies length bytes that can include NUL characters and terminates the copy
+char *CJSON_Arena_strndup      (struct CJSON_Arena*, const char *str, unsigned length);
 
 #ifndef NDEBUG
 
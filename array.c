@@ -120,6 +120,20 @@ EXTERN_C const char *CJSON_Array_get_string(const struct CJSON_Array *const arra
     return CJSON_as_string(json, success);
 }
 
+EXTERN_C const char *CJSON_Array_get_string_n(const struct CJSON_Array *const array, const unsigned index, unsigned *const length, bool *const success) {
+    assert(array != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    struct CJSON *const json = CJSON_Array_get(array, index);
+    if(json == NULL) {
+        *success = false;
+        return NULL;
+    }
+
+    return CJSON_as_string_n(json, length, success);
+}
+
 EXTERN_C double CJSON_Array_get_float64(const struct CJSON_Array *const array, const unsigned index, bool *const success) {
     assert(array != NULL);
     assert(success != NULL);
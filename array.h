@@ -24,6 +24,7 @@ struct CJSON        *CJSON_Array_get        (const struct CJSON_Array*, unsigned
 bool                 CJSON_Array_set        (struct CJSON_Array*, struct CJSON_Parser*, unsigned index, const struct CJSON *);
 bool                 CJSON_Array_push       (struct CJSON_Array*, struct CJSON_Parser*, const struct CJSON*);
 const char          *CJSON_Array_get_string (const struct CJSON_Array*, unsigned index, bool *success);
+const char          *CJSON_Array_get_string_n(const struct CJSON_Array*, unsigned index, unsigned *length, bool *success);
 double               CJSON_Array_get_float64(const struct CJSON_Array*, unsigned index, bool *success);
 int64_t              CJSON_Array_get_int64  (const struct CJSON_Array*, unsigned index, bool *success);
 uint64_t             CJSON_Array_get_uint64 (const struct CJSON_Array*, unsigned index, bool *success);
@@ -0,0 +1,340 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "builder.h"
+#include "decoder.h"
+#include "parser.h"
+#include "allocator.h"
+#include "util.h"
+
+static struct CJSON_KV *CJSON_Builder_next_entry(struct CJSON_Builder *const builder) {
+    assert(builder != NULL);
+
+    if(builder->scratch_count == builder->scratch_capacity) {
+        bool success;
+        unsigned capacity = CJSON_safe_unsigned_mult(builder->scratch_capacity, 2U, &success);
+        if(!success) {
+            return NULL;
+        }
+        if(capacity < CJSON_BUILDER_MINIMUM_CAPACITY) {
+            capacity = CJSON_BUILDER_MINIMUM_CAPACITY;
+        }
+
+        struct CJSON_KV *const scratch = (struct CJSON_KV*)CJSON_REALLOC(builder->scratch, (size_t)capacity * sizeof(*scratch));
+        if(scratch == NULL) {
+            return NULL;
+        }
+
+        builder->scratch          = scratch;
+        builder->scratch_capacity = capacity;
+    }
+
+    return builder->scratch + builder->scratch_count++;
+}
+
+static bool CJSON_Builder_fail(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser, const struct CJSON_Token *const token, const enum CJSON_Error error) {
+    assert(builder != NULL);
+    assert(parser != NULL);
+    assert(token != NULL);
+
+    if(token->type != CJSON_TOKEN_DONE) {
+        parser->error = error;
+    } else if(builder->depth == 0U) {
+        parser->error = CJSON_ERROR_TOKEN;
+    } else if(builder->frames[builder->depth - 1U].type == CJSON_ARRAY) {
+        parser->error = CJSON_ERROR_ARRAY;
+    } else {
+        parser->error = CJSON_ERROR_OBJECT;
+    }
+
+    return false;
+}
+
+static bool CJSON_Builder_add(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser, const struct CJSON *const value) {
+    assert(builder != NULL);
+    assert(parser != NULL);
+    assert(value != NULL);
+
+    if(builder->depth == 0U) {
+        *builder->root = *value;
+        builder->state = CJSON_BUILDER_STATE_DONE;
+        return true;
+    }
+
+    if(builder->frames[builder->depth - 1U].type == CJSON_ARRAY) {
+        struct CJSON_KV *const entry = CJSON_Builder_next_entry(builder);
+        if(entry == NULL) {
+            parser->error = CJSON_ERROR_MEMORY;
+            return false;
+        }
+        entry->key        = NULL;
+        entry->key_length = 0U;
+        entry->value      = *value;
+    } else {
+        assert(builder->scratch_count > 0U);
+        builder->scratch[builder->scratch_count - 1U].value = *value;
+    }
+
+    builder->state = CJSON_BUILDER_STATE_NEXT;
+    return true;
+}
+
+static bool CJSON_Builder_open(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser, const enum CJSON_Type type) {
+    assert(builder != NULL);
+    assert(parser != NULL);
+
+    if(builder->depth >= parser->max_depth) {
+        parser->error = CJSON_ERROR_DEPTH;
+        return false;
+    }
+
+    if(builder->depth == builder->frames_capacity) {
+        bool success;
+        unsigned capacity = CJSON_safe_unsigned_mult(builder->frames_capacity, 2U, &success);
+        if(capacity < CJSON_BUILDER_MINIMUM_CAPACITY) {
+            capacity = CJSON_BUILDER_MINIMUM_CAPACITY;
+        }
+
+        struct CJSON_Builder_Frame *const frames = success
+            ? (struct CJSON_Builder_Frame*)CJSON_REALLOC(builder->frames, (size_t)capacity * sizeof(*frames))
+            : NULL;
+        if(frames == NULL) {
+            parser->error = CJSON_ERROR_MEMORY;
+            return false;
+        }
+
+        builder->frames          = frames;
+        builder->frames_capacity = capacity;
+    }
+
+    struct CJSON_Builder_Frame *const frame = builder->frames + builder->depth++;
+    frame->start = builder->scratch_count;
+    frame->type  = type;
+
+    builder->state = type == CJSON_ARRAY ? CJSON_BUILDER_STATE_ARRAY_FIRST : CJSON_BUILDER_STATE_OBJECT_FIRST;
+    return true;
+}
+
+static bool CJSON_Builder_close(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser) {
+    assert(builder != NULL);
+    assert(parser != NULL);
+    assert(builder->depth > 0U);
+
+    const struct CJSON_Builder_Frame frame    = builder->frames[--builder->depth];
+    const struct CJSON_KV *const     elements = builder->scratch + frame.start;
+    const unsigned                   count    = builder->scratch_count - frame.start;
+
+    struct CJSON value;
+    value.type = frame.type;
+
+    if(frame.type == CJSON_ARRAY) {
+        struct CJSON_Array *const array = &value.value.array;
+        CJSON_Array_init(array);
+        if(!CJSON_Array_reserve(array, parser, count)) {
+            parser->error = CJSON_ERROR_MEMORY;
+            return false;
+        }
+
+        for(unsigned i = 0U; i < count; i++) {
+            array->values[i] = elements[i].value;
+        }
+        array->count = count;
+    } else {
+        struct CJSON_Object *const object = &value.value.object;
+        if(!CJSON_Object_start(object, parser, count)) {
+            parser->error = CJSON_ERROR_MEMORY;
+            return false;
+        }
+
+        for(unsigned i = 0U; i < count; i++) {
+            struct CJSON *const member = CJSON_Object_add(object, parser, elements[i].key, elements[i].key_length, elements[i].hash);
+            if(member == NULL) {
+                parser->error = CJSON_ERROR_MEMORY;
+                return false;
+            }
+            *member = elements[i].value;
+        }
+        CJSON_Object_finish(object, parser);
+    }
+
+    builder->scratch_count = frame.start;
+    return CJSON_Builder_add(builder, parser, &value);
+}
+
+static bool CJSON_Builder_key(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser, const char *const data, const struct CJSON_Token *const token) {
+    assert(builder != NULL);
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+
+    if(token->type != CJSON_TOKEN_STRING) {
+        return CJSON_Builder_fail(builder, parser, token, CJSON_ERROR_OBJECT_KEY);
+    }
+
+    struct CJSON_String key;
+    unsigned            hash;
+    if(!CJSON_decode_key(parser, &key, &hash, data, token)) {
+        parser->error = CJSON_ERROR_OBJECT_KEY;
+        return false;
+    }
+
+    struct CJSON_KV *const entry = CJSON_Builder_next_entry(builder);
+    if(entry == NULL) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return false;
+    }
+    entry->key        = key.chars;
+    entry->key_length = key.length;
+    entry->hash       = hash;
+    CJSON_set_null(&entry->value);
+
+    builder->state = CJSON_BUILDER_STATE_COLON;
+    return true;
+}
+
+static bool CJSON_Builder_value(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser, const char *const data, const struct CJSON_Token *const token) {
+    assert(builder != NULL);
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+
+    struct CJSON value;
+
+    switch(token->type) {
+    case CJSON_TOKEN_STRING:
+        if(!CJSON_decode_string(parser, &value.value.string, data, token)) {
+            parser->error = CJSON_ERROR_STRING;
+            return false;
+        }
+        value.type = CJSON_STRING;
+        break;
+
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT:
+        if(!CJSON_decode_number(parser, &value, data, token)) {
+            return false;
+        }
+        break;
+
+    case CJSON_TOKEN_BOOL:
+        CJSON_set_bool(&value, data[token->offset] == 't');
+        break;
+
+    case CJSON_TOKEN_NULL:
+        CJSON_set_null(&value);
+        break;
+
+    case CJSON_TOKEN_LBRACKET:
+        return CJSON_Builder_open(builder, parser, CJSON_ARRAY);
+
+    case CJSON_TOKEN_LCURLY:
+        return CJSON_Builder_open(builder, parser, CJSON_OBJECT);
+
+    default:
+        if(builder->depth == 0U) {
+            return CJSON_Builder_fail(builder, parser, token, CJSON_ERROR_TOKEN);
+        }
+        if(builder->frames[builder->depth - 1U].type == CJSON_ARRAY) {
+            return CJSON_Builder_fail(builder, parser, token, CJSON_ERROR_ARRAY_VALUE);
+        }
+        return CJSON_Builder_fail(builder, parser, token, CJSON_ERROR_OBJECT_VALUE);
+    }
+
+    return CJSON_Builder_add(builder, parser, &value);
+}
+
+EXTERN_C void CJSON_Builder_init(struct CJSON_Builder *const builder) {
+    assert(builder != NULL);
+
+    builder->scratch          = NULL;
+    builder->frames           = NULL;
+    builder->scratch_capacity = 0U;
+    builder->frames_capacity  = 0U;
+    CJSON_Builder_reset(builder, NULL);
+}
+
+EXTERN_C void CJSON_Builder_free(struct CJSON_Builder *const builder) {
+    assert(builder != NULL);
+
+    CJSON_FREE(builder->scratch);
+    CJSON_FREE(builder->frames);
+    CJSON_Builder_init(builder);
+}
+
+EXTERN_C void CJSON_Builder_reset(struct CJSON_Builder *const builder, struct CJSON *const root) {
+    assert(builder != NULL);
+
+    builder->root          = root;
+    builder->scratch_count = 0U;
+    builder->depth         = 0U;
+    builder->state         = CJSON_BUILDER_STATE_VALUE;
+}
+
+EXTERN_C bool CJSON_Builder_push(struct CJSON_Builder *const builder, struct CJSON_Parser *const parser, const char *const data, const struct CJSON_Token *const token) {
+    assert(builder != NULL);
+    assert(builder->root != NULL);
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+
+    switch(builder->state) {
+    case CJSON_BUILDER_STATE_VALUE:
+        return CJSON_Builder_value(builder, parser, data, token);
+
+    case CJSON_BUILDER_STATE_ARRAY_FIRST:
+        if(token->type == CJSON_TOKEN_RBRACKET) {
+            return CJSON_Builder_close(builder, parser);
+        }
+        return CJSON_Builder_value(builder, parser, data, token);
+
+    case CJSON_BUILDER_STATE_OBJECT_FIRST:
+        if(token->type == CJSON_TOKEN_RCURLY) {
+            return CJSON_Builder_close(builder, parser);
+        }
+        return CJSON_Builder_key(builder, parser, data, token);
+
+    case CJSON_BUILDER_STATE_KEY:
+        return CJSON_Builder_key(builder, parser, data, token);
+
+    case CJSON_BUILDER_STATE_COLON:
+        if(token->type != CJSON_TOKEN_COLON) {
+            return CJSON_Builder_fail(builder, parser, token, CJSON_ERROR_MISSING_COLON);
+        }
+        builder->state = CJSON_BUILDER_STATE_VALUE;
+        return true;
+
+    case CJSON_BUILDER_STATE_NEXT: {
+        const bool is_array = builder->frames[builder->depth - 1U].type == CJSON_ARRAY;
+        if(token->type == CJSON_TOKEN_COMMA) {
+            builder->state = is_array ? CJSON_BUILDER_STATE_VALUE : CJSON_BUILDER_STATE_KEY;
+            return true;
+        }
+        if(token->type == (is_array ? CJSON_TOKEN_RBRACKET : CJSON_TOKEN_RCURLY)) {
+            return CJSON_Builder_close(builder, parser);
+        }
+        return CJSON_Builder_fail(
+            builder,
+            parser,
+            token,
+            is_array ? CJSON_ERROR_MISSING_COMMA_OR_RBRACKET : CJSON_ERROR_MISSING_COMMA_OR_RCURLY
+        );
+    }
+
+    //like CJSON_parse, nothing can follow the root value
+    case CJSON_BUILDER_STATE_DONE:
+        if(token->type != CJSON_TOKEN_DONE) {
+            return CJSON_Builder_fail(builder, parser, token, CJSON_ERROR_TOKEN);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+EXTERN_C bool CJSON_Builder_is_done(const struct CJSON_Builder *const builder) {
+    assert(builder != NULL);
+
+    return builder->state == CJSON_BUILDER_STATE_DONE;
+}
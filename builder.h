@@ -0,0 +1,53 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_BUILDER_H
+#define CJSON_BUILDER_H
+
+#define CJSON_BUILDER_MINIMUM_CAPACITY 64U
+
+#include <stdbool.h>
+#include "json.h"
+#include "token.h"
+
+enum CJSON_Builder_State {
+    CJSON_BUILDER_STATE_VALUE,
+    CJSON_BUILDER_STATE_ARRAY_FIRST,
+    CJSON_BUILDER_STATE_OBJECT_FIRST,
+    CJSON_BUILDER_STATE_KEY,
+    CJSON_BUILDER_STATE_COLON,
+    CJSON_BUILDER_STATE_NEXT,
+    CJSON_BUILDER_STATE_DONE
+};
+
+//a container that is still open, its elements are scratch[start..scratch_count)
+struct CJSON_Builder_Frame {
+    unsigned        start;
+    enum CJSON_Type type;
+};
+
+//builds a DOM one token at a time. The elements of the open containers are kept on a scratch stack
+//and copied into the parser arenas once the container closes so the final size is known.
+struct CJSON_Builder {
+    struct CJSON_KV            *scratch;
+    struct CJSON_Builder_Frame *frames;
+    struct CJSON               *root;
+    unsigned                    scratch_count,
+                                scratch_capacity,
+                                depth,
+                                frames_capacity;
+    enum CJSON_Builder_State    state;
+};
+
+void CJSON_Builder_init   (struct CJSON_Builder*);
+void CJSON_Builder_free   (struct CJSON_Builder*);
+void CJSON_Builder_reset  (struct CJSON_Builder*, struct CJSON *root);
+bool CJSON_Builder_push   (struct CJSON_Builder*, struct CJSON_Parser*, const char *data, const struct CJSON_Token*);
+bool CJSON_Builder_is_done(const struct CJSON_Builder*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,5 +3,12 @@
 
 #include "parser.h"
 #include "query-builder.h"
+#include "ondemand.h"
+#include "sax.h"
+#include "stream.h"
+#include "reader.h"
+#include "parallel.h"
+#include "compact.h"
+#include "tape.h"
 
 #endif
\ No newline at end of file
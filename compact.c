@@ -0,0 +1,490 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "compact.h"
+#include "parser.h"
+#include "lexer.h"
+#include "walker.h"
+#include "decoder.h"
+#include "number.h"
+#include "allocator.h"
+#include "util.h"
+
+//the number decoded in a CJSON, or its lexeme if the numbers are lazy
+static void CJSON_Compact_set_number(struct CJSON_Compact *const compact, const struct CJSON *const json) {
+    assert(compact != NULL);
+    assert(json != NULL);
+
+    compact->type   = json->type;
+    compact->length = 0U;
+
+    switch(json->type) {
+    case CJSON_FLOAT64:
+        compact->value.float64 = json->value.float64;
+        break;
+
+    case CJSON_INT64:
+        compact->value.int64 = json->value.int64;
+        break;
+
+    case CJSON_UINT64:
+        compact->value.uint64 = json->value.uint64;
+        break;
+
+    default:
+        assert(json->type == CJSON_NUMBER);
+        compact->length      = json->value.number.length;
+        compact->value.chars = json->value.number.chars;
+    }
+}
+
+//the scalar as a CJSON so it's converted by the CJSON_as_ functions
+static struct CJSON CJSON_Compact_to_json(const struct CJSON_Compact *const compact) {
+    assert(compact != NULL);
+
+    struct CJSON json;
+    json.type = compact->type;
+
+    switch(compact->type) {
+    case CJSON_FLOAT64:
+        json.value.float64 = compact->value.float64;
+        break;
+
+    case CJSON_INT64:
+        json.value.int64 = compact->value.int64;
+        break;
+
+    case CJSON_UINT64:
+        json.value.uint64 = compact->value.uint64;
+        break;
+
+    case CJSON_BOOL:
+        json.value.boolean = compact->value.boolean;
+        break;
+
+    default:
+        json.value.null = NULL;
+    }
+
+    return json;
+}
+
+//a lazy number is decoded on its first access and replaced by its value
+static bool CJSON_Compact_decode_lazy_number(struct CJSON_Compact *const compact) {
+    assert(compact != NULL);
+
+    if(compact->type != CJSON_NUMBER) {
+        return true;
+    }
+
+    struct CJSON value;
+    if(CJSON_Number_decode(compact->value.chars, compact->length, &value) != CJSON_ERROR_NONE) {
+        return false;
+    }
+    CJSON_Compact_set_number(compact, &value);
+
+    return true;
+}
+
+//the compact DOM built by the walker
+struct CJSON_Compact_Walk {
+    struct CJSON_Parser *parser;
+    const char          *data;
+};
+
+//an object with more members than this has a hash index of them after its members
+static unsigned CJSON_Compact_slot_count(const unsigned count) {
+    assert(count > CJSON_OBJECT_SMALL_CAPACITY);
+    assert(count <= UINT_MAX / 4U);
+
+    unsigned slot_count = CJSON_OBJECT_SMALL_CAPACITY * 2U;
+    while(slot_count < count * 2U) {
+        slot_count *= 2U;
+    }
+
+    return slot_count;
+}
+
+static bool CJSON_Compact_scalar(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Compact_Walk *const walk    = (struct CJSON_Compact_Walk*)context;
+    struct CJSON_Compact *const      compact = (struct CJSON_Compact*)value;
+    assert(walk != NULL);
+    assert(compact != NULL);
+    assert(token != NULL);
+
+    switch(token->type) {
+    case CJSON_TOKEN_STRING: {
+        struct CJSON_String string;
+        if(!CJSON_decode_string(walk->parser, &string, walk->data, token)) {
+            walk->parser->error = CJSON_ERROR_STRING;
+            return false;
+        }
+        compact->type        = CJSON_STRING;
+        compact->length      = string.length;
+        compact->value.chars = string.chars;
+        break;
+    }
+
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT: {
+        struct CJSON number;
+        if(!CJSON_decode_number(walk->parser, &number, walk->data, token)) {
+            return false;
+        }
+        CJSON_Compact_set_number(compact, &number);
+        break;
+    }
+
+    case CJSON_TOKEN_BOOL:
+        compact->type          = CJSON_BOOL;
+        compact->length        = 0U;
+        compact->value.boolean = walk->data[token->offset] == 't';
+        break;
+
+    default:
+        assert(token->type == CJSON_TOKEN_NULL);
+        compact->type         = CJSON_NULL;
+        compact->length       = 0U;
+        compact->value.values = NULL;
+    }
+
+    return true;
+}
+
+//the values or the members of the container are allocated from its element count, length counts the ones parsed
+static void *CJSON_Compact_open(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Compact_Walk *const walk    = (struct CJSON_Compact_Walk*)context;
+    struct CJSON_Compact *const      compact = (struct CJSON_Compact*)value;
+    assert(walk != NULL);
+    assert(compact != NULL);
+    assert(token != NULL);
+
+    const bool     is_object = token->type == CJSON_TOKEN_LCURLY;
+    const unsigned count     = CJSON_Token_count(token);
+
+    compact->type         = is_object ? CJSON_OBJECT : CJSON_ARRAY;
+    compact->length       = 0U;
+    compact->value.values = NULL;
+
+    bool success = true;
+    if(count > CJSON_OBJECT_SMALL_CAPACITY && is_object) {
+        const size_t size = (size_t)count * sizeof(struct CJSON_Compact_Member) + (size_t)CJSON_Compact_slot_count(count) * sizeof(unsigned);
+        success = size <= (size_t)UINT_MAX
+            && (compact->value.members = (struct CJSON_Compact_Member*)CJSON_Arena_alloc(
+                &walk->parser->object_arena,
+                (unsigned)size,
+                (unsigned)CJSON_ALIGNOF(struct CJSON_Compact_Member)
+            )) != NULL;
+    } else if(count > 0U && is_object) {
+        success = (compact->value.members = CJSON_ARENA_ALLOC(&walk->parser->object_arena, count, struct CJSON_Compact_Member)) != NULL;
+    } else if(count > 0U) {
+        success = (compact->value.values = CJSON_ARENA_ALLOC(&walk->parser->array_arena, count, struct CJSON_Compact)) != NULL;
+    }
+    if(!success) {
+        walk->parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    return compact;
+}
+
+static void *CJSON_Compact_element(void *const context, void *const container, const struct CJSON_Token *const key) {
+    struct CJSON_Compact_Walk *const walk    = (struct CJSON_Compact_Walk*)context;
+    struct CJSON_Compact *const      compact = (struct CJSON_Compact*)container;
+    assert(walk != NULL);
+    assert(compact != NULL);
+
+    if(key == NULL) {
+        return compact->value.values + compact->length++;
+    }
+
+    struct CJSON_String key_string;
+    unsigned            hash;
+    if(!CJSON_decode_key(walk->parser, &key_string, &hash, walk->data, key)) {
+        walk->parser->error = CJSON_ERROR_OBJECT_KEY;
+        return NULL;
+    }
+
+    struct CJSON_Compact_Member *const member = compact->value.members + compact->length++;
+    member->key        = key_string.chars;
+    member->key_length = key_string.length;
+    member->hash       = hash;
+
+    return &member->value;
+}
+
+static bool CJSON_Compact_is_member(const struct CJSON_Compact_Member *const member, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(member != NULL);
+    assert(key != NULL);
+
+    return member->hash == hash && member->key_length == key_length && (member->key == key || memcmp(member->key, key, (size_t)key_length) == 0);
+}
+
+//the index holds the position of a member plus one with linear probing, a duplicated key keeps the last member
+static bool CJSON_Compact_close(void *const context, void *const container, const struct CJSON_Token *const token) {
+    const struct CJSON_Compact *const compact = (const struct CJSON_Compact*)container;
+    assert(compact != NULL);
+    (void)context;
+    (void)token;
+
+    if(compact->type != CJSON_OBJECT || compact->length <= CJSON_OBJECT_SMALL_CAPACITY) {
+        return true;
+    }
+
+    const struct CJSON_Compact_Member *const members    = compact->value.members;
+    unsigned *const                          slots      = (unsigned*)(compact->value.members + compact->length);
+    const unsigned                           slot_count = CJSON_Compact_slot_count(compact->length);
+    memset(slots, 0, (size_t)slot_count * sizeof(*slots));
+
+    for(unsigned i = 0U; i < compact->length; i++) {
+        const struct CJSON_Compact_Member *const member = members + i;
+
+        unsigned slot = member->hash & (slot_count - 1U);
+        while(slots[slot] != 0U && !CJSON_Compact_is_member(members + slots[slot] - 1U, member->key, member->key_length, member->hash)) {
+            slot = (slot + 1U) & (slot_count - 1U);
+        }
+        slots[slot] = i + 1U;
+    }
+
+    return true;
+}
+
+//a compact value is a third of a CJSON so the arenas are reserved for what the lexer counted instead of CJSON_Parser_reserve
+static bool CJSON_Compact_reserve(struct CJSON_Parser *const parser, const struct CJSON_Counters *const counters) {
+    assert(parser != NULL);
+    assert(counters != NULL);
+
+    const bool strings_in_input = (parser->options & CJSON_PARSER_OPTION_ZERO_COPY) != 0U;
+
+    if(counters->array_elements > 0U && !CJSON_Arena_reserve(
+        &parser->array_arena,
+        counters->array_elements * (unsigned)sizeof(struct CJSON_Compact),
+        (unsigned)CJSON_ALIGNOF(struct CJSON_Compact)
+    )) {
+        return false;
+    }
+
+    if(counters->object_elements > 0U && !CJSON_Arena_reserve(
+        &parser->object_arena,
+        counters->object_elements * (unsigned)sizeof(struct CJSON_Compact_Member),
+        (unsigned)CJSON_ALIGNOF(struct CJSON_Compact_Member)
+    )) {
+        return false;
+    }
+
+    return strings_in_input || counters->chars == 0U || CJSON_Arena_reserve(&parser->string_arena, counters->chars, 1U);
+}
+
+static struct CJSON_Compact *CJSON_Compact_parse_tokens(struct CJSON_Parser *const parser, struct CJSON_Tokens *const tokens, const char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(tokens != NULL);
+    assert(data != NULL);
+
+    struct CJSON_Counters counters;
+    CJSON_Counters_init(&counters);
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, data, length);
+
+    const enum CJSON_Lexer_Error error = CJSON_Lexer_tokenize(&lexer, tokens, &counters);
+    if(error == CJSON_LEXER_ERROR_TOKEN) {
+        parser->error = CJSON_ERROR_TOKEN;
+        return NULL;
+    }
+    if(error == CJSON_LEXER_ERROR_MEMORY || !CJSON_Compact_reserve(parser, &counters)) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    struct CJSON_Compact *const compact = CJSON_ARENA_ALLOC(&parser->json_arena, 1U, struct CJSON_Compact);
+    if(compact == NULL) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    struct CJSON_Compact_Walk walk;
+    walk.parser = parser;
+    walk.data   = data;
+
+    struct CJSON_Walker walker;
+    walker.open      = CJSON_Compact_open;
+    walker.element   = CJSON_Compact_element;
+    walker.scalar    = CJSON_Compact_scalar;
+    walker.close     = CJSON_Compact_close;
+    walker.context   = &walk;
+    walker.error     = &parser->error;
+    walker.max_depth = parser->max_depth;
+
+    return CJSON_walk(&walker, compact, tokens) ? compact : NULL;
+}
+
+static struct CJSON_Compact *CJSON_Compact_find(const struct CJSON_Compact *const compact, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(compact != NULL);
+    assert(key != NULL);
+
+    if(compact->type != CJSON_OBJECT) {
+        return NULL;
+    }
+
+    struct CJSON_Compact_Member *const members = compact->value.members;
+    if(compact->length <= CJSON_OBJECT_SMALL_CAPACITY) {
+        for(unsigned i = compact->length; i-- > 0U;) {
+            if(CJSON_Compact_is_member(members + i, key, key_length, hash)) {
+                return &members[i].value;
+            }
+        }
+
+        return NULL;
+    }
+
+    const unsigned *const slots      = (const unsigned*)(members + compact->length);
+    const unsigned        slot_count = CJSON_Compact_slot_count(compact->length);
+    for(unsigned slot = hash & (slot_count - 1U); slots[slot] != 0U; slot = (slot + 1U) & (slot_count - 1U)) {
+        if(CJSON_Compact_is_member(members + slots[slot] - 1U, key, key_length, hash)) {
+            return &members[slots[slot] - 1U].value;
+        }
+    }
+
+    return NULL;
+}
+
+EXTERN_C struct CJSON_Compact *CJSON_parse_compact(struct CJSON_Parser *const parser, const char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(length > 0U);
+
+    parser->error = CJSON_ERROR_NONE;
+
+    struct CJSON_Tokens tokens;
+    CJSON_Tokens_init(&tokens);
+    if(!CJSON_Tokens_reserve(&tokens, length / 4U)) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    struct CJSON_Compact *const compact = CJSON_Compact_parse_tokens(parser, &tokens, data, length);
+
+    CJSON_Tokens_free(&tokens);
+    if(parser->error != CJSON_ERROR_NONE) {
+        CJSON_Parser_free(parser);
+        return NULL;
+    }
+
+    return compact;
+}
+
+EXTERN_C struct CJSON_Compact *CJSON_Compact_get(const struct CJSON_Compact *const compact, const char *const key) {
+    assert(compact != NULL);
+    assert(key != NULL);
+
+    const size_t key_length = strlen(key);
+    assert(key_length < UINT_MAX);
+
+    return CJSON_Compact_get_n(compact, key, (unsigned)key_length);
+}
+
+EXTERN_C struct CJSON_Compact *CJSON_Compact_get_n(const struct CJSON_Compact *const compact, const char *const key, const unsigned key_length) {
+    assert(compact != NULL);
+    assert(key != NULL);
+
+    return CJSON_Compact_find(compact, key, key_length, CJSON_hash(key, key_length));
+}
+
+EXTERN_C struct CJSON_Compact *CJSON_Compact_get_key(const struct CJSON_Compact *const compact, const struct CJSON_Key *const key) {
+    assert(compact != NULL);
+    assert(key != NULL);
+
+    return CJSON_Compact_find(compact, key->chars, key->length, key->hash);
+}
+
+EXTERN_C struct CJSON_Compact *CJSON_Compact_at(const struct CJSON_Compact *const compact, const unsigned index) {
+    assert(compact != NULL);
+
+    if(compact->type != CJSON_ARRAY || index >= compact->length) {
+        return NULL;
+    }
+
+    return compact->value.values + index;
+}
+
+EXTERN_C const char *CJSON_Compact_as_string(struct CJSON_Compact *const compact, bool *const success) {
+    assert(compact != NULL);
+    assert(success != NULL);
+
+    unsigned length;
+    return CJSON_Compact_as_string_n(compact, &length, success);
+}
+
+EXTERN_C const char *CJSON_Compact_as_string_n(struct CJSON_Compact *const compact, unsigned *const length, bool *const success) {
+    assert(compact != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    if(compact->type != CJSON_STRING) {
+        *success = false;
+        return NULL;
+    }
+    *success = true;
+    *length  = compact->length;
+    return compact->value.chars;
+}
+
+EXTERN_C double CJSON_Compact_as_float64(struct CJSON_Compact *const compact, bool *const success) {
+    assert(compact != NULL);
+    assert(success != NULL);
+
+    if(!CJSON_Compact_decode_lazy_number(compact)) {
+        *success = false;
+        return 0.0;
+    }
+
+    struct CJSON json = CJSON_Compact_to_json(compact);
+    return CJSON_as_float64(&json, success);
+}
+
+EXTERN_C int64_t CJSON_Compact_as_int64(struct CJSON_Compact *const compact, bool *const success) {
+    assert(compact != NULL);
+    assert(success != NULL);
+
+    if(!CJSON_Compact_decode_lazy_number(compact)) {
+        *success = false;
+        return 0;
+    }
+
+    struct CJSON json = CJSON_Compact_to_json(compact);
+    return CJSON_as_int64(&json, success);
+}
+
+EXTERN_C uint64_t CJSON_Compact_as_uint64(struct CJSON_Compact *const compact, bool *const success) {
+    assert(compact != NULL);
+    assert(success != NULL);
+
+    if(!CJSON_Compact_decode_lazy_number(compact)) {
+        *success = false;
+        return 0U;
+    }
+
+    struct CJSON json = CJSON_Compact_to_json(compact);
+    return CJSON_as_uint64(&json, success);
+}
+
+EXTERN_C bool CJSON_Compact_as_bool(struct CJSON_Compact *const compact, bool *const success) {
+    assert(compact != NULL);
+    assert(success != NULL);
+
+    if(compact->type != CJSON_BOOL) {
+        *success = false;
+        return false;
+    }
+    *success = true;
+    return compact->value.boolean;
+}
+
+EXTERN_C bool CJSON_Compact_is_null(const struct CJSON_Compact *const compact) {
+    assert(compact != NULL);
+
+    return compact->type == CJSON_NULL;
+}
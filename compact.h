@@ -0,0 +1,63 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_COMPACT_H
+#define CJSON_COMPACT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "json.h"
+
+struct CJSON_Parser;
+struct CJSON_Compact_Member;
+
+union CJSON_Compact_Value {
+    const char                  *chars;   //CJSON_STRING or CJSON_NUMBER, like a CJSON_String or a CJSON_Number
+    struct CJSON_Compact        *values;  //CJSON_ARRAY
+    struct CJSON_Compact_Member *members; //CJSON_OBJECT
+    double                       float64;
+    int64_t                      int64;
+    uint64_t                     uint64;
+    bool                         boolean;
+};
+
+//16 bytes, a read only value of a DOM parsed by CJSON_parse_compact.
+//length is the length of a string or a lazy number and the number of elements of an array or an object,
+//the arrays and the objects have no capacity since they never grow
+struct CJSON_Compact {
+    enum CJSON_Type           type;
+    unsigned                  length;
+    union CJSON_Compact_Value value;
+};
+
+//the members are in the order of the input, a duplicated key is kept and a lookup finds the last one.
+//an object with more than CJSON_OBJECT_SMALL_CAPACITY members has a hash index of them after its members
+struct CJSON_Compact_Member {
+    const char          *key;
+    unsigned             key_length;
+    unsigned             hash;
+    struct CJSON_Compact value;
+};
+
+//parses the document like CJSON_parse in the arenas of the parser. CJSON_PARSER_OPTION_SINGLE_PASS is ignored
+struct CJSON_Compact *CJSON_parse_compact      (struct CJSON_Parser*, const char *data, unsigned length);
+//NULL if the value is not an object or doesn't have the key, the members of a small object are compared one by one
+struct CJSON_Compact *CJSON_Compact_get        (const struct CJSON_Compact*, const char *key);
+struct CJSON_Compact *CJSON_Compact_get_n      (const struct CJSON_Compact*, const char *key, unsigned key_length);
+struct CJSON_Compact *CJSON_Compact_get_key    (const struct CJSON_Compact*, const struct CJSON_Key*);
+//NULL if the value is not an array or the index is out of bounds
+struct CJSON_Compact *CJSON_Compact_at         (const struct CJSON_Compact*, unsigned index);
+const char           *CJSON_Compact_as_string  (struct CJSON_Compact*, bool *success);
+const char           *CJSON_Compact_as_string_n(struct CJSON_Compact*, unsigned *length, bool *success);
+double                CJSON_Compact_as_float64 (struct CJSON_Compact*, bool *success);
+int64_t               CJSON_Compact_as_int64   (struct CJSON_Compact*, bool *success);
+uint64_t              CJSON_Compact_as_uint64  (struct CJSON_Compact*, bool *success);
+bool                  CJSON_Compact_as_bool    (struct CJSON_Compact*, bool *success);
+bool                  CJSON_Compact_is_null    (const struct CJSON_Compact*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
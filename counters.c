@@ -16,4 +16,5 @@ EXTERN_C void CJSON_Counters_init(struct CJSON_Counters *const counters) {
     counters->comma           = 0U;
     counters->object_elements = 0U;
     counters->array_elements  = 0U;
+    counters->object_tables   = 0U;
 }
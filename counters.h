@@ -15,7 +15,8 @@ struct CJSON_Counters {
              comma,
              chars,
              array_elements,
-             object_elements;
+             object_elements,
+             object_tables; //the bytes of the headers and the hash tables of the objects
 };
 
 void CJSON_Counters_init(struct CJSON_Counters *const counters);
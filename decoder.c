@@ -0,0 +1,330 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decoder.h"
+#include "number.h"
+#include "parser.h"
+#include "symbols.h"
+#include "util.h"
+
+EXTERN_C bool CJSON_unescape(char *const destination, const char *const source, const unsigned length, unsigned *const destination_length) {
+    assert(destination != NULL);
+    assert(source != NULL);
+    assert(destination_length != NULL);
+
+    char *output_current        = destination;
+    const char *const input_end = source + length;
+    const char *input_current   = source;
+    bool escaping               = false;
+
+    while(input_current != input_end) {
+        if(CJSON_is_control_char(*input_current)) {
+            return false;
+        }
+
+        if(!escaping) {
+            if(*input_current == '\\') {
+                escaping = true;
+                input_current++;
+                continue;
+            }
+
+            *(output_current++) = *(input_current++);
+            continue;
+        } 
+        
+        switch(*input_current) {
+        case '"':
+            escaping            = false;
+            *(output_current++) = '"';
+            input_current++;
+            continue;
+        case 'b':
+            escaping            = false;
+            *(output_current++) = '\b';
+            input_current++;
+            continue;
+        case 'f':
+            escaping            = false;
+            *(output_current++) = '\f';
+            input_current++;
+            continue;
+        case 'n':
+            escaping            = false;
+            *(output_current++) = '\n';
+            input_current++;
+            continue;
+        case 'r':
+            escaping            = false;
+            *(output_current++) = '\r';
+            input_current++;
+            continue;
+        case 't':
+            escaping            = false;
+            *(output_current++) = '\t';
+            input_current++;
+            continue;
+        case '/':
+            escaping            = false;
+            *(output_current++) = '/';
+            input_current++;
+            continue;
+        case '\\': {
+            escaping            = false;
+            *(output_current++) = '\\';
+            input_current++;
+            continue;
+        }
+        case 'u': {
+            if(input_end - input_current < 5) {
+                return false;
+            }
+
+            input_current++;
+
+            bool success;
+            const uint16_t high = CJSON_hex_to_utf16(input_current, &success);
+            //\u0000 is decoded to a NUL character, strings and keys are read with their length so it doesn't cut them
+            if(!success) {
+                return false;    
+            }
+
+            if(IS_VALID_2_BYTES_UTF16(high)) {
+                output_current += CJSON_utf16_to_utf8_2bytes(output_current, high);
+                input_current  += 4;
+                escaping        = false;
+                continue;
+            }
+
+            if(input_end - input_current < 10 || input_current[4] != '\\' || input_current[5] != 'u') {
+                return false;
+            }
+
+            const uint16_t low = CJSON_hex_to_utf16(input_current + 6, &success);
+            if(!success || !IS_VALID_4_BYTES_UTF16(high, low)) {
+                return false; 
+            }
+
+            CJSON_utf16_to_utf8_4bytes(output_current, high, low);
+            output_current += 4;
+            input_current  += 10;
+            escaping        = false;
+            continue;
+        }
+        default:
+            return false;        
+        }
+    }
+
+    if(escaping) {
+        return false;
+    }
+
+    *destination_length = (unsigned)(output_current - destination);
+
+    return true;
+}
+
+EXTERN_C bool CJSON_is_raw_string(const char *const chars, const unsigned length) {
+    assert(chars != NULL);
+
+    for(unsigned i = 0U; i < length; i++) {
+        if(chars[i] == '\\' || CJSON_is_control_char(chars[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//the escape of a character or NULL if it's written as is, the other control characters are written as \u00XX
+static const char *CJSON_escape_sequence(const char c) {
+    switch(c) {
+    case '"':  return "\\\"";
+    case '\\': return "\\\\";
+    case '\b': return "\\b";
+    case '\f': return "\\f";
+    case '\n': return "\\n";
+    case '\r': return "\\r";
+    case '\t': return "\\t";
+    default:   return NULL;
+    }
+}
+
+EXTERN_C unsigned CJSON_escaped_length(const char *const source, const unsigned length) {
+    assert(source != NULL);
+
+    unsigned escaped_length = length;
+    for(unsigned i = 0U; i < length; i++) {
+        if(CJSON_escape_sequence(source[i]) != NULL) {
+            escaped_length += (unsigned)static_strlen("\\n") - 1U;
+        } else if(CJSON_is_control_char(source[i])) {
+            escaped_length += (unsigned)static_strlen("\\u0000") - 1U;
+        }
+    }
+
+    return escaped_length;
+}
+
+EXTERN_C char *CJSON_escape(char *destination, const char *const source, const unsigned length) {
+    assert(destination != NULL);
+    assert(source != NULL);
+
+    static const char hex[] = "0123456789abcdef";
+
+    unsigned start = 0U;
+    for(unsigned i = 0U; i < length; i++) {
+        const char *const sequence = CJSON_escape_sequence(source[i]);
+        if(sequence == NULL && !CJSON_is_control_char(source[i])) {
+            continue;
+        }
+
+        //the characters since the last escape are copied at once
+        memcpy(destination, source + start, (size_t)(i - start));
+        destination += i - start;
+        start        = i + 1U;
+
+        if(sequence != NULL) {
+            memcpy(destination, sequence, static_strlen("\\n"));
+            destination += static_strlen("\\n");
+        } else {
+            memcpy(destination, "\\u00", static_strlen("\\u00"));
+            destination[4] = hex[(unsigned char)source[i] >> 4];
+            destination[5] = hex[(unsigned char)source[i] & 0xFU];
+            destination   += static_strlen("\\u0000");
+        }
+    }
+
+    memcpy(destination, source + start, (size_t)(length - start));
+    return destination + length - start;
+}
+
+EXTERN_C bool CJSON_decode_string(struct CJSON_Parser *const parser, struct CJSON_String *const string, const char *const data, const struct CJSON_Token *const token) {
+    assert(parser != NULL);
+    assert(string != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+    assert(token->length >= 2);
+
+    const char *const chars  = data + token->offset + 1;
+    const unsigned    length = CJSON_Token_length(token, data) - 2U;
+
+    //the output is never longer than the input so it can take its place, the NUL terminator replaces the closing quote
+    if(parser->insitu != NULL) {
+        char *const output        = parser->insitu + (chars - parser->insitu);
+        unsigned    output_length = length;
+        if(!CJSON_is_raw_string(chars, length) && !CJSON_unescape(output, chars, length, &output_length)) {
+            return false;
+        }
+
+        output[output_length] = '\0';
+        string->chars         = output;
+        string->length        = output_length;
+        return true;
+    }
+
+    if((parser->options & CJSON_PARSER_OPTION_ZERO_COPY) != 0U && CJSON_is_raw_string(chars, length)) {
+        string->chars  = chars;
+        string->length = length;
+        return true;
+    }
+
+    char *const output = CJSON_ARENA_ALLOC(&parser->string_arena, length + 1U, char);
+    if(output == NULL) {
+        return false;
+    }
+
+    unsigned output_length;
+    if(!CJSON_unescape(output, chars, length, &output_length)) {
+        return false;
+    }
+
+    output[output_length] = '\0';
+    string->chars         = output;
+    string->length        = output_length;
+
+    return true;
+}
+
+EXTERN_C bool CJSON_decode_key(struct CJSON_Parser *const parser, struct CJSON_String *const key, unsigned *const hash, const char *const data, const struct CJSON_Token *const token) {
+    assert(parser != NULL);
+    assert(key != NULL);
+    assert(hash != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+    assert(token->length >= 2);
+
+    const char *const chars  = data + token->offset + 1;
+    const unsigned    length = CJSON_Token_length(token, data) - 2U;
+
+    const bool is_raw = CJSON_is_raw_string(chars, length);
+
+    //a key that stays in the input is already stored once
+    if(parser->insitu != NULL || (is_raw && (parser->options & CJSON_PARSER_OPTION_ZERO_COPY) != 0U)) {
+        if(!CJSON_decode_string(parser, key, data, token)) {
+            return false;
+        }
+
+        *hash = CJSON_hash(key->chars, key->length);
+        return true;
+    }
+
+    //a key too long for the symbol table is copied like any other string
+    if(length > CJSON_SYMBOLS_MAXIMUM_LENGTH) {
+        if(!CJSON_decode_string(parser, key, data, token)) {
+            return false;
+        }
+
+        *hash = CJSON_hash(key->chars, key->length);
+        return true;
+    }
+
+    //a raw key is interned straight from the input, an escaped one is unescaped on the stack first so only the symbol table has a copy
+    char buffer[CJSON_SYMBOLS_MAXIMUM_LENGTH];
+    key->chars  = chars;
+    key->length = length;
+    if(!is_raw) {
+        if(!CJSON_unescape(buffer, chars, length, &key->length)) {
+            return false;
+        }
+        key->chars = buffer;
+    }
+
+    *hash = CJSON_hash(key->chars, key->length);
+
+    const char *const symbol = CJSON_Symbols_intern(&parser->symbols, key->chars, key->length, *hash);
+    if(symbol != NULL) {
+        key->chars = symbol;
+        return true;
+    }
+
+    //past the limits of the symbol table the key is copied like any other string
+    return CJSON_decode_string(parser, key, data, token);
+}
+
+EXTERN_C bool CJSON_decode_number(struct CJSON_Parser *const parser, struct CJSON *const json, const char *const data, const struct CJSON_Token *const token) {
+    assert(parser != NULL);
+    assert(json != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+
+    const char *const chars = data + token->offset;
+
+    //only the grammar is checked here, a number with a bad grammar fails with the error it would have without the option.
+    //the range is checked when the number is decoded, so a number too big for any type keeps its lexeme
+    if((parser->options & CJSON_PARSER_OPTION_LAZY_NUMBERS) != 0U && CJSON_Number_is_valid(chars, token->length)) {
+        json->type                = CJSON_NUMBER;
+        json->value.number.chars  = chars;
+        json->value.number.length = token->length;
+        return true;
+    }
+
+    const enum CJSON_Error error = CJSON_Number_decode(chars, token->length, json);
+    if(error != CJSON_ERROR_NONE) {
+        parser->error = error;
+        return false;
+    }
+
+    return true;
+}
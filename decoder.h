@@ -0,0 +1,29 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_DECODER_H
+#define CJSON_DECODER_H
+
+#include <stdbool.h>
+#include "json.h"
+#include "token.h"
+
+//destination can be the source itself since the unescaped string is never longer than the escaped one
+bool CJSON_unescape     (char *destination, const char *source, unsigned length, unsigned *destination_length);
+bool CJSON_is_raw_string(const char *chars, unsigned length);
+//the length of the string once the quotes, the backslashes and the control characters are escaped, without the quotes around it
+unsigned CJSON_escaped_length(const char *source, unsigned length);
+//destination has CJSON_escaped_length bytes, the end of the escaped string is returned
+char    *CJSON_escape        (char *destination, const char *source, unsigned length);
+//data is the input the offset of the token points into
+bool CJSON_decode_string(struct CJSON_Parser*, struct CJSON_String*, const char *data, const struct CJSON_Token*);
+//like CJSON_decode_string but the key is interned in the symbol table of the parser unless it's in the input, hash is set to its hash
+bool CJSON_decode_key   (struct CJSON_Parser*, struct CJSON_String*, unsigned *hash, const char *data, const struct CJSON_Token*);
+bool CJSON_decode_number(struct CJSON_Parser*, struct CJSON*, const char *data, const struct CJSON_Token*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <limits.h>
 
 #include "util.h"
@@ -55,7 +56,7 @@ static enum CJSON_FileContents_Error CJSON_fopen(FILE **const file, const char *
 
     CJSON_FREE(wpath);
 #else
-    file = fopen(path, mode);
+    *file = fopen(path, mode);
 #endif
 
     return *file == NULL 
@@ -63,6 +64,13 @@ static enum CJSON_FileContents_Error CJSON_fopen(FILE **const file, const char *
         : CJSON_FILECONTENTS_ERROR_NONE;
 }
 
+EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_open(FILE **const file, const char *const path) {
+    assert(file != NULL);
+    assert(path != NULL);
+
+    return CJSON_fopen(file, path, "rb");
+}
+
 EXTERN_C void CJSON_FileContents_init(struct CJSON_FileContents *const file_contents) {
     assert(file_contents != NULL);
 
@@ -77,7 +85,8 @@ void CJSON_FileContents_free(struct CJSON_FileContents *const file_contents) {
     CJSON_FileContents_init(file_contents);
 }
 
-EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_get(struct CJSON_FileContents *const file_contents, const char *const path) {
+//reads the file in a buffer allocated with CJSON_MALLOC or in the arena if there is one
+static enum CJSON_FileContents_Error CJSON_FileContents_read(struct CJSON_FileContents *const file_contents, const char *const path, struct CJSON_Arena *const arena) {
     assert(file_contents != NULL);
     assert(path != NULL);
     assert(path[0] != '\0');
@@ -117,7 +126,9 @@ EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_get(struct CJSON_FileC
         }
 
         //the buffer returned has 1 extra byte allocated in case a null terminated string is required
-        file_contents->data = (unsigned char*)CJSON_MALLOC(((size_t)length + 1) * sizeof(unsigned char));
+        file_contents->data = arena == NULL
+            ? (unsigned char*)CJSON_MALLOC(((size_t)length + 1) * sizeof(unsigned char))
+            : CJSON_ARENA_ALLOC(arena, (unsigned)length + 1U, unsigned char);
         if(file_contents->data == NULL) {
             error = CJSON_FILECONTENTS_ERROR_MEMORY;
             break;
@@ -139,7 +150,11 @@ EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_get(struct CJSON_FileC
     } while(0);
 
     if(error != CJSON_FILECONTENTS_ERROR_NONE) {
-        CJSON_FileContents_free(file_contents);
+        if(arena == NULL) {
+            CJSON_FileContents_free(file_contents);
+        } else {
+            CJSON_FileContents_init(file_contents);
+        }
     }
     
     fclose(file);
@@ -147,6 +162,23 @@ EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_get(struct CJSON_FileC
     return error;
 }
 
+EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_get(struct CJSON_FileContents *const file_contents, const char *const path) {
+    assert(file_contents != NULL);
+    assert(path != NULL);
+    assert(path[0] != '\0');
+
+    return CJSON_FileContents_read(file_contents, path, NULL);
+}
+
+EXTERN_C enum CJSON_FileContents_Error CJSON_FileContents_get_in_arena(struct CJSON_FileContents *const file_contents, const char *const path, struct CJSON_Arena *const arena) {
+    assert(file_contents != NULL);
+    assert(path != NULL);
+    assert(path[0] != '\0');
+    assert(arena != NULL);
+
+    return CJSON_FileContents_read(file_contents, path, arena);
+}
+
 enum CJSON_FileContents_Error CJSON_FileContents_put(const struct CJSON_FileContents *const file_contents, const char *const path) {
     assert(file_contents != NULL);
     assert(path != NULL);
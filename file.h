@@ -10,6 +10,8 @@ extern "C" {
     #include <unistd.h>
 #endif
 
+#include <stdio.h>
+
 enum CJSON_FileContents_Error {
     CJSON_FILECONTENTS_ERROR_NONE,
     CJSON_FILECONTENTS_ERROR_WIN32_API,
@@ -23,6 +25,8 @@ enum CJSON_FileContents_Error {
     CJSON_FILECONTENTS_ERROR_FCLOSE
 };
 
+struct CJSON_Arena;
+
 struct CJSON_FileContents {
     unsigned char *data;
     unsigned       size;
@@ -31,6 +35,10 @@ struct CJSON_FileContents {
 void                          CJSON_FileContents_init(struct CJSON_FileContents*);
 void                          CJSON_FileContents_free(struct CJSON_FileContents*);
 enum CJSON_FileContents_Error CJSON_FileContents_get(struct CJSON_FileContents*, const char *path);
+//the data belongs to the arena, CJSON_FileContents_free must not be called
+enum CJSON_FileContents_Error CJSON_FileContents_get_in_arena(struct CJSON_FileContents*, const char *path, struct CJSON_Arena*);
+//opens the file for reading, the path is UTF-8 on Windows too
+enum CJSON_FileContents_Error CJSON_FileContents_open(FILE **file, const char *path);
 enum CJSON_FileContents_Error CJSON_FileContents_put(const struct CJSON_FileContents*, const char *path);
 
 #endif
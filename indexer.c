@@ -0,0 +1,327 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "indexer.h"
+#include "util.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+#   define CJSON_INDEXER_X64
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       include <intrin.h>
+#   endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define CJSON_TARGET_AVX2 __attribute__((target("avx2,pclmul")))
+#else
+#   define CJSON_TARGET_AVX2
+#endif
+
+#define CJSON_EVEN_BITS 0x5555555555555555ULL
+
+struct CJSON_Indexer_Masks {
+    uint64_t whitespace,
+             structural,
+             quote,
+             backslash;
+};
+
+static enum CJSON_Indexer_Backend CJSON_indexer_backend = CJSON_INDEXER_BACKEND_SCALAR;
+
+static void CJSON_Indexer_classify_scalar(const char *const block, struct CJSON_Indexer_Masks *const masks) {
+    assert(block != NULL);
+    assert(masks != NULL);
+
+    masks->whitespace = 0U;
+    masks->structural = 0U;
+    masks->quote      = 0U;
+    masks->backslash  = 0U;
+
+    for(unsigned i = 0U; i < CJSON_INDEXER_BLOCK_SIZE; i++) {
+        const uint64_t bit = 1ULL << i;
+
+        switch(block[i]) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            masks->whitespace |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            masks->structural |= bit;
+            break;
+        case '"':
+            masks->quote |= bit;
+            break;
+        case '\\':
+            masks->backslash |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+//xor of all the bits at or below each position, a set bit means "inside a string" when applied on the quotes
+static uint64_t CJSON_Indexer_prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+
+    return bits;
+}
+
+#ifdef CJSON_INDEXER_X64
+
+static void CJSON_Indexer_classify_sse2(const char *const block, struct CJSON_Indexer_Masks *const masks) {
+    assert(block != NULL);
+    assert(masks != NULL);
+
+    const __m128i space     = _mm_set1_epi8(' ');
+    const __m128i tab       = _mm_set1_epi8('\t');
+    const __m128i newline   = _mm_set1_epi8('\n');
+    const __m128i carriage  = _mm_set1_epi8('\r');
+    //'[' | 0x20 == '{' and ']' | 0x20 == '}'
+    const __m128i lower     = _mm_set1_epi8(0x20);
+    const __m128i lcurly    = _mm_set1_epi8('{');
+    const __m128i rcurly    = _mm_set1_epi8('}');
+    const __m128i colon     = _mm_set1_epi8(':');
+    const __m128i comma     = _mm_set1_epi8(',');
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    masks->whitespace = 0U;
+    masks->structural = 0U;
+    masks->quote      = 0U;
+    masks->backslash  = 0U;
+
+    for(unsigned i = 0U; i < CJSON_INDEXER_BLOCK_SIZE; i += 16U) {
+        const __m128i chars  = _mm_loadu_si128((const __m128i*)(const void*)(block + i));
+        const __m128i folded = _mm_or_si128(chars, lower);
+
+        const __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chars, space),   _mm_cmpeq_epi8(chars, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(chars, newline), _mm_cmpeq_epi8(chars, carriage))
+        );
+        const __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, lcurly), _mm_cmpeq_epi8(folded, rcurly)),
+            _mm_or_si128(_mm_cmpeq_epi8(chars, colon),   _mm_cmpeq_epi8(chars, comma))
+        );
+
+        masks->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(whitespace)                        << i;
+        masks->structural |= (uint64_t)(uint16_t)_mm_movemask_epi8(structural)                        << i;
+        masks->quote      |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, quote))     << i;
+        masks->backslash  |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, backslash)) << i;
+    }
+}
+
+CJSON_TARGET_AVX2 static void CJSON_Indexer_classify_avx2(const char *const block, struct CJSON_Indexer_Masks *const masks) {
+    assert(block != NULL);
+    assert(masks != NULL);
+
+    const __m256i space     = _mm256_set1_epi8(' ');
+    const __m256i tab       = _mm256_set1_epi8('\t');
+    const __m256i newline   = _mm256_set1_epi8('\n');
+    const __m256i carriage  = _mm256_set1_epi8('\r');
+    //'[' | 0x20 == '{' and ']' | 0x20 == '}'
+    const __m256i lower     = _mm256_set1_epi8(0x20);
+    const __m256i lcurly    = _mm256_set1_epi8('{');
+    const __m256i rcurly    = _mm256_set1_epi8('}');
+    const __m256i colon     = _mm256_set1_epi8(':');
+    const __m256i comma     = _mm256_set1_epi8(',');
+    const __m256i quote     = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    masks->whitespace = 0U;
+    masks->structural = 0U;
+    masks->quote      = 0U;
+    masks->backslash  = 0U;
+
+    for(unsigned i = 0U; i < CJSON_INDEXER_BLOCK_SIZE; i += 32U) {
+        const __m256i chars  = _mm256_loadu_si256((const __m256i*)(const void*)(block + i));
+        const __m256i folded = _mm256_or_si256(chars, lower);
+
+        const __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, space),   _mm256_cmpeq_epi8(chars, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, newline), _mm256_cmpeq_epi8(chars, carriage))
+        );
+        const __m256i structural = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, lcurly), _mm256_cmpeq_epi8(folded, rcurly)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, colon),   _mm256_cmpeq_epi8(chars, comma))
+        );
+
+        masks->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace)                           << i;
+        masks->structural |= (uint64_t)(uint32_t)_mm256_movemask_epi8(structural)                           << i;
+        masks->quote      |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, quote))     << i;
+        masks->backslash  |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, backslash)) << i;
+    }
+}
+
+//carry-less multiplication by an all ones operand computes the prefix xor in a single instruction
+CJSON_TARGET_AVX2 static uint64_t CJSON_Indexer_prefix_xor_clmul(const uint64_t bits) {
+    const __m128i operand = _mm_set_epi64x(0, (long long)bits);
+    const __m128i ones    = _mm_set1_epi8((char)0xFF);
+
+    return (uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(operand, ones, 0));
+}
+
+static bool CJSON_Indexer_supports_avx2(void) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul");
+#elif defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 1);
+    const bool pclmul  = (info[2] & (1 << 1))  != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if(!pclmul || !osxsave || (_xgetbv(0) & 6U) != 6U) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+#endif
+
+static bool CJSON_Indexer_supports(const enum CJSON_Indexer_Backend backend) {
+    switch(backend) {
+    case CJSON_INDEXER_BACKEND_SCALAR:
+        return true;
+#ifdef CJSON_INDEXER_X64
+    case CJSON_INDEXER_BACKEND_SSE2:
+        return true;
+    case CJSON_INDEXER_BACKEND_AVX2:
+        return CJSON_Indexer_supports_avx2();
+#else
+    case CJSON_INDEXER_BACKEND_SSE2:
+    case CJSON_INDEXER_BACKEND_AVX2:
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+//a backslash escapes the next character only if it ends a run of backslashes of odd length
+static uint64_t CJSON_Indexer_find_escaped(struct CJSON_Indexer *const indexer, const uint64_t backslash) {
+    assert(indexer != NULL);
+
+    const uint64_t odd_bits        = ~CJSON_EVEN_BITS;
+    const uint64_t start_edges     = backslash & ~(backslash << 1);
+    //if the previous block ended with an odd run then the parity of the first run is flipped
+    const uint64_t even_start_mask = CJSON_EVEN_BITS ^ indexer->escaped;
+    const uint64_t even_starts     = start_edges & even_start_mask;
+    const uint64_t odd_starts      = start_edges & ~even_start_mask;
+    const uint64_t even_carries    = backslash + even_starts;
+    uint64_t       odd_carries     = backslash + odd_starts;
+    const bool     ends_odd_run    = odd_carries < backslash;
+
+    odd_carries     |= indexer->escaped;
+    indexer->escaped = ends_odd_run ? 1U : 0U;
+
+    const uint64_t even_carry_ends = even_carries & ~backslash;
+    const uint64_t odd_carry_ends  = odd_carries  & ~backslash;
+
+    return (even_carry_ends & odd_bits) | (odd_carry_ends & CJSON_EVEN_BITS);
+}
+
+//the backend is only read here so the lexers running on several threads don't race, the CPU is only checked by
+//CJSON_Indexer_set_backend
+EXTERN_C enum CJSON_Indexer_Backend CJSON_Indexer_get_backend(void) {
+    return CJSON_indexer_backend;
+}
+
+EXTERN_C bool CJSON_Indexer_set_backend(const enum CJSON_Indexer_Backend backend) {
+    if(!CJSON_Indexer_supports(backend)) {
+        return false;
+    }
+
+    CJSON_indexer_backend = backend;
+    return true;
+}
+
+EXTERN_C void CJSON_Indexer_init(struct CJSON_Indexer *const indexer) {
+    assert(indexer != NULL);
+
+    indexer->in_string = 0U;
+    indexer->escaped   = 0U;
+    indexer->scalar    = 0U;
+    indexer->backend   = CJSON_Indexer_get_backend();
+}
+
+EXTERN_C void CJSON_Indexer_next_block(struct CJSON_Indexer *const indexer, const char *const block, struct CJSON_Indexer_Block *const output) {
+    assert(indexer != NULL);
+    assert(block != NULL);
+    assert(output != NULL);
+
+    struct CJSON_Indexer_Masks masks;
+    uint64_t in_string;
+
+    switch(indexer->backend) {
+#ifdef CJSON_INDEXER_X64
+    case CJSON_INDEXER_BACKEND_AVX2:
+        CJSON_Indexer_classify_avx2(block, &masks);
+        break;
+    case CJSON_INDEXER_BACKEND_SSE2:
+        CJSON_Indexer_classify_sse2(block, &masks);
+        break;
+#endif
+    default:
+        CJSON_Indexer_classify_scalar(block, &masks);
+        break;
+    }
+
+    const uint64_t escaped = masks.backslash != 0U || indexer->escaped != 0U
+        ? CJSON_Indexer_find_escaped(indexer, masks.backslash)
+        : 0U;
+    const uint64_t quote = masks.quote & ~escaped;
+
+#ifdef CJSON_INDEXER_X64
+    if(indexer->backend == CJSON_INDEXER_BACKEND_AVX2) {
+        in_string = CJSON_Indexer_prefix_xor_clmul(quote) ^ indexer->in_string;
+    } else
+#endif
+    in_string = CJSON_Indexer_prefix_xor(quote) ^ indexer->in_string;
+
+    //the opening quote is part of in_string, the closing one is not
+    const uint64_t scalar       = ~(masks.whitespace | masks.structural | quote | in_string);
+    const uint64_t scalar_start = scalar & ~((scalar << 1) | indexer->scalar);
+
+    output->token_starts = (masks.structural & ~in_string) | (quote & in_string) | scalar_start;
+    output->string_ends  = quote & ~in_string;
+
+    indexer->in_string = 0U - (in_string >> 63);
+    indexer->scalar    = scalar >> 63;
+}
+
+EXTERN_C unsigned CJSON_Indexer_first_bit(const uint64_t bits) {
+    assert(bits != 0U);
+
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(bits);
+#elif defined(_MSC_VER) && defined(CJSON_INDEXER_X64)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return (unsigned)index;
+#else
+    unsigned index = 0U;
+    while((bits & (1ULL << index)) == 0U) {
+        index++;
+    }
+    return index;
+#endif
+}
@@ -0,0 +1,46 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_INDEXER_H
+#define CJSON_INDEXER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CJSON_INDEXER_BLOCK_SIZE 64U
+
+//the scalar backend is the default, the blocks make the lexer faster but not a whole parse on every CPU
+enum CJSON_Indexer_Backend {
+    CJSON_INDEXER_BACKEND_SCALAR,
+    CJSON_INDEXER_BACKEND_SSE2,
+    CJSON_INDEXER_BACKEND_AVX2
+};
+
+//carries the state of the previous 64 bytes block into the next one
+struct CJSON_Indexer {
+    uint64_t in_string,
+             escaped,
+             scalar;
+    enum CJSON_Indexer_Backend backend;
+};
+
+//one bit per byte of the block, bit 0 being the first byte
+struct CJSON_Indexer_Block {
+    uint64_t token_starts,
+             string_ends;
+};
+
+//the backend used by the lexers
+enum CJSON_Indexer_Backend CJSON_Indexer_get_backend(void);
+//false if the CPU doesn't support the backend. It's global, it must not be changed while a document is parsed
+bool                       CJSON_Indexer_set_backend(enum CJSON_Indexer_Backend);
+void                       CJSON_Indexer_init       (struct CJSON_Indexer*);
+void                       CJSON_Indexer_next_block (struct CJSON_Indexer*, const char *block, struct CJSON_Indexer_Block*);
+unsigned                   CJSON_Indexer_first_bit  (uint64_t bits);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
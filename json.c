@@ -5,6 +5,8 @@
 #include <inttypes.h>
 
 #include "json.h"
+#include "number.h"
+#include "decoder.h"
 #include "parser.h"
 #include "lexer.h"
 #include "tokens.h"
@@ -22,13 +24,12 @@ static char *CJSON_String_to_string(const struct CJSON_String *const value, char
     assert(value != NULL);
     assert(string != NULL);
 
+    *(string++) = '"';
+    string      = CJSON_escape(string, value->chars, value->length);
     *(string++) = '"';
     *string     = '\0';
-    strcat(string, value->chars);
-    string[value->length     ] = '"';
-    string[value->length + 1U] = '\0';
 
-    return string + value->length + 1U;
+    return string;
 }
 
 static char *CJSON_Array_element_to_string(const struct CJSON *const json, char *string, const unsigned indentation, const unsigned level) {
@@ -82,104 +83,63 @@ static char *CJSON_Array_to_string(const struct CJSON_Array *const array, char *
     return string;
 }
 
-static char *CJSON_KV_to_string_with_indentation(const struct CJSON_KV *const key_value, char *string, const unsigned indentation, const unsigned level) {
-    assert(key_value != NULL);
+static char *CJSON_KV_to_string_with_indentation(const struct CJSON_String *const key, const struct CJSON *const value, char *string, const unsigned indentation, const unsigned level) {
+    assert(key != NULL);
+    assert(value != NULL);
     assert(string != NULL);
 
     const size_t whitespace_size = (size_t)(indentation * level);
 
-    const size_t key_length = strlen(key_value->key);
-    assert(key_length < UINT_MAX);
-
-    struct CJSON_String json_string;
-    json_string.chars  = key_value->key;
-    json_string.length = (unsigned)key_length;
-
     *(string++) = '\n';
     memset(string, ' ', whitespace_size);
     string     += whitespace_size;
-    string      = CJSON_String_to_string(&json_string, string);
+    string      = CJSON_String_to_string(key, string);
     *(string++) = ':';
     *(string++) = ' ';
     
-    return CJSON_JSON_to_string(&key_value->value, string, indentation, level + 1U);
+    return CJSON_JSON_to_string(value, string, indentation, level + 1U);
 }
 
-static char *CJSON_KV_to_string(const struct CJSON_KV *const key_value, char *string) {
-    assert(key_value != NULL);
+static char *CJSON_KV_to_string(const struct CJSON_String *const key, const struct CJSON *const value, char *string) {
+    assert(key != NULL);
+    assert(value != NULL);
     assert(string != NULL);
 
-    const size_t key_length = strlen(key_value->key);
-    assert(key_length < UINT_MAX);
-
-    struct CJSON_String json_string;
-    json_string.chars  = key_value->key;
-    json_string.length = (unsigned)key_length;
-
-    string      = CJSON_String_to_string(&json_string, string);
+    string      = CJSON_String_to_string(key, string);
     *(string++) = ':';
 
-    return CJSON_JSON_to_string(&key_value->value, string, 0U, 0U);
+    return CJSON_JSON_to_string(value, string, 0U, 0U);
 }
 
 static char *CJSON_Object_to_string(const struct CJSON_Object *const object, char *string, const unsigned indentation, const unsigned level) {
     assert(object != NULL);
     assert(string != NULL);
 
-    const struct CJSON_KV *key_value;
-
     *(string++) = '{';
 
-    do {
-        if(object->capacity == 0U) {
-            break;
+    //the entries are in insertion order, the walk stops once all the keys are written
+    unsigned written = 0U;
+    for(unsigned i = 0U; i < CJSON_Object_length(object) && written < CJSON_Object_count(object); i++) {
+        struct CJSON_String key;
+        if((key.chars = CJSON_Object_key_at(object, i, &key.length)) == NULL) {
+            continue;
         }
 
-        if(indentation > 0U) {
-            bool is_empty = true;
-
-            for(unsigned i = 0U; i < object->capacity - 1U; i++) {
-                key_value = object->entries + i;
-                if(CJSON_KV_is_used(key_value)) {
-                    is_empty = false;
-                    string = CJSON_KV_to_string_with_indentation(key_value, string, indentation, level);
-                    *(string++) = ',';
-                }
-            }
-
-            key_value = object->entries + object->capacity - 1U;
-            if(CJSON_KV_is_used(key_value)) {
-                is_empty = false;
-                string = CJSON_KV_to_string_with_indentation(key_value, string, indentation, level);
-            } else if(string[-1] == ',') {
-                string--;
-            }
-
-            if(is_empty) {
-                break;
-            }
-
-            *(string++) = '\n';
-            const size_t whitespace_size = (size_t)(indentation * (level - 1U));
-            memset(string, ' ', whitespace_size);
-            string += whitespace_size;
-            break;
+        const struct CJSON *const value = CJSON_Object_value_at(object, i);
+        if(written++ > 0U) {
+            *(string++) = ',';
         }
+        string = indentation > 0U
+            ? CJSON_KV_to_string_with_indentation(&key, value, string, indentation, level)
+            : CJSON_KV_to_string(&key, value, string);
+    }
 
-        for(unsigned i = 0U; i < object->capacity - 1U; i++) {
-            key_value = object->entries + i;
-            if(CJSON_KV_is_used(key_value)) {
-                string = CJSON_KV_to_string(key_value, string);
-                *(string++) = ',';
-            }
-        }
-        key_value = object->entries + object->capacity - 1U;
-        if(CJSON_KV_is_used(key_value)) {
-            string = CJSON_KV_to_string(key_value, string);
-        } else if(string[-1] == ',') {
-            string--;
-        }
-    } while(0);
+    if(indentation > 0U && written > 0U) {
+        *(string++) = '\n';
+        const size_t whitespace_size = (size_t)(indentation * (level - 1U));
+        memset(string, ' ', whitespace_size);
+        string += whitespace_size;
+    }
 
     *(string++) = '}';
     *string     = '\0';
@@ -235,6 +195,11 @@ static char *CJSON_JSON_to_string(const struct CJSON *const json, char *const st
         }
         strcat(string, "false");
         return string + static_strlen("false");
+
+    case CJSON_NUMBER:
+        memcpy(string, json->value.number.chars, (size_t)json->value.number.length);
+        string[json->value.number.length] = '\0';
+        return string + json->value.number.length;
     }
 
     return NULL;
@@ -267,14 +232,12 @@ static unsigned CJSON_Object_to_string_size(const struct CJSON_Object *const obj
     unsigned entry_count = 0U;
     unsigned size = (unsigned)(static_strlen("{") + static_strlen("}"));
 
-    for(unsigned i = 0U; i < object->capacity; i++) {
-        const struct CJSON_KV *const key_value = object->entries + i;
-        if(CJSON_KV_is_used(key_value)) {
-            const size_t key_length = strlen(key_value->key);
-            assert(key_length < UINT_MAX);
-
-            size += (unsigned)(static_strlen("\"") + key_length + static_strlen("\""));
-            size += CJSON_JSON_to_string_size(&object->entries[i].value, indentation, level + 1U);
+    for(unsigned i = 0U; i < CJSON_Object_length(object) && entry_count < CJSON_Object_count(object); i++) {
+        unsigned          key_length;
+        const char *const key = CJSON_Object_key_at(object, i, &key_length);
+        if(key != NULL) {
+            size += (unsigned)static_strlen("\"") + CJSON_escaped_length(key, key_length) + (unsigned)static_strlen("\"");
+            size += CJSON_JSON_to_string_size(CJSON_Object_value_at(object, i), indentation, level + 1U);
 
             entry_count++;
         }
@@ -302,7 +265,7 @@ static unsigned CJSON_JSON_to_string_size(const struct CJSON *const json, const
 
     switch(json->type) {
     case CJSON_STRING:
-        return (unsigned)static_strlen("\"") + json->value.string.length + (unsigned)static_strlen("\"");
+        return (unsigned)static_strlen("\"") + CJSON_escaped_length(json->value.string.chars, json->value.string.length) + (unsigned)static_strlen("\"");
 
     case CJSON_FLOAT64: {
         return (unsigned)snprintf(NULL, 0, "%.*g", DBL_PRECISION, json->value.float64); 
@@ -329,6 +292,9 @@ static unsigned CJSON_JSON_to_string_size(const struct CJSON *const json, const
         return json->value.boolean 
             ? (unsigned)static_strlen("true") 
             : (unsigned)static_strlen("false");
+
+    case CJSON_NUMBER:
+        return json->value.number.length;
     }
 
     return 0U;
@@ -383,22 +349,13 @@ EXTERN_C struct CJSON *CJSON_get(struct CJSON *json, const char *query) {
     size_t key_size;
     while(true) {
         if(is_object_key && json->type == CJSON_OBJECT) {
-            char *key;
             key_size = 0U;
             while(*query != '.' && *query != '[' && *query != '\0') {
                 query++;
                 key_size++;
             }
 
-            key = (char*)CJSON_MALLOC((key_size + 1U) * sizeof(char));
-            if(key == NULL) {
-                return NULL;
-            }
-            memcpy(key, query - key_size, key_size);
-            key[key_size] = '\0';
-
-            json = CJSON_Object_get(&json->value.object, key);
-            CJSON_FREE(key);    
+            json = CJSON_Object_get_n(&json->value.object, query - key_size, (unsigned)key_size);
         } else if(!is_object_key && json->type == CJSON_ARRAY) {
             char key[UNSIGNED_MAX_LENGTH + 1U];
             key_size = 0U;
@@ -440,6 +397,17 @@ EXTERN_C struct CJSON *CJSON_get(struct CJSON *json, const char *query) {
     return json;
 }
 
+EXTERN_C struct CJSON *CJSON_get_key(struct CJSON *const json, const struct CJSON_Key *const key) {
+    assert(json != NULL);
+    assert(key != NULL);
+
+    if(json->type != CJSON_OBJECT) {
+        return NULL;
+    }
+
+    return CJSON_Object_get_key(&json->value.object, key);
+}
+
 EXTERN_C const char *CJSON_get_string(struct CJSON *const json, const char *const query, bool *const success) {
     assert(json != NULL);
     assert(query != NULL);
@@ -454,6 +422,21 @@ EXTERN_C const char *CJSON_get_string(struct CJSON *const json, const char *cons
     return CJSON_as_string(ret, success);
 }
 
+EXTERN_C const char *CJSON_get_string_n(struct CJSON *const json, const char *const query, unsigned *const length, bool *const success) {
+    assert(json != NULL);
+    assert(query != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    struct CJSON *const ret = CJSON_get(json, query);
+    if(ret == NULL) {
+        *success = false;
+        return NULL;
+    }
+
+    return CJSON_as_string_n(ret, length, success);
+}
+
 EXTERN_C double CJSON_get_float64(struct CJSON *const json, const char *const query, bool *const success) {
     assert(json != NULL);
     assert(query != NULL);
@@ -564,22 +547,60 @@ EXTERN_C const char *CJSON_as_string(struct CJSON *const json, bool *success) {
     return json->value.string.chars;
 }
 
+EXTERN_C const char *CJSON_as_string_n(struct CJSON *const json, unsigned *const length, bool *success) {
+    assert(json != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    if(json->type != CJSON_STRING) {
+        *success = false;
+        return NULL;
+    }
+    *success = true;
+    *length  = json->value.string.length;
+    return json->value.string.chars;
+}
+
+//a lazy number is decoded in value every time it's read, the json keeps its lexeme for CJSON_to_string.
+//NULL if it can't be decoded
+static const struct CJSON *CJSON_decode_lazy_number(const struct CJSON *const json, struct CJSON *const value) {
+    assert(json != NULL);
+    assert(value != NULL);
+
+    if(json->type != CJSON_NUMBER) {
+        return json;
+    }
+
+    if(CJSON_Number_decode(json->value.number.chars, json->value.number.length, value) != CJSON_ERROR_NONE) {
+        return NULL;
+    }
+
+    return value;
+}
+
 double CJSON_as_float64(struct CJSON *const json, bool *success) {
     assert(json != NULL);
     assert(success != NULL);
 
-    switch(json->type) {
+    struct CJSON value;
+    const struct CJSON *const number = CJSON_decode_lazy_number(json, &value);
+    if(number == NULL) {
+        *success = false;
+        return 0.0;
+    }
+
+    switch(number->type) {
     case CJSON_INT64:
         *success = true;
-        return (double)json->value.int64;
+        return (double)number->value.int64;
 
     case CJSON_UINT64:
         *success = true;
-        return (double)json->value.uint64;
+        return (double)number->value.uint64;
 
     case CJSON_FLOAT64:
         *success = true;
-        return json->value.float64;
+        return number->value.float64;
 
     default:
         *success = false;
@@ -588,26 +609,33 @@ double CJSON_as_float64(struct CJSON *const json, bool *success) {
 }
 
 int64_t CJSON_as_int64(struct CJSON *const json, bool *success) {
-    switch(json->type) {
+    struct CJSON value;
+    const struct CJSON *const number = CJSON_decode_lazy_number(json, &value);
+    if(number == NULL) {
+        *success = false;
+        return 0;
+    }
+
+    switch(number->type) {
     case CJSON_INT64:
         *success = true;
-        return json->value.int64;
+        return number->value.int64;
 
     case CJSON_UINT64:
-        if(json->value.uint64 > (uint64_t)INT64_MAX) {
+        if(number->value.uint64 > (uint64_t)INT64_MAX) {
             *success = false;
             return 0;
         }
         *success = true;
-        return (int64_t)json->value.uint64;
+        return (int64_t)number->value.uint64;
 
     case CJSON_FLOAT64:
-        if(json->value.float64 < (double)INT64_MIN || json->value.float64 > (double)INT64_MAX) {
+        if(number->value.float64 < (double)INT64_MIN || number->value.float64 > (double)INT64_MAX) {
             *success = false;
             return 0;
         }
         *success = true;
-        return (int64_t)json->value.float64;
+        return (int64_t)number->value.float64;
 
     default:
         *success = false;
@@ -616,26 +644,33 @@ int64_t CJSON_as_int64(struct CJSON *const json, bool *success) {
 }
 
 uint64_t CJSON_as_uint64(struct CJSON *const json, bool *success) {
-    switch(json->type) {
+    struct CJSON value;
+    const struct CJSON *const number = CJSON_decode_lazy_number(json, &value);
+    if(number == NULL) {
+        *success = false;
+        return 0;
+    }
+
+    switch(number->type) {
     case CJSON_INT64:
-        if(json->value.int64 < 0) {
+        if(number->value.int64 < 0) {
             *success = false;
             return 0;
         }
         *success = true;
-        return (uint64_t)json->value.int64;
+        return (uint64_t)number->value.int64;
 
     case CJSON_UINT64:
         *success = true;
-        return json->value.uint64;
+        return number->value.uint64;
 
     case CJSON_FLOAT64:
-        if(json->value.float64 < 0.0 || json->value.float64 > (double)UINT64_MAX) {
+        if(number->value.float64 < 0.0 || number->value.float64 > (double)UINT64_MAX) {
             *success = false;
             return 0;
         }
         *success = true;
-        return (uint64_t)json->value.float64;
+        return (uint64_t)number->value.float64;
 
     default:
         *success = false;
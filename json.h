@@ -31,12 +31,22 @@ enum CJSON_Error {
     CJSON_ERROR_MISSING_COMMA_OR_RCURLY,
     CJSON_ERROR_MISSING_COMMA_OR_RBRACKET,
     CJSON_ERROR_FILE,
-    CJSON_ERROR_MEMORY
+    CJSON_ERROR_MEMORY,
+    CJSON_ERROR_HANDLER,
+    CJSON_ERROR_DEPTH
 };
 
+//chars is NUL terminated unless it was parsed with CJSON_PARSER_OPTION_ZERO_COPY, length is always valid
 struct CJSON_String {
-    char    *chars;
-    unsigned length;
+    const char *chars;
+    unsigned    length;
+};
+
+//a number that is decoded when it's read, chars points into the parsed input and is not NUL terminated.
+//its grammar was checked but not its range, see CJSON_PARSER_OPTION_LAZY_NUMBERS
+struct CJSON_Number {
+    const char *chars;
+    unsigned    length;
 };
 
 enum CJSON_Type {
@@ -47,11 +57,13 @@ enum CJSON_Type {
     CJSON_ARRAY,
     CJSON_OBJECT,
     CJSON_NULL,
-    CJSON_BOOL
+    CJSON_BOOL,
+    CJSON_NUMBER
 };
 
 union CJSON_Value {
     struct CJSON_String string;
+    struct CJSON_Number number;
     double              float64;
     int64_t             int64;
     uint64_t            uint64;
@@ -67,14 +79,19 @@ struct CJSON {
 };
 
 struct CJSON_KV {
-    char        *key;
+    const char  *key;
+    unsigned     key_length;
+    unsigned     hash;
     struct CJSON value;
 };
 
 struct CJSON_Array  *CJSON_make_array (struct CJSON*, struct CJSON_Parser*);
 struct CJSON_Object *CJSON_make_object(struct CJSON*, struct CJSON_Parser*);
 struct CJSON        *CJSON_get        (struct CJSON*, const char *query);
+//the value of the key if the json is an object, the key is not parsed as a query
+struct CJSON        *CJSON_get_key    (struct CJSON*, const struct CJSON_Key*);
 const char          *CJSON_get_string (struct CJSON*, const char *query, bool *success);
+const char          *CJSON_get_string_n(struct CJSON*, const char *query, unsigned *length, bool *success);
 double               CJSON_get_float64(struct CJSON*, const char *query, bool *success);
 int64_t              CJSON_get_int64  (struct CJSON*, const char *query, bool *success);
 uint64_t             CJSON_get_uint64 (struct CJSON*, const char *query, bool *success);
@@ -83,6 +100,7 @@ struct CJSON_Array  *CJSON_get_array  (struct CJSON*, const char *query, bool *s
 void                *CJSON_get_null   (struct CJSON*, const char *query, bool *success);
 bool                 CJSON_get_bool   (struct CJSON*, const char *query, bool *success);
 const char          *CJSON_as_string  (struct CJSON*, bool *success);
+const char          *CJSON_as_string_n(struct CJSON*, unsigned *length, bool *success);
 double               CJSON_as_float64 (struct CJSON*, bool *success);
 int64_t              CJSON_as_int64   (struct CJSON*, bool *success);
 uint64_t             CJSON_as_uint64  (struct CJSON*, bool *success);
@@ -3,6 +3,7 @@
 #include <assert.h>
 
 #include "lexer.h"
+#include "indexer.h"
 #include "token.h"
 #include "parser.h"
 #include "util.h"
@@ -44,13 +45,13 @@ static bool CJSON_Lexer_read_string(struct CJSON_Lexer *const lexer, struct CJSO
             escaping = false;
         } else if(c == '"') {
             token->type = CJSON_TOKEN_STRING;
-            token->length = i + 2U;
+            token->length = MIN(i + 2U, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
             return true;
         }
     }
     
     token->type = CJSON_TOKEN_INVALID;
-    token->length = i + 1U;
+    token->length = MIN(i + 1U, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
     return false;
 }
 
@@ -61,18 +62,18 @@ static bool CJSON_Lexer_read_number(struct CJSON_Lexer *const lexer, struct CJSO
     const char *data   = lexer->data;
     unsigned    length = lexer->length;
 
-    unsigned position, i;
+    unsigned position, i, sign_length;
     bool success   = true;
     bool read_dot  = false;
     bool read_e    = false;
     bool read_sign = false;
 
     if(data[lexer->position] == '-') {
-        position      = lexer->position + 1U;
-        token->length = 1U;
+        position    = lexer->position + 1U;
+        sign_length = 1U;
     } else {
-        position      = lexer->position;
-        token->length = 0U;
+        position    = lexer->position;
+        sign_length = 0U;
     }
 
     data       += position;
@@ -154,7 +155,13 @@ static bool CJSON_Lexer_read_number(struct CJSON_Lexer *const lexer, struct CJSO
         }
     }
 
-    token->length += i;
+    if(sign_length + i > CJSON_TOKEN_MAXIMUM_LENGTH) {
+        token->type   = CJSON_TOKEN_INVALID;
+        token->length = CJSON_TOKEN_MAXIMUM_LENGTH;
+        return false;
+    }
+
+    token->length = (sign_length + i) & CJSON_TOKEN_MAXIMUM_LENGTH;
 
     return success;
 }
@@ -229,67 +236,268 @@ static void CJSON_Lexer_read_invalid_token(struct CJSON_Lexer *const lexer, stru
     }
     
     token->type = CJSON_TOKEN_INVALID;
-    token->length = i - position - 1U;
+    token->length = MIN(i - position - 1U, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
+}
+
+static bool CJSON_Lexer_read_token(struct CJSON_Lexer *const lexer, struct CJSON_Token *const token) {
+    assert(lexer != NULL);
+    assert(token != NULL);
+
+    token->offset = lexer->position;
+    switch(lexer->data[lexer->position]) {
+    case '{':
+        token->length = 1U;
+        token->type   = CJSON_TOKEN_LCURLY;
+        return true;
+    case '}':
+        token->length = 1U;
+        token->type   = CJSON_TOKEN_RCURLY;
+        return true;
+    case '[':
+        token->length = 1U;
+        token->type   = CJSON_TOKEN_LBRACKET;
+        return true;
+    case ']':
+        token->length = 1U;
+        token->type   = CJSON_TOKEN_RBRACKET;
+        return true;
+    case ':':
+        token->length = 1U;
+        token->type   = CJSON_TOKEN_COLON;
+        return true;
+    case ',':
+        token->length = 1U;
+        token->type   = CJSON_TOKEN_COMMA;
+        return true;
+    case '"':
+        return CJSON_Lexer_read_string(lexer, token);
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        return CJSON_Lexer_read_number(lexer, token);
+    default: {
+        if(!CJSON_Lexer_read_keyword(lexer, token)) {
+            CJSON_Lexer_read_invalid_token(lexer, token);
+            return false;
+        }
+        return true;
+    }
+    }
 }
 
-static bool CJSON_count_containers_elements(struct CJSON_Tokens *const tokens, struct CJSON_Counters *const counters) {
+//an open container is two entries of the stack: the index of its token, since the token buffer moves when it grows,
+//and its element count on top. The count is only capped when it's written in the token so the counters get all of it.
+//an unmatched closer or comma is only reported once the whole input is lexed, so an invalid token still comes first
+struct CJSON_Lexer_Containers {
+    struct CJSON_Stack     stack;
+    enum CJSON_Lexer_Error error;
+};
+
+static void CJSON_Lexer_close_container(struct CJSON_Lexer_Containers *const containers, const struct CJSON_Tokens *const tokens, struct CJSON_Counters *const counters) {
+    assert(containers != NULL);
     assert(tokens != NULL);
     assert(counters != NULL);
 
-    struct CJSON_Stack stack;
-    CJSON_Stack_init(&stack);
-    if(!CJSON_Stack_reserve(&stack, counters->object + counters->array)) {
-        return false;
+    if(containers->stack.count == 0U) {
+        containers->error = CJSON_LEXER_ERROR_TOKEN;
+        return;
     }
 
-    bool success;
-    const struct CJSON_Token *const last_token = tokens->data + tokens->count - 1;
-    for(struct CJSON_Token *token = tokens->data, *container;
-        token != last_token + 1; 
-        token++
-    ) {
-        switch(token->type) {
-        case CJSON_TOKEN_LCURLY:
-        case CJSON_TOKEN_LBRACKET:
-            CJSON_Stack_unsafe_push(&stack, token);
-            continue;
-            
-        case CJSON_TOKEN_RCURLY:
-        case CJSON_TOKEN_RBRACKET:
-            container = (struct CJSON_Token*)CJSON_Stack_pop(&stack, &success);
-            if(!success) {
-                CJSON_Stack_free(&stack);
-                return false;
+    void *const               count     = CJSON_Stack_unsafe_pop(&containers->stack);
+    void *const               index     = CJSON_Stack_unsafe_pop(&containers->stack);
+    struct CJSON_Token *const container = tokens->data + VOID_PTR_TO_UNSIGNED(index);
+    assert(container->type == CJSON_TOKEN_LCURLY || container->type == CJSON_TOKEN_LBRACKET);
+    const unsigned elements = VOID_PTR_TO_UNSIGNED(count);
+    container->length = MIN(elements, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
+    if(container->type == CJSON_TOKEN_LCURLY) {
+        counters->object_elements += elements;
+        counters->object_tables   += CJSON_Object_table_size(elements);
+    } else {
+        counters->array_elements += MAX(elements, CJSON_ARRAY_MINIMUM_CAPACITY);
+    }
+}
+
+static void CJSON_Lexer_add_element(struct CJSON_Lexer_Containers *const containers) {
+    assert(containers != NULL);
+
+    if(containers->stack.count == 0U) {
+        containers->error = CJSON_LEXER_ERROR_TOKEN;
+        return;
+    }
+
+    void **const count = containers->stack.data + containers->stack.count - 1U;
+    *count = UNSIGNED_TO_VOID_PTR(VOID_PTR_TO_UNSIGNED(*count) + 1U);
+}
+
+//the element count of a container is written in the length of its opening token when it's closed, containers is NULL when they are not counted
+static bool CJSON_Lexer_count_token(struct CJSON_Counters *const counters, struct CJSON_Lexer_Containers *const containers, const struct CJSON_Tokens *const tokens, const struct CJSON_Token *const token) {
+    assert(counters != NULL);
+    assert(tokens != NULL);
+    assert(token != NULL);
+
+    const bool is_counting = containers != NULL && containers->error == CJSON_LEXER_ERROR_NONE;
+
+    switch(token->type) {
+    case CJSON_TOKEN_LCURLY:
+    case CJSON_TOKEN_LBRACKET:
+        return !is_counting || (
+            CJSON_Stack_push(&containers->stack, UNSIGNED_TO_VOID_PTR((unsigned)(token - tokens->data)))
+            && CJSON_Stack_push(&containers->stack, UNSIGNED_TO_VOID_PTR(1U))
+        );
+    case CJSON_TOKEN_RCURLY:
+        counters->object++;
+        if(is_counting) {
+            CJSON_Lexer_close_container(containers, tokens, counters);
+        }
+        break;
+    case CJSON_TOKEN_RBRACKET:
+        counters->array++;
+        if(is_counting) {
+            CJSON_Lexer_close_container(containers, tokens, counters);
+        }
+        break;
+    case CJSON_TOKEN_COMMA:
+        counters->comma++;
+        if(is_counting) {
+            CJSON_Lexer_add_element(containers);
+        }
+        break;
+    case CJSON_TOKEN_STRING:
+        assert(token->length >= 2U);
+        counters->string++;
+        counters->chars += CJSON_Token_length(token, tokens->input) - 1U;
+        break;
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT:
+        assert(token->length >= 1U);
+        counters->number++;
+        break;
+    case CJSON_TOKEN_BOOL:
+    case CJSON_TOKEN_NULL:
+        assert(token->length >= 4U);
+        counters->keyword++;
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+static enum CJSON_Lexer_Error CJSON_Lexer_tokenize_bytes(struct CJSON_Lexer *const lexer, struct CJSON_Tokens *const tokens, struct CJSON_Counters *const counters, struct CJSON_Lexer_Containers *const containers) {
+    assert(lexer != NULL);
+    assert(tokens != NULL);
+    assert(counters != NULL);
+
+    CJSON_Lexer_skip_whitespace(lexer);
+
+    while(lexer->position < lexer->length) {
+        struct CJSON_Token *token = CJSON_Tokens_next(tokens);
+        if(token == NULL) {
+            return CJSON_LEXER_ERROR_MEMORY;
+        }
+
+        if(!CJSON_Lexer_read_token(lexer, token)) {
+            return CJSON_LEXER_ERROR_TOKEN;
+        }
+        if(!CJSON_Lexer_count_token(counters, containers, tokens, token)) {
+            return CJSON_LEXER_ERROR_MEMORY;
+        }
+        
+        lexer->position += CJSON_Token_length(token, lexer->data);
+        CJSON_Lexer_skip_whitespace(lexer);
+    }
+
+    return CJSON_LEXER_ERROR_NONE;
+}
+
+//walks the token starts and string ends found by the indexer instead of every byte, only numbers and keywords are still read byte by byte
+static enum CJSON_Lexer_Error CJSON_Lexer_tokenize_blocks(
+    struct CJSON_Lexer *const lexer,
+    struct CJSON_Indexer *const indexer,
+    struct CJSON_Tokens *const tokens,
+    struct CJSON_Counters *const counters,
+    struct CJSON_Lexer_Containers *const containers
+) {
+    assert(lexer != NULL);
+    assert(indexer != NULL);
+    assert(tokens != NULL);
+    assert(counters != NULL);
+
+    const char *const data         = lexer->data;
+    struct CJSON_Token *open_string = NULL;
+    char padded_block[CJSON_INDEXER_BLOCK_SIZE];
+    unsigned block_start = lexer->position;
+
+    while(block_start < lexer->length) {
+        const unsigned block_size = MIN(lexer->length - block_start, CJSON_INDEXER_BLOCK_SIZE);
+        const char *block         = data + block_start;
+
+        //the last block is padded with whitespace so it never reads past the end of the input
+        if(block_size < CJSON_INDEXER_BLOCK_SIZE) {
+            memset(padded_block, ' ', sizeof(padded_block));
+            memcpy(padded_block, block, (size_t)block_size);
+            block = padded_block;
+        }
+
+        struct CJSON_Indexer_Block indexes;
+        CJSON_Indexer_next_block(indexer, block, &indexes);
+
+        uint64_t events = indexes.token_starts | indexes.string_ends;
+        while(events != 0U) {
+            const unsigned position = block_start + CJSON_Indexer_first_bit(events);
+            events &= events - 1U;
+
+            //nothing else can start before the string is closed
+            if(open_string != NULL) {
+                open_string->length = MIN(position - open_string->offset + 1U, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
+                CJSON_Lexer_count_token(counters, containers, tokens, open_string);
+                open_string = NULL;
+                continue;
             }
 
-            assert(container->type == CJSON_TOKEN_LCURLY || container->type == CJSON_TOKEN_LBRACKET);
-            if(container->type == CJSON_TOKEN_LCURLY) {
-                counters->object_elements += MAX(container->length, CJSON_OBJECT_MINIMUM_CAPACITY);
-            } else {
-                counters->array_elements += MAX(container->length, CJSON_ARRAY_MINIMUM_CAPACITY);
+            struct CJSON_Token *const token = CJSON_Tokens_next(tokens);
+            if(token == NULL) {
+                return CJSON_LEXER_ERROR_MEMORY;
             }
 
-            continue;
+            if(data[position] == '"') {
+                token->offset = position;
+                token->type  = CJSON_TOKEN_STRING;
+                open_string  = token;
+                continue;
+            }
 
-        case CJSON_TOKEN_COMMA:
-            container = (struct CJSON_Token*)CJSON_Stack_peek(&stack, &success);
-            if(!success) {
-                CJSON_Stack_free(&stack);
-                return false;
+            lexer->position = position;
+            if(!CJSON_Lexer_read_token(lexer, token)) {
+                return CJSON_LEXER_ERROR_TOKEN;
+            }
+            if(!CJSON_Lexer_count_token(counters, containers, tokens, token)) {
+                return CJSON_LEXER_ERROR_MEMORY;
             }
+        }
 
-            assert(container->type == CJSON_TOKEN_LCURLY || container->type == CJSON_TOKEN_LBRACKET);
-            container->length++;
-            
-            continue;
+        block_start += block_size;
+    }
 
-        default:
-            continue;
-        }
+    lexer->position = lexer->length;
+
+    if(open_string != NULL) {
+        open_string->type   = CJSON_TOKEN_INVALID;
+        open_string->length = MIN(lexer->length - open_string->offset, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
+        return CJSON_LEXER_ERROR_TOKEN;
     }
 
-    CJSON_Stack_free(&stack);
-    return true;
+    return CJSON_LEXER_ERROR_NONE;
 }
 
 EXTERN_C void CJSON_Lexer_init(struct CJSON_Lexer *const lexer, const char *const data, const unsigned length) {
@@ -302,99 +510,127 @@ EXTERN_C void CJSON_Lexer_init(struct CJSON_Lexer *const lexer, const char *cons
     lexer->position = 0U;
 }
 
+static enum CJSON_Lexer_Error CJSON_Lexer_run(struct CJSON_Lexer *const lexer, struct CJSON_Tokens *const tokens, struct CJSON_Counters *const counters, struct CJSON_Lexer_Containers *const containers) {
+    assert(lexer != NULL);
+    assert(tokens != NULL);
+    assert(counters != NULL);
+
+    struct CJSON_Indexer indexer;
+    CJSON_Indexer_init(&indexer);
+
+    tokens->input = lexer->data;
+    return indexer.backend == CJSON_INDEXER_BACKEND_SCALAR
+        ? CJSON_Lexer_tokenize_bytes(lexer, tokens, counters, containers)
+        : CJSON_Lexer_tokenize_blocks(lexer, &indexer, tokens, counters, containers);
+}
+
+EXTERN_C enum CJSON_Lexer_Error CJSON_Lexer_scan(struct CJSON_Lexer *const lexer, struct CJSON_Tokens *const tokens, struct CJSON_Counters *const counters) {
+    assert(lexer != NULL);
+    assert(tokens != NULL);
+    assert(counters != NULL);
+
+    return CJSON_Lexer_run(lexer, tokens, counters, NULL);
+}
+
 EXTERN_C enum CJSON_Lexer_Error CJSON_Lexer_tokenize(struct CJSON_Lexer *const lexer, struct CJSON_Tokens *const tokens, struct CJSON_Counters *const counters) {
     assert(lexer != NULL);
     assert(tokens != NULL);
     assert(counters != NULL);
 
+    struct CJSON_Lexer_Containers containers;
+    CJSON_Stack_init(&containers.stack);
+    containers.error = CJSON_LEXER_ERROR_NONE;
+
+    const enum CJSON_Lexer_Error error = CJSON_Lexer_run(lexer, tokens, counters, &containers);
+    CJSON_Stack_free(&containers.stack);
+    if(error != CJSON_LEXER_ERROR_NONE) {
+        return error;
+    }
+    if(containers.error != CJSON_LEXER_ERROR_NONE) {
+        return containers.error;
+    }
+
+    struct CJSON_Token *token = CJSON_Tokens_next(tokens);
+    if(token == NULL) {
+        return CJSON_LEXER_ERROR_MEMORY;
+    }
+
+    token->offset = lexer->length;
+    token->type   = CJSON_TOKEN_DONE;
+    token->length = 0U;
+    return CJSON_LEXER_ERROR_DONE;
+}
+
+EXTERN_C enum CJSON_Lexer_Error CJSON_Lexer_next(struct CJSON_Lexer *const lexer, struct CJSON_Token *const token) {
+    assert(lexer != NULL);
+    assert(token != NULL);
+
     CJSON_Lexer_skip_whitespace(lexer);
 
-    while(lexer->position < lexer->length) {
-        struct CJSON_Token *token = CJSON_Tokens_next(tokens);
-        if(token == NULL) {
-            return CJSON_LEXER_ERROR_MEMORY;
-        }
+    if(lexer->position >= lexer->length) {
+        token->offset = lexer->length;
+        token->length = 0U;
+        token->type   = CJSON_TOKEN_DONE;
+        return CJSON_LEXER_ERROR_DONE;
+    }
 
-        token->value = lexer->data + lexer->position;
-        switch(*token->value) {
-        case '{':
-            token->length = 1U;
-            token->type   = CJSON_TOKEN_LCURLY;
-            break;
-        case '}':
-            token->length = 1U;
-            token->type   = CJSON_TOKEN_RCURLY;
-            counters->object++;
-            break;
-        case '[':
-            token->length = 1U;
-            token->type   = CJSON_TOKEN_LBRACKET;
-            break;
-        case ']':
-            token->length = 1U;
-            token->type   = CJSON_TOKEN_RBRACKET;
-            counters->array++;
-            break;
-        case ':':
-            token->length = 1U;
-            token->type   = CJSON_TOKEN_COLON;
-            break;
-        case ',': {
-            token->length = 1U;
-            token->type   = CJSON_TOKEN_COMMA;
-            counters->comma++;
+    if(!CJSON_Lexer_read_token(lexer, token)) {
+        return CJSON_LEXER_ERROR_TOKEN;
+    }
+
+    lexer->position += CJSON_Token_length(token, lexer->data);
+    return CJSON_LEXER_ERROR_NONE;
+}
+
+//a string longer than CJSON_TOKEN_MAXIMUM_LENGTH is read again to find its closing quote, it was lexed so it has one
+EXTERN_C unsigned CJSON_Token_length(const struct CJSON_Token *const token, const char *const data) {
+    assert(token != NULL);
+    assert(data != NULL);
+
+    if(token->length < CJSON_TOKEN_MAXIMUM_LENGTH || token->type != CJSON_TOKEN_STRING) {
+        return token->length;
+    }
+
+    const char *const start   = data + token->offset;
+    const char       *current = start + 1;
+    while(*current != '"') {
+        current += *current == '\\' ? 2 : 1;
+    }
+
+    return (unsigned)(current - start) + 1U;
+}
+
+//a container with more than CJSON_TOKEN_MAXIMUM_LENGTH elements has its root commas counted again
+EXTERN_C unsigned CJSON_Token_count(const struct CJSON_Token *const container) {
+    assert(container != NULL);
+    assert(container->type == CJSON_TOKEN_LCURLY || container->type == CJSON_TOKEN_LBRACKET);
+
+    if(container->length < CJSON_TOKEN_MAXIMUM_LENGTH) {
+        return container->length;
+    }
+
+    unsigned count = 1U;
+    unsigned depth = 0U;
+    for(const struct CJSON_Token *token = container + 1; token->type != CJSON_TOKEN_DONE; token++) {
+        switch(token->type) {
+        case CJSON_TOKEN_LCURLY:
+        case CJSON_TOKEN_LBRACKET:
+            depth++;
             break;
-        }
-        case '"': {
-            if(!CJSON_Lexer_read_string(lexer, token)) {
-                return CJSON_LEXER_ERROR_TOKEN;
+        case CJSON_TOKEN_RCURLY:
+        case CJSON_TOKEN_RBRACKET:
+            if(depth == 0U) {
+                return count;
             }
-            assert(token->length >= 2U);
-            counters->string++;
-            counters->chars += token->length - 1U;
+            depth--;
             break;
-        }
-        case '-':
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9': {
-            if(!CJSON_Lexer_read_number(lexer, token)) {
-                return CJSON_LEXER_ERROR_TOKEN;
-            }
-            assert(token->length >= 1U);
-            counters->number++;
+        case CJSON_TOKEN_COMMA:
+            count += depth == 0U ? 1U : 0U;
             break;
-        }
-        default: {
-            if(!CJSON_Lexer_read_keyword(lexer, token)) {
-                CJSON_Lexer_read_invalid_token(lexer, token);
-                return CJSON_LEXER_ERROR_TOKEN;
-            }
-            assert(token->length >= 4U);
-            counters->keyword++;
+        default:
             break;
         }
-        }
-        
-        lexer->position += token->length;
-        CJSON_Lexer_skip_whitespace(lexer);
     }
 
-    struct CJSON_Token *token = CJSON_Tokens_next(tokens);
-    if(token == NULL) {
-        return CJSON_LEXER_ERROR_MEMORY;
-    }
-
-    token->type = CJSON_TOKEN_DONE;
-    token->length = 0U;
-    return CJSON_count_containers_elements(tokens, counters)
-        ? CJSON_LEXER_ERROR_DONE
-        : CJSON_LEXER_ERROR_MEMORY;
+    return count;
 }
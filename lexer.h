@@ -24,8 +24,12 @@ struct CJSON_Lexer {
                 position;
 };
 
-void CJSON_Lexer_init(struct CJSON_Lexer*, const char *data, unsigned length);
+void                   CJSON_Lexer_init    (struct CJSON_Lexer*, const char *data, unsigned length);
 enum CJSON_Lexer_Error CJSON_Lexer_tokenize(struct CJSON_Lexer*, struct CJSON_Tokens*, struct CJSON_Counters*);
+//the tokens from the position to the end without the CJSON_TOKEN_DONE and the container elements counters,
+//the position must be outside of a string and of a token
+enum CJSON_Lexer_Error CJSON_Lexer_scan    (struct CJSON_Lexer*, struct CJSON_Tokens*, struct CJSON_Counters*);
+enum CJSON_Lexer_Error CJSON_Lexer_next    (struct CJSON_Lexer*, struct CJSON_Token*);
 
 #endif
 
@@ -0,0 +1,22 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_NUMBER_H
+#define CJSON_NUMBER_H
+
+#include <stdbool.h>
+#include "json.h"
+
+//decodes the JSON number in chars[0..length) without copying it.
+//integers become CJSON_UINT64 or CJSON_INT64 (negative), numbers with a fraction become CJSON_FLOAT64
+//and numbers with an exponent become an integer if their value is an integer that fits, CJSON_FLOAT64 otherwise.
+enum CJSON_Error CJSON_Number_decode(const char *chars, unsigned length, struct CJSON*);
+//only checks the grammar of the JSON number in chars[0..length), nothing is decoded
+bool             CJSON_Number_is_valid(const char *chars, unsigned length);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,54 +7,485 @@
 #include "parser.h"
 #include "util.h"
 #include "object.h"
+#include "indexer.h"
+#include "symbols.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+#   define CJSON_OBJECT_SSE2
+#   include <emmintrin.h>
+#endif
+
+//a control byte is one of these or the low 7 bits of the hash of the key of a used entry
+#define CJSON_CONTROL_EMPTY    0x80U
+#define CJSON_CONTROL_DELETED  0xFEU
+#define CJSON_CONTROL_SENTINEL 0xFFU //pads the control bytes of a table smaller than a group
+
+#define CJSON_CONTROL_HASH(HASH)  ((unsigned char)((HASH) & 0x7FU))
+#define CJSON_CONTROL_GROUP(HASH) ((HASH) >> 7)
 
 static char DELETED_ENTRY[] = {0};
 
-static unsigned CJSON_hash(const char *key) {
+//one bit per control byte of the group equal to the byte
+static unsigned CJSON_Group_match(const unsigned char *const group, const unsigned char byte) {
+    assert(group != NULL);
+
+#ifdef CJSON_OBJECT_SSE2
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)(const void*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)byte)));
+#else
+    unsigned mask = 0U;
+    for(unsigned i = 0U; i < CJSON_OBJECT_GROUP_SIZE; i++) {
+        mask |= (unsigned)(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+//one bit per empty or deleted entry of the group
+static unsigned CJSON_Group_match_free(const unsigned char *const group) {
+    assert(group != NULL);
+
+#ifdef CJSON_OBJECT_SSE2
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)(const void*)group);
+    return (unsigned)_mm_movemask_epi8(bytes) & ~CJSON_Group_match(group, CJSON_CONTROL_SENTINEL);
+#else
+    unsigned mask = 0U;
+    for(unsigned i = 0U; i < CJSON_OBJECT_GROUP_SIZE; i++) {
+        mask |= (unsigned)(group[i] == CJSON_CONTROL_EMPTY || group[i] == CJSON_CONTROL_DELETED) << i;
+    }
+    return mask;
+#endif
+}
+
+//the slot count of the object, 0 for an object without a table
+static unsigned CJSON_Object_slots(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    return object->header == NULL ? 0U : object->header->slot_count;
+}
+
+static unsigned CJSON_Object_group_count(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    return MAX(CJSON_Object_slots(object) / CJSON_OBJECT_GROUP_SIZE, 1U);
+}
+
+//the slots hold 8, 16 or 32 bit entry indexes, whichever fits the capacity
+static unsigned CJSON_Object_index_size(const unsigned capacity) {
+    return capacity <= 1U << 8  ? 1U
+         : capacity <= 1U << 16 ? 2U
+         : 4U;
+}
+
+//the shape of a shaped object, NULL for an object with its own entries
+static const struct CJSON_Shape *CJSON_Object_shape(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    return object->header == NULL ? NULL : object->header->shape;
+}
+
+//the entries follow the header, NULL for an object without entries
+static struct CJSON_KV *CJSON_Object_entries(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+    assert(CJSON_Object_shape(object) == NULL);
+
+    return object->header == NULL ? NULL : (struct CJSON_KV*)(void*)(object->header + 1);
+}
+
+//the values of a shaped object follow the header in the order of the keys of the shape
+static struct CJSON *CJSON_Object_values(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+    assert(CJSON_Object_shape(object) != NULL);
+    assert(object->header != NULL);
+
+    return (struct CJSON*)(void*)(object->header + 1);
+}
+
+//the control bytes follow the entries
+static unsigned char *CJSON_Object_control(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+    assert(CJSON_Object_slots(object) > 0U);
+
+    return (unsigned char*)(CJSON_Object_entries(object) + object->capacity);
+}
+
+//the indexes follow the control bytes, there are at least a group of them
+static void *CJSON_Object_indexes(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    return CJSON_Object_control(object) + MAX(object->header->slot_count, CJSON_OBJECT_GROUP_SIZE);
+}
+
+static unsigned CJSON_Object_get_index(const struct CJSON_Object *const object, const unsigned slot) {
+    assert(object != NULL);
+    assert(slot < CJSON_Object_slots(object));
+
+    switch(CJSON_Object_index_size(object->capacity)) {
+    case 1U:
+        return ((const uint8_t*)CJSON_Object_indexes(object))[slot];
+    case 2U:
+        return ((const uint16_t*)CJSON_Object_indexes(object))[slot];
+    default:
+        return ((const uint32_t*)CJSON_Object_indexes(object))[slot];
+    }
+}
+
+static void CJSON_Object_set_index(struct CJSON_Object *const object, const unsigned slot, const unsigned index) {
+    assert(object != NULL);
+    assert(slot < CJSON_Object_slots(object));
+    assert(index < object->capacity);
+
+    switch(CJSON_Object_index_size(object->capacity)) {
+    case 1U:
+        ((uint8_t*)CJSON_Object_indexes(object))[slot] = (uint8_t)index;
+        break;
+    case 2U:
+        ((uint16_t*)CJSON_Object_indexes(object))[slot] = (uint16_t)index;
+        break;
+    default:
+        ((uint32_t*)CJSON_Object_indexes(object))[slot] = (uint32_t)index;
+    }
+}
+
+static unsigned CJSON_key_length(const char *const key) {
+    assert(key != NULL);
+
+    const size_t key_length = strlen(key);
+    assert(key_length < UINT_MAX);
+
+    return (unsigned)key_length;
+}
+
+//the slot of the key or the slot count if it's not in the object.
+//the groups are probed from the one picked by the hash with a triangular sequence, it visits every group once
+static unsigned CJSON_Object_find_slot(const struct CJSON_Object *const object, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(object != NULL);
     assert(key != NULL);
-    assert(strlen(key) <= UINT_MAX);
 
-    unsigned hash = 0U;
-    while(*key != '\0') {
-        hash += (unsigned)(*key);
-        hash += hash << 10;
-        hash ^= hash >> 6;
-        key++;
+    const unsigned slot_count = CJSON_Object_slots(object);
+    if(slot_count == 0U) {
+        return 0U;
     }
-    hash += hash << 3;
-    hash ^= hash >> 11;
-    hash += hash << 15;
 
-    return hash;
+    const struct CJSON_KV *const entries      = CJSON_Object_entries(object);
+    const unsigned               group_mask   = CJSON_Object_group_count(object) - 1U;
+    const unsigned char          control_hash = CJSON_CONTROL_HASH(hash);
+    unsigned                     group        = CJSON_CONTROL_GROUP(hash) & group_mask;
+
+    for(unsigned probe = 1U; probe <= group_mask + 1U; probe++) {
+        const unsigned char *const control = CJSON_Object_control(object) + group * CJSON_OBJECT_GROUP_SIZE;
+
+        for(unsigned match = CJSON_Group_match(control, control_hash); match != 0U; match &= match - 1U) {
+            const unsigned               slot  = group * CJSON_OBJECT_GROUP_SIZE + CJSON_Indexer_first_bit(match);
+            const struct CJSON_KV *const entry = entries + CJSON_Object_get_index(object, slot);
+            if(entry->hash == hash && entry->key_length == key_length && (entry->key == key || memcmp(entry->key, key, (size_t)key_length) == 0)) {
+                return slot;
+            }
+        }
+
+        if(CJSON_Group_match(control, CJSON_CONTROL_EMPTY) != 0U) {
+            break;
+        }
+
+        group = (group + probe) & group_mask;
+    }
+
+    return slot_count;
 }
 
-static bool CJSON_Object_resize(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const unsigned capacity) {
+//a small object has no slots, its entries are compared one by one without hashing the key.
+//the length and the first byte rule most of them out before memcmp
+static struct CJSON_KV *CJSON_Object_scan(const struct CJSON_Object *const object, const char *const key, const unsigned key_length) {
     assert(object != NULL);
+    assert(key != NULL);
+    assert(CJSON_Object_slots(object) == 0U);
+
+    struct CJSON_KV *const entries = CJSON_Object_entries(object);
+    const unsigned         length  = CJSON_Object_length(object);
+    for(unsigned i = 0U; i < length; i++) {
+        struct CJSON_KV *const entry = entries + i;
+        if(entry->key_length != key_length || !CJSON_KV_is_used(entry)) {
+            continue;
+        }
+
+        if(entry->key == key || key_length == 0U || (entry->key[0] == key[0] && memcmp(entry->key, key, (size_t)key_length) == 0)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static struct CJSON_KV *CJSON_Object_find_hashed(const struct CJSON_Object *const object, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(object != NULL);
+    assert(key != NULL);
+
+    const unsigned slot_count = CJSON_Object_slots(object);
+    if(slot_count == 0U) {
+        return CJSON_Object_scan(object, key, key_length);
+    }
+
+    const unsigned slot = CJSON_Object_find_slot(object, key, key_length, hash);
+
+    return slot < slot_count ? CJSON_Object_entries(object) + CJSON_Object_get_index(object, slot) : NULL;
+}
+
+//the keys of a shaped object are the ones of its shape
+static const struct CJSON_Object *CJSON_Object_keys(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    const struct CJSON_Shape *const shape = CJSON_Object_shape(object);
+
+    return shape == NULL ? object : &shape->keys;
+}
+
+//the keys of the shape are interned like the parsed ones, they are mostly the same pointer
+static bool CJSON_Shape_is_key(const struct CJSON_Shape *const shape, const unsigned index, const char *const key, const unsigned key_length) {
+    assert(shape != NULL);
+    assert(index < CJSON_Object_length(&shape->keys));
+    assert(key != NULL);
+
+    const struct CJSON_KV *const expected = CJSON_Object_entries(&shape->keys) + index;
+
+    return expected->key_length == key_length && (expected->key == key || memcmp(expected->key, key, (size_t)key_length) == 0);
+}
+
+//a deleted value of a shaped object, its key is in the shape so the value is marked instead
+static bool CJSON_Object_is_deleted(const struct CJSON *const value) {
+    assert(value != NULL);
+
+    return value->type == CJSON_NULL && value->value.null == DELETED_ENTRY;
+}
+
+//the value of an entry found in the keys of the object
+static struct CJSON *CJSON_Object_value_of(const struct CJSON_Object *const object, struct CJSON_KV *const entry) {
+    assert(object != NULL);
+
+    const struct CJSON_Shape *const shape = CJSON_Object_shape(object);
+    if(entry == NULL || shape == NULL) {
+        return entry == NULL ? NULL : &entry->value;
+    }
+
+    const unsigned      index = (unsigned)(entry - CJSON_Object_entries(&shape->keys));
+    struct CJSON *const value = CJSON_Object_values(object) + index;
+
+    return index < CJSON_Object_length(object) && !CJSON_Object_is_deleted(value) ? value : NULL;
+}
+
+static struct CJSON_KV *CJSON_Object_find_key(const struct CJSON_Object *const object, const char *const key, const unsigned key_length) {
+    assert(object != NULL);
+    assert(key != NULL);
+
+    if(CJSON_Object_slots(object) == 0U) {
+        return CJSON_Object_scan(object, key, key_length);
+    }
+
+    return CJSON_Object_find_hashed(object, key, key_length, CJSON_hash(key, key_length));
+}
+
+static bool CJSON_Object_same_keys(const struct CJSON_Object *const object, const struct CJSON_Object *const other) {
+    assert(object != NULL);
+    assert(other != NULL);
+
+    const unsigned count = CJSON_Object_count(object);
+    const unsigned length = CJSON_Object_length(object);
+    if(length != CJSON_Object_length(other) || count != CJSON_Object_count(other) || count != length) {
+        return false;
+    }
+
+    const struct CJSON_KV *const entries       = CJSON_Object_entries(object);
+    const struct CJSON_KV *const other_entries = CJSON_Object_entries(other);
+    for(unsigned i = 0U; i < length; i++) {
+        const struct CJSON_KV *const entry       = entries + i;
+        const struct CJSON_KV *const other_entry = other_entries + i;
+        if(entry->key_length != other_entry->key_length || !CJSON_KV_is_used(entry) || !CJSON_KV_is_used(other_entry)) {
+            return false;
+        }
+        if(entry->key != other_entry->key && memcmp(entry->key, other_entry->key, (size_t)entry->key_length) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//the first empty or deleted slot of the probe sequence of the hash, the slots are never full
+static unsigned CJSON_Object_find_free(const struct CJSON_Object *const object, const unsigned hash) {
+    assert(object != NULL);
+    assert(CJSON_Object_slots(object) > 0U);
+
+    const unsigned group_mask = CJSON_Object_group_count(object) - 1U;
+    unsigned       group      = CJSON_CONTROL_GROUP(hash) & group_mask;
+
+    for(unsigned probe = 1U; ; probe++) {
+        const unsigned match = CJSON_Group_match_free(CJSON_Object_control(object) + group * CJSON_OBJECT_GROUP_SIZE);
+        if(match != 0U) {
+            return group * CJSON_OBJECT_GROUP_SIZE + CJSON_Indexer_first_bit(match);
+        }
+
+        group = (group + probe) & group_mask;
+    }
+}
+
+//appends an entry and points a free slot to it if the object has slots, the key is set by the caller
+static struct CJSON_KV *CJSON_Object_append(struct CJSON_Object *const object, const unsigned key_length, const unsigned hash) {
+    assert(object != NULL);
+    assert(object->header != NULL);
+    assert(object->header->length < object->capacity);
+
+    if(object->header->slot_count > 0U) {
+        const unsigned slot = CJSON_Object_find_free(object, hash);
+        CJSON_Object_control(object)[slot] = CJSON_CONTROL_HASH(hash);
+        CJSON_Object_set_index(object, slot, object->header->length);
+    }
+
+    struct CJSON_KV *const entry = CJSON_Object_entries(object) + object->header->length;
+    entry->key_length = key_length;
+    entry->hash       = hash;
+    object->header->length++;
+    object->header->count++;
+
+    return entry;
+}
+
+//one allocation for the header and the elements that follow it, extra_size bytes are added after them
+static struct CJSON_Object_Header *CJSON_Object_allocate(struct CJSON_Parser *const parser, const unsigned count, const unsigned element_size, const unsigned extra_size) {
     assert(parser != NULL);
-    assert(capacity > object->capacity);
 
-    struct CJSON_KV *const old_entries  = object->entries;
-    const unsigned         old_capacity = object->capacity;
-    struct CJSON_KV *const entries      = CJSON_ARENA_ALLOC(&parser->object_arena, capacity, struct CJSON_KV);
-    if(entries == NULL) {
+    bool success;
+    const unsigned elements_size = CJSON_safe_unsigned_mult(count, element_size, &success);
+    if(!success || elements_size > UINT_MAX - extra_size) {
+        return NULL;
+    }
+
+    struct CJSON_Object_Header *const header = (struct CJSON_Object_Header*)CJSON_Arena_alloc(
+        &parser->object_arena,
+        elements_size + extra_size,
+        (unsigned)CJSON_ALIGNOF(struct CJSON_KV)
+    );
+    if(header == NULL) {
+        return NULL;
+    }
+    header->shape      = NULL;
+    header->length     = 0U;
+    header->count      = 0U;
+    header->slot_count = 0U;
+
+    return header;
+}
+
+//moves the entries in new arrays of the capacity without the deleted ones, the hashes are kept in the entries
+//so the keys are not hashed again. A shaped object gets its own entries from the keys of its shape
+static bool CJSON_Object_rebuild(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const unsigned capacity) {
+    assert(object != NULL);
+    assert(parser != NULL);
+    assert(capacity >= CJSON_Object_count(object));
+    assert(capacity > 0U);
+
+    struct CJSON_Object_Header *const header = CJSON_Object_allocate(parser, capacity, (unsigned)sizeof(struct CJSON_KV), CJSON_Object_table_size(capacity));
+    if(header == NULL) {
         return false;
     }
 
-    object->entries = entries;
+    const struct CJSON_Object       old_object = *object;
+    const struct CJSON_KV    *const old_keys   = CJSON_Object_entries(CJSON_Object_keys(&old_object));
+
+    object->header   = header;
     object->capacity = capacity;
 
-    for(unsigned i = 0U; i < old_capacity; i++) {
-        struct CJSON_KV *const old_entry = old_entries + i;
-        if(CJSON_KV_is_used(old_entries)) {
-            struct CJSON_KV *const entry = CJSON_Object_get_entry(object, parser, old_entry->key);
+    if(capacity > CJSON_OBJECT_SMALL_CAPACITY) {
+        const unsigned slot_count = CJSON_Object_slot_count(capacity);
+        header->slot_count = slot_count;
+
+        unsigned char *const control = CJSON_Object_control(object);
+        memset(control, CJSON_CONTROL_EMPTY, (size_t)slot_count);
+        memset(control + slot_count, CJSON_CONTROL_SENTINEL, (size_t)(MAX(slot_count, CJSON_OBJECT_GROUP_SIZE) - slot_count));
+    }
+
+    for(unsigned i = 0U; i < CJSON_Object_length(&old_object); i++) {
+        const struct CJSON_KV *const old_entry = old_keys + i;
+        const struct CJSON    *const old_value = CJSON_Object_value_at(&old_object, i);
+        if(CJSON_KV_is_used(old_entry) && !CJSON_Object_is_deleted(old_value)) {
+            struct CJSON_KV *const entry = CJSON_Object_append(object, old_entry->key_length, old_entry->hash);
             entry->key   = old_entry->key;
-            entry->value = old_entry->value;
+            entry->value = *old_value;
         }
     }
 
     return true;
 }
 
+//the words are read as little endian everywhere so the hash matches the one computed at compile time by CJSON_KEY
+static uint64_t CJSON_load_little_endian(const char *const bytes) {
+    assert(bytes != NULL);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    uint64_t word = 0U;
+    for(unsigned i = 8U; i-- > 0U;) {
+        word = (word << 8) | (unsigned char)bytes[i];
+    }
+    return word;
+#else
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+#endif
+}
+
+EXTERN_C unsigned CJSON_hash(const char *const key, const unsigned key_length) {
+    assert(key != NULL);
+
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ key_length;
+    unsigned i    = 0U;
+    for(; i + 8U <= key_length; i += 8U) {
+        hash  = (hash ^ CJSON_load_little_endian(key + i)) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    }
+
+    uint64_t tail = 0U;
+    for(; i < key_length; i++) {
+        tail = (tail << 8) | (unsigned char)key[i];
+    }
+    hash  = (hash ^ tail) * 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 29;
+
+    return (unsigned)(hash ^ (hash >> 32));
+}
+
+EXTERN_C struct CJSON_Key CJSON_Key_make(const char *const chars, const unsigned length) {
+    assert(chars != NULL);
+
+    struct CJSON_Key key;
+    key.chars  = chars;
+    key.length = length;
+    key.hash   = CJSON_hash(chars, length);
+
+    return key;
+}
+
+EXTERN_C unsigned CJSON_Object_slot_count(const unsigned capacity) {
+    unsigned slot_count = CJSON_OBJECT_MINIMUM_SLOTS;
+    while(capacity > slot_count - slot_count / 8U) {
+        assert(slot_count <= UINT_MAX / 2U);
+        slot_count *= 2U;
+    }
+
+    return slot_count;
+}
+
+EXTERN_C unsigned CJSON_Object_table_size(const unsigned capacity) {
+    if(capacity == 0U) {
+        return 0U;
+    }
+    if(capacity <= CJSON_OBJECT_SMALL_CAPACITY) {
+        return (unsigned)sizeof(struct CJSON_Object_Header);
+    }
+
+    const unsigned slot_count = CJSON_Object_slot_count(capacity);
+
+    return (unsigned)sizeof(struct CJSON_Object_Header) + MAX(slot_count, CJSON_OBJECT_GROUP_SIZE) + slot_count * CJSON_Object_index_size(capacity);
+}
+
 EXTERN_C bool CJSON_KV_is_used(const struct CJSON_KV *const entry) { 
     assert(entry != NULL);
 
@@ -64,99 +495,221 @@ EXTERN_C bool CJSON_KV_is_used(const struct CJSON_KV *const entry) {
 EXTERN_C void CJSON_Object_init(struct CJSON_Object *const object) {
     assert(object != NULL);
 
-    object->entries  = NULL;
+    object->header   = NULL;
     object->capacity = 0U;
 }
 
-EXTERN_C bool CJSON_Object_reserve(struct CJSON_Object *const object, struct CJSON_Parser *const parser, unsigned capacity) {
+EXTERN_C unsigned CJSON_Object_length(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    return object->header == NULL ? 0U : object->header->length;
+}
+
+EXTERN_C unsigned CJSON_Object_count(const struct CJSON_Object *const object) {
+    assert(object != NULL);
+
+    return object->header == NULL ? 0U : object->header->count;
+}
+
+EXTERN_C bool CJSON_Object_reserve(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const unsigned count) {
     assert(object != NULL);
     assert(parser != NULL);
 
-    if(capacity < CJSON_OBJECT_MINIMUM_CAPACITY) {
-        capacity = CJSON_OBJECT_MINIMUM_CAPACITY;
+    if(count <= object->capacity - CJSON_Object_length(object) + CJSON_Object_count(object)) {
+        return true;
     }
 
-    if(capacity <= object->capacity) {
-        return true;
+    return CJSON_Object_rebuild(object, parser, count);
+}
+
+EXTERN_C struct CJSON_KV *CJSON_Object_get_entry(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const char *const key, const unsigned key_length) {
+    assert(object != NULL);
+    assert(key != NULL);
+
+    return CJSON_Object_get_entry_hashed(object, parser, key, key_length, CJSON_hash(key, key_length));
+}
+
+EXTERN_C struct CJSON_KV *CJSON_Object_get_entry_hashed(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(object != NULL);
+    assert(key != NULL);
+    assert(hash == CJSON_hash(key, key_length));
+
+    //the shape is shared with other objects, this one needs its own entries to be changed
+    if(CJSON_Object_shape(object) != NULL && !CJSON_Object_rebuild(object, parser, MAX(object->capacity, CJSON_OBJECT_MINIMUM_CAPACITY))) {
+        return NULL;
     }
-    
-    struct CJSON_KV *entries = CJSON_ARENA_ALLOC(&parser->object_arena, capacity, struct CJSON_KV);
-    if(entries == NULL) {
+
+    struct CJSON_KV *const entry = CJSON_Object_find_hashed(object, key, key_length, hash);
+    if(entry != NULL) {
+        return entry;
+    }
+
+    //the deleted entries are dropped when the entries are full, the capacity doubles if they were the only thing making room
+    if(CJSON_Object_length(object) == object->capacity) {
+        bool success;
+        const unsigned capacity = CJSON_safe_unsigned_mult(CJSON_Object_count(object), 2U, &success);
+        if(!success || !CJSON_Object_rebuild(object, parser, MAX(capacity, CJSON_OBJECT_MINIMUM_CAPACITY))) {
+            return NULL;
+        }
+    }
+
+    //the key is set by the caller, it's NULL until then
+    return CJSON_Object_append(object, key_length, hash);
+}
+
+EXTERN_C bool CJSON_Object_find_entry(const struct CJSON_Object *const object, const char *const key, const unsigned key_length, struct CJSON_Entry *const entry) {
+    assert(object != NULL);
+    assert(key != NULL);
+    assert(entry != NULL);
+
+    struct CJSON_KV *const found = CJSON_Object_find_key(CJSON_Object_keys(object), key, key_length);
+    struct CJSON    *const value = CJSON_Object_value_of(object, found);
+    if(value == NULL) {
         return false;
     }
 
-    object->entries  = entries;
-    object->capacity = capacity;
-    
+    entry->key        = found->key;
+    entry->key_length = found->key_length;
+    entry->value      = value;
+
     return true;
 }
 
-EXTERN_C struct CJSON_KV *CJSON_Object_get_entry(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const char *const key) {
+EXTERN_C bool CJSON_Object_start(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const unsigned count) {
     assert(object != NULL);
-    assert(key != NULL);
+    assert(parser != NULL);
 
-    if(object->capacity == 0) {
-        if(!CJSON_Object_reserve(object, parser, 0U)) {
-            return NULL;
-        }
+    CJSON_Object_init(object);
+
+    const struct CJSON_Shape *const shape = parser->shape;
+    if(shape == NULL || CJSON_Object_count(&shape->keys) != count) {
+        return CJSON_Object_reserve(object, parser, count);
     }
 
-    const unsigned start = CJSON_hash(key) % object->capacity;
-    unsigned i = start; 
-    while(
-        object->entries[i].key != NULL 
-        && object->entries[i].key != DELETED_ENTRY
-        && strcmp(object->entries[i].key, key
-    ) != 0) {
-        i = (i + 1U) % object->capacity;
-        if(i == start) {
-            if(!CJSON_Object_resize(object, parser, object->capacity * 2U)) {
+    //nothing is allocated until the first key is known, the count is kept in the capacity without a header
+    object->capacity = count;
+
+    return true;
+}
+
+EXTERN_C struct CJSON *CJSON_Object_add(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(object != NULL);
+    assert(parser != NULL);
+    assert(key != NULL);
+
+    //an object started with the count of the shape gets its values once its first key is the first key of the shape,
+    //otherwise it gets its own entries without allocating values for nothing
+    if(object->header == NULL && object->capacity > 0U) {
+        const unsigned count = object->capacity;
+        object->capacity = 0U;
+
+        const struct CJSON_Shape *const shape = parser->shape;
+        if(shape == NULL || CJSON_Object_count(&shape->keys) != count || !CJSON_Shape_is_key(shape, 0U, key, key_length)) {
+            if(!CJSON_Object_reserve(object, parser, count)) {
                 return NULL;
             }
-            return CJSON_Object_get_entry(object, parser, key);
+        } else {
+            struct CJSON_Object_Header *const header = CJSON_Object_allocate(parser, count, (unsigned)sizeof(struct CJSON), (unsigned)sizeof(struct CJSON_Object_Header));
+            if(header == NULL) {
+                return NULL;
+            }
+
+            header->shape    = shape;
+            object->header   = header;
+            object->capacity = count;
         }
     }
 
-    return object->entries + i;
+    const struct CJSON_Shape *const shape = CJSON_Object_shape(object);
+    if(shape != NULL && object->header->length < object->capacity && CJSON_Shape_is_key(shape, object->header->length, key, key_length)) {
+        object->header->count++;
+        return CJSON_Object_values(object) + object->header->length++;
+    }
+
+    struct CJSON_KV *const entry = CJSON_Object_get_entry_hashed(object, parser, key, key_length, hash);
+    if(entry == NULL) {
+        return NULL;
+    }
+    entry->key        = key;
+    entry->key_length = key_length;
+
+    return &entry->value;
 }
 
-EXTERN_C struct CJSON_KV *CJSON_Object_find_entry(const struct CJSON_Object *const object, const char *const key) {
+//the shape is only made once two objects in a row have the same keys, the objects after them share it as long as
+//their keys match. The last object is copied since its container may still move it
+EXTERN_C void CJSON_Object_finish(struct CJSON_Object *const object, struct CJSON_Parser *const parser) {
     assert(object != NULL);
-    assert(key != NULL);
+    assert(parser != NULL);
 
-    if(object->capacity == 0) {
-        return NULL;
+    if(CJSON_Object_shape(object) != NULL || CJSON_Object_count(object) == 0U) {
+        return;
     }
 
-    const unsigned start = CJSON_hash(key) % object->capacity;
-    unsigned i = start; 
-    do {
-        if(object->entries[i].key == DELETED_ENTRY) {
-            i = (i + 1U) % object->capacity;
-            continue;
+    if(CJSON_Object_same_keys(object, &parser->last_object)) {
+        struct CJSON_Shape *const shape = CJSON_ARENA_ALLOC(&parser->object_arena, 1U, struct CJSON_Shape);
+        if(shape != NULL) {
+            shape->keys = *object;
+            if(CJSON_Object_rebuild(&shape->keys, parser, CJSON_Object_count(object))) {
+                parser->shape = shape;
+            }
         }
+    }
 
-        if(object->entries[i].key == NULL) {
-            return NULL;
-        } 
+    parser->last_object = *object;
+}
 
-        if(strcmp(object->entries[i].key, key) == 0) {
-            return object->entries + i;
-        }
+EXTERN_C const char *CJSON_Object_key_at(const struct CJSON_Object *const object, const unsigned index, unsigned *const key_length) {
+    assert(object != NULL);
+    assert(index < CJSON_Object_length(object));
+    assert(key_length != NULL);
 
-        i = (i + 1U) % object->capacity;
-    } while(i != start);
+    const struct CJSON_KV *const entry = CJSON_Object_entries(CJSON_Object_keys(object)) + index;
+    if(!CJSON_KV_is_used(entry) || (CJSON_Object_shape(object) != NULL && CJSON_Object_is_deleted(CJSON_Object_values(object) + index))) {
+        return NULL;
+    }
 
-    return NULL;
+    *key_length = entry->key_length;
+
+    return entry->key;
+}
+
+EXTERN_C struct CJSON *CJSON_Object_value_at(const struct CJSON_Object *const object, const unsigned index) {
+    assert(object != NULL);
+    assert(index < CJSON_Object_length(object));
+
+    return CJSON_Object_shape(object) == NULL
+        ? &CJSON_Object_entries(object)[index].value
+        : CJSON_Object_values(object) + index;
 }
 
 EXTERN_C struct CJSON *CJSON_Object_get(const struct CJSON_Object *const object, const char *const key) {
     assert(object != NULL);
     assert(key != NULL);
 
-    struct CJSON_KV *const entry = CJSON_Object_find_entry(object, key);
+    return CJSON_Object_get_n(object, key, CJSON_key_length(key));
+}
+
+EXTERN_C struct CJSON *CJSON_Object_get_n(const struct CJSON_Object *const object, const char *const key, const unsigned key_length) {
+    assert(object != NULL);
+    assert(key != NULL);
 
-    return entry == NULL ? NULL : &entry->value;
+    return CJSON_Object_value_of(object, CJSON_Object_find_key(CJSON_Object_keys(object), key, key_length));
+}
+
+EXTERN_C struct CJSON *CJSON_Object_get_hashed(const struct CJSON_Object *const object, const char *const key, const unsigned key_length, const unsigned hash) {
+    assert(object != NULL);
+    assert(key != NULL);
+    assert(hash == CJSON_hash(key, key_length));
+
+    return CJSON_Object_value_of(object, CJSON_Object_find_hashed(CJSON_Object_keys(object), key, key_length, hash));
+}
+
+EXTERN_C struct CJSON *CJSON_Object_get_key(const struct CJSON_Object *const object, const struct CJSON_Key *const key) {
+    assert(object != NULL);
+    assert(key != NULL);
+
+    return CJSON_Object_get_hashed(object, key->chars, key->length, key->hash);
 }
 
 EXTERN_C bool CJSON_Object_set(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const char *const key, const struct CJSON *const value) {
@@ -164,14 +717,35 @@ EXTERN_C bool CJSON_Object_set(struct CJSON_Object *const object, struct CJSON_P
     assert(parser != NULL);
     assert(key != NULL);
     assert(value != NULL);
+
+    return CJSON_Object_set_n(object, parser, key, CJSON_key_length(key), value);
+}
+
+EXTERN_C bool CJSON_Object_set_n(struct CJSON_Object *const object, struct CJSON_Parser *const parser, const char *const key, const unsigned key_length, const struct CJSON *const value) {
+    assert(object != NULL);
+    assert(parser != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
     
-    struct CJSON_KV *const entry = CJSON_Object_get_entry(object, parser, key);
+    const unsigned hash = CJSON_hash(key, key_length);
+
+    //a key of the shape is set without making the entries of the object
+    struct CJSON *const shaped_value = CJSON_Object_shape(object) == NULL ? NULL : CJSON_Object_get_hashed(object, key, key_length, hash);
+    if(shaped_value != NULL) {
+        *shaped_value = *value;
+        return true;
+    }
+
+    struct CJSON_KV *const entry = CJSON_Object_get_entry_hashed(object, parser, key, key_length, hash);
     if(entry == NULL) {
         return false;
     }
 
     if(entry->key == NULL || entry->key == DELETED_ENTRY) {
-        entry->key = (char*)CJSON_Arena_strdup(&parser->string_arena, key, NULL);
+        entry->key = CJSON_Symbols_intern(&parser->symbols, key, key_length, hash);
+        if(entry->key == NULL) {
+            entry->key = CJSON_Arena_strndup(&parser->string_arena, key, key_length);
+        }
         if(entry->key == NULL) {
             return false;
         }
@@ -186,12 +760,47 @@ EXTERN_C void CJSON_Object_delete(struct CJSON_Object *const object, const char
     assert(object != NULL);
     assert(key != NULL);
 
-    struct CJSON_KV *const entry = CJSON_Object_find_entry(object, key);
-    if(entry != NULL) {
-        entry->key             = DELETED_ENTRY;
-        entry->value.type      = CJSON_NULL;
-        entry->value.value.null = NULL;
+    CJSON_Object_delete_n(object, key, CJSON_key_length(key));
+}
+
+//the entry stays in the entries with a deleted key so the others keep their order and their index.
+//the value of a shaped object is marked deleted instead, its key is in the shape
+EXTERN_C void CJSON_Object_delete_n(struct CJSON_Object *const object, const char *const key, const unsigned key_length) {
+    assert(object != NULL);
+    assert(key != NULL);
+
+    if(CJSON_Object_shape(object) != NULL) {
+        struct CJSON *const value = CJSON_Object_get_n(object, key, key_length);
+        if(value != NULL) {
+            value->type       = CJSON_NULL;
+            value->value.null = DELETED_ENTRY;
+            object->header->count--;
+        }
+        return;
     }
+
+    const unsigned   slot_count = CJSON_Object_slots(object);
+    struct CJSON_KV *entry;
+    if(slot_count == 0U) {
+        entry = CJSON_Object_scan(object, key, key_length);
+        if(entry == NULL) {
+            return;
+        }
+    } else {
+        const unsigned slot = CJSON_Object_find_slot(object, key, key_length, CJSON_hash(key, key_length));
+        if(slot == slot_count) {
+            return;
+        }
+
+        entry = CJSON_Object_entries(object) + CJSON_Object_get_index(object, slot);
+        CJSON_Object_control(object)[slot] = CJSON_CONTROL_DELETED;
+    }
+    object->header->count--;
+
+    entry->key              = DELETED_ENTRY;
+    entry->key_length       = 0U;
+    entry->value.type       = CJSON_NULL;
+    entry->value.value.null = NULL;
 }
 
 EXTERN_C const char *CJSON_Object_get_string(const struct CJSON_Object *const object, const char *const key, bool *const success) {
@@ -208,6 +817,21 @@ EXTERN_C const char *CJSON_Object_get_string(const struct CJSON_Object *const ob
     return CJSON_as_string(json, success);
 }
 
+EXTERN_C const char *CJSON_Object_get_string_n(const struct CJSON_Object *const object, const char *const key, unsigned *const length, bool *const success) {
+    assert(object != NULL);
+    assert(key != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    struct CJSON *const json = CJSON_Object_get(object, key);
+    if(json == NULL) {
+        *success = false;
+        return NULL;
+    }
+
+    return CJSON_as_string_n(json, length, success);
+}
+
 EXTERN_C double CJSON_Object_get_float64(const struct CJSON_Object *const object, const char *const key, bool *const success) {
     assert(object != NULL);
     assert(key != NULL);
@@ -414,14 +1038,8 @@ EXTERN_C bool CJSON_Object_set_bool(struct CJSON_Object *const object, struct CJ
     return CJSON_Object_set(object, parser, key, &json);
 }
 
-bool CJSON_Object_is_empty(const struct CJSON_Object *const object) {
+EXTERN_C bool CJSON_Object_is_empty(const struct CJSON_Object *const object) {
     assert(object != NULL);
 
-    for(unsigned i = 0U; i < object->capacity; i++) {
-        if(CJSON_KV_is_used(object->entries + i)) {
-            return true;
-        }
-    }
-
-    return false;
+    return CJSON_Object_count(object) == 0U;
 }
@@ -5,26 +5,139 @@ extern "C" {
 #ifndef CJSON_OBJECT_H
 #define CJSON_OBJECT_H
 
-#define CJSON_OBJECT_MINIMUM_CAPACITY 8U
+//the entries of an object that grows from empty
+#define CJSON_OBJECT_MINIMUM_CAPACITY 4U
+#define CJSON_OBJECT_MINIMUM_SLOTS    8U
+//objects with at most this capacity have no slots, their keys are compared one by one without hashing
+#define CJSON_OBJECT_SMALL_CAPACITY   8U
+//the control bytes are probed this many at a time
+#define CJSON_OBJECT_GROUP_SIZE       16U
 
+#include <stdint.h>
+
+struct CJSON;
 struct CJSON_Parser;
 struct CJSON_KV;
+struct CJSON_Shape;
 struct CJSON_Array;
 
+//a key with its length and its hash, made once for a key that is looked up many times
+struct CJSON_Key {
+    const char *chars;
+    unsigned    length;
+    unsigned    hash;
+};
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+
+//the same hash as CJSON_hash, computed by the compiler for a key known at compile time
+constexpr uint64_t CJSON_hash_load(const char *const key, const unsigned count) {
+    return count == 0U ? 0U : (uint64_t)(unsigned char)key[0] | CJSON_hash_load(key + 1, count - 1U) << 8;
+}
+
+constexpr uint64_t CJSON_hash_tail(const char *const key, const unsigned count, const uint64_t tail) {
+    return count == 0U ? tail : CJSON_hash_tail(key + 1, count - 1U, (tail << 8) | (unsigned char)key[0]);
+}
+
+constexpr uint64_t CJSON_hash_mix(const uint64_t hash) {
+    return hash ^ (hash >> 32);
+}
+
+constexpr unsigned CJSON_hash_finish(const uint64_t hash) {
+    return (unsigned)CJSON_hash_mix(hash ^ (hash >> 29));
+}
+
+constexpr unsigned CJSON_hash_words(const char *const key, const unsigned remaining, const uint64_t hash) {
+    return remaining >= 8U
+        ? CJSON_hash_words(key + 8, remaining - 8U, CJSON_hash_mix((hash ^ CJSON_hash_load(key, 8U)) * 0xFF51AFD7ED558CCDULL))
+        : CJSON_hash_finish((hash ^ CJSON_hash_tail(key, remaining, 0U)) * 0xC4CEB9FE1A85EC53ULL);
+}
+
+constexpr struct CJSON_Key CJSON_Key_constexpr(const char *const chars, const unsigned length) {
+    return CJSON_Key{chars, length, CJSON_hash_words(chars, length, 0x9E3779B97F4A7C15ULL ^ length)};
+}
+
+#   define CJSON_KEY(LITERAL) CJSON_Key_constexpr(LITERAL, (unsigned)(sizeof(LITERAL) - 1U))
+#else
+#   define CJSON_KEY(LITERAL) CJSON_Key_make(LITERAL, (unsigned)(sizeof(LITERAL) - 1U))
+#endif
+
+//the front of the one allocation of an object, followed by its entries and by its table.
+//the entries are in insertion order, a deleted one keeps its place with a deleted key until the entries are rebuilt.
+//length is the number of entries used, deleted or not, and count the number of keys.
+//the slots are the hash table of an object bigger than CJSON_OBJECT_SMALL_CAPACITY, slot_count is 0 for a smaller one.
+//slot_count is a power of two, the table starts with the control bytes: control[i] tells if slot i is empty, deleted or used
+//and holds 7 bits of the hash of its key. They are followed by the indexes of the entries of the slots as 8, 16 or 32 bits
+//integers depending on the capacity.
+//a shaped object has no entries and no table, the header is followed by its values in the order of the keys of the shape
+struct CJSON_Object_Header {
+    const struct CJSON_Shape *shape;
+    unsigned                  length,
+                              count,
+                              slot_count;
+};
+
+//header is NULL for an object that has nothing allocated, everything but the capacity is in the header
+//so an object is as small as an array
 struct CJSON_Object {
-    struct CJSON_KV *entries;
-    unsigned         capacity;
+    struct CJSON_Object_Header *header;
+    unsigned                    capacity;
+};
+
+//a member found in an object, a shaped object has no CJSON_KV to point to
+struct CJSON_Entry {
+    const char   *key;
+    unsigned      key_length;
+    struct CJSON *value;
+};
+
+//the keys of objects parsed with the same keys in the same order, shared by all of them and never modified.
+//the values of the keys are not used, the index of a key is the index of its value in a shaped object
+struct CJSON_Shape {
+    struct CJSON_Object keys;
 };
 
+unsigned             CJSON_hash              (const char *key, unsigned key_length);
+//the key is not copied, chars must outlive the returned key
+struct CJSON_Key     CJSON_Key_make          (const char *chars, unsigned length);
+//the slots of an object with this capacity, they are never more than 7/8 used
+unsigned             CJSON_Object_slot_count (unsigned capacity);
+//the bytes of the header, the control bytes and the indexes of an object with this capacity, its entries excluded
+unsigned             CJSON_Object_table_size (unsigned capacity);
 bool                 CJSON_KV_is_used        (const struct CJSON_KV *entry);
 void                 CJSON_Object_init       (struct CJSON_Object*);
-bool                 CJSON_Object_reserve    (struct CJSON_Object*, struct CJSON_Parser*, unsigned capacity);
-struct CJSON_KV     *CJSON_Object_get_entry  (struct CJSON_Object*, struct CJSON_Parser*, const char *key);
-struct CJSON_KV     *CJSON_Object_find_entry (const struct CJSON_Object*, const char *key);
+//the number of entries, deleted or not, CJSON_Object_key_at and CJSON_Object_value_at take an index less than it
+unsigned             CJSON_Object_length     (const struct CJSON_Object*);
+//the number of keys
+unsigned             CJSON_Object_count      (const struct CJSON_Object*);
+bool                 CJSON_Object_reserve    (struct CJSON_Object*, struct CJSON_Parser*, unsigned count);
+struct CJSON_KV     *CJSON_Object_get_entry  (struct CJSON_Object*, struct CJSON_Parser*, const char *key, unsigned key_length);
+struct CJSON_KV     *CJSON_Object_get_entry_hashed(struct CJSON_Object*, struct CJSON_Parser*, const char *key, unsigned key_length, unsigned hash);
+//the key and the value of a member, value points in the object
+bool                 CJSON_Object_find_entry (const struct CJSON_Object*, const char *key, unsigned key_length, struct CJSON_Entry *entry);
+//an object being parsed with count members, it shares the shape of the parser if the shape has count keys
+//and its first key is the first key of the shape. Nothing is allocated for a shaped object until that key is added
+bool                 CJSON_Object_start      (struct CJSON_Object*, struct CJSON_Parser*, unsigned count);
+//the value of the next member of an object being parsed with the key set, a key that doesn't follow the shape
+//gives the object its own entries
+struct CJSON        *CJSON_Object_add        (struct CJSON_Object*, struct CJSON_Parser*, const char *key, unsigned key_length, unsigned hash);
+//an object is parsed, its keys become the shape of the parser if the last object parsed had the same ones
+void                 CJSON_Object_finish     (struct CJSON_Object*, struct CJSON_Parser*);
+//the key of the entry at the index, NULL if it was deleted. index is less than length
+const char          *CJSON_Object_key_at     (const struct CJSON_Object*, unsigned index, unsigned *key_length);
+struct CJSON        *CJSON_Object_value_at   (const struct CJSON_Object*, unsigned index);
 struct CJSON        *CJSON_Object_get        (const struct CJSON_Object*, const char *key);
+//the _n variants take the length of the key, it can contain NUL characters
+struct CJSON        *CJSON_Object_get_n      (const struct CJSON_Object*, const char *key, unsigned key_length);
+//hash must be CJSON_hash(key, key_length), it can be computed once for a key looked up in many objects
+struct CJSON        *CJSON_Object_get_hashed (const struct CJSON_Object*, const char *key, unsigned key_length, unsigned hash);
+struct CJSON        *CJSON_Object_get_key    (const struct CJSON_Object*, const struct CJSON_Key*);
 bool                 CJSON_Object_set        (struct CJSON_Object*, struct CJSON_Parser*, const char *key, const struct CJSON*);
+bool                 CJSON_Object_set_n      (struct CJSON_Object*, struct CJSON_Parser*, const char *key, unsigned key_length, const struct CJSON*);
 void                 CJSON_Object_delete     (struct CJSON_Object*, const char *key);
+void                 CJSON_Object_delete_n   (struct CJSON_Object*, const char *key, unsigned key_length);
 const char          *CJSON_Object_get_string (const struct CJSON_Object*, const char *key, bool *success);
+const char          *CJSON_Object_get_string_n(const struct CJSON_Object*, const char *key, unsigned *length, bool *success);
 double               CJSON_Object_get_float64(const struct CJSON_Object*, const char *key, bool *success);
 int64_t              CJSON_Object_get_int64  (const struct CJSON_Object*, const char *key, bool *success);
 uint64_t             CJSON_Object_get_uint64 (const struct CJSON_Object*, const char *key, bool *success);
@@ -0,0 +1,563 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "ondemand.h"
+#include "lexer.h"
+#include "decoder.h"
+#include "number.h"
+#include "allocator.h"
+#include "util.h"
+
+static bool CJSON_Doc_fail(struct CJSON_Doc *const doc, const enum CJSON_Error error) {
+    assert(doc != NULL);
+
+    doc->error = error;
+    return false;
+}
+
+static bool CJSON_Token_is_value(const struct CJSON_Token *const token) {
+    assert(token != NULL);
+
+    switch(token->type) {
+    case CJSON_TOKEN_LCURLY:
+    case CJSON_TOKEN_LBRACKET:
+    case CJSON_TOKEN_STRING:
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT:
+    case CJSON_TOKEN_BOOL:
+    case CJSON_TOKEN_NULL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void CJSON_Doc_lexer(const struct CJSON_Doc *const doc, struct CJSON_Lexer *const lexer, const unsigned position) {
+    assert(doc != NULL);
+    assert(lexer != NULL);
+
+    CJSON_Lexer_init(lexer, doc->data, doc->length);
+    lexer->position = position;
+}
+
+//finds where the value starting with token ends. Containers are skipped by matching brackets,
+//their content is not validated
+static bool CJSON_Doc_skip(struct CJSON_Doc *const doc, const struct CJSON_Token *const token, unsigned *const end) {
+    assert(doc != NULL);
+    assert(token != NULL);
+    assert(end != NULL);
+
+    unsigned position = token->offset + CJSON_Token_length(token, doc->data);
+    if(token->type != CJSON_TOKEN_LCURLY && token->type != CJSON_TOKEN_LBRACKET) {
+        *end = position;
+        return true;
+    }
+
+    const char *const data  = doc->data;
+    unsigned          depth = 1U;
+    while(position < doc->length) {
+        switch(data[position++]) {
+        case '"':
+            while(position < doc->length && data[position] != '"') {
+                position += data[position] == '\\' ? 2U : 1U;
+            }
+            position++;
+            break;
+
+        case '{':
+        case '[':
+            depth++;
+            break;
+
+        case '}':
+        case ']':
+            if(--depth == 0U) {
+                *end = position;
+                return true;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return CJSON_Doc_fail(doc, token->type == CJSON_TOKEN_LCURLY ? CJSON_ERROR_OBJECT : CJSON_ERROR_ARRAY);
+}
+
+static bool CJSON_Cursor_key_equals(const struct CJSON_Doc *const doc, const struct CJSON_Token *const token, const char *const key, const unsigned key_length) {
+    assert(doc != NULL);
+    assert(token != NULL);
+    assert(token->length >= 2U);
+    assert(key != NULL);
+
+    const char *const chars  = doc->data + token->offset + 1;
+    const unsigned    length = CJSON_Token_length(token, doc->data) - 2U;
+
+    if(CJSON_is_raw_string(chars, length)) {
+        return length == key_length && memcmp(chars, key, (size_t)length) == 0;
+    }
+
+    //an escaped key is never shorter once decoded
+    if(length < key_length) {
+        return false;
+    }
+
+    char *const decoded = (char*)CJSON_MALLOC((size_t)length);
+    if(decoded == NULL) {
+        return false;
+    }
+
+    unsigned decoded_length;
+    const bool is_equal = CJSON_unescape(decoded, chars, length, &decoded_length) 
+        && decoded_length == key_length 
+        && memcmp(decoded, key, (size_t)key_length) == 0;
+    CJSON_FREE(decoded);
+
+    return is_equal;
+}
+
+static bool CJSON_Cursor_decode_number(const struct CJSON_Cursor *const cursor, struct CJSON *const json) {
+    assert(cursor != NULL);
+    assert(json != NULL);
+
+    switch(cursor->token.type) {
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT:
+        return CJSON_Number_decode(cursor->doc->data + cursor->token.offset, cursor->token.length, json) == CJSON_ERROR_NONE;
+    default:
+        return false;
+    }
+}
+
+EXTERN_C void CJSON_Doc_init(struct CJSON_Doc *const doc, const char *const data, const unsigned length) {
+    assert(doc != NULL);
+    assert(data != NULL);
+
+    doc->data   = data;
+    doc->length = length;
+    doc->error  = CJSON_ERROR_NONE;
+}
+
+EXTERN_C bool CJSON_Doc_root(struct CJSON_Doc *const doc, struct CJSON_Cursor *const cursor) {
+    assert(doc != NULL);
+    assert(cursor != NULL);
+
+    if(doc->length == 0U) {
+        return CJSON_Doc_fail(doc, CJSON_ERROR_TOKEN);
+    }
+
+    struct CJSON_Lexer lexer;
+    CJSON_Doc_lexer(doc, &lexer, 0U);
+    if(CJSON_Lexer_next(&lexer, &cursor->token) != CJSON_LEXER_ERROR_NONE || !CJSON_Token_is_value(&cursor->token)) {
+        return CJSON_Doc_fail(doc, CJSON_ERROR_TOKEN);
+    }
+    cursor->doc = doc;
+
+    return true;
+}
+
+EXTERN_C enum CJSON_Type CJSON_Cursor_type(const struct CJSON_Cursor *const cursor) {
+    assert(cursor != NULL);
+
+    switch(cursor->token.type) {
+    case CJSON_TOKEN_LCURLY:
+        return CJSON_OBJECT;
+    case CJSON_TOKEN_LBRACKET:
+        return CJSON_ARRAY;
+    case CJSON_TOKEN_STRING:
+        return CJSON_STRING;
+    case CJSON_TOKEN_BOOL:
+        return CJSON_BOOL;
+    case CJSON_TOKEN_NULL:
+        return CJSON_NULL;
+    default:
+        assert(CJSON_Token_is_value(&cursor->token));
+        return CJSON_NUMBER;
+    }
+}
+
+EXTERN_C bool CJSON_Cursor_find_field(const struct CJSON_Cursor *const object, const char *const key, const unsigned key_length, struct CJSON_Cursor *const value) {
+    assert(object != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+
+    if(object->token.type != CJSON_TOKEN_LCURLY) {
+        return false;
+    }
+
+    struct CJSON_Doc *const doc = object->doc;
+    struct CJSON_Lexer      lexer;
+    struct CJSON_Token      key_token, value_token, token;
+
+    CJSON_Doc_lexer(doc, &lexer, object->token.offset + 1U);
+    if(CJSON_Lexer_next(&lexer, &key_token) != CJSON_LEXER_ERROR_NONE) {
+        return CJSON_Doc_fail(doc, CJSON_ERROR_OBJECT);
+    }
+    if(key_token.type == CJSON_TOKEN_RCURLY) {
+        return false;
+    }
+
+    while(true) {
+        if(key_token.type != CJSON_TOKEN_STRING) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_OBJECT_KEY);
+        }
+        if(CJSON_Lexer_next(&lexer, &token) != CJSON_LEXER_ERROR_NONE || token.type != CJSON_TOKEN_COLON) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_MISSING_COLON);
+        }
+        if(CJSON_Lexer_next(&lexer, &value_token) != CJSON_LEXER_ERROR_NONE || !CJSON_Token_is_value(&value_token)) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_OBJECT_VALUE);
+        }
+
+        if(CJSON_Cursor_key_equals(doc, &key_token, key, key_length)) {
+            value->doc   = doc;
+            value->token = value_token;
+            return true;
+        }
+
+        if(!CJSON_Doc_skip(doc, &value_token, &lexer.position)) {
+            return false;
+        }
+        if(CJSON_Lexer_next(&lexer, &token) != CJSON_LEXER_ERROR_NONE) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_OBJECT);
+        }
+        if(token.type == CJSON_TOKEN_RCURLY) {
+            return false;
+        }
+        if(token.type != CJSON_TOKEN_COMMA) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_MISSING_COMMA_OR_RCURLY);
+        }
+        if(CJSON_Lexer_next(&lexer, &key_token) != CJSON_LEXER_ERROR_NONE) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_OBJECT_KEY);
+        }
+    }
+}
+
+EXTERN_C bool CJSON_Cursor_at(const struct CJSON_Cursor *const array, unsigned index, struct CJSON_Cursor *const value) {
+    assert(array != NULL);
+    assert(value != NULL);
+
+    struct CJSON_ArrayIter iter;
+    if(!CJSON_Cursor_array_iter(array, &iter)) {
+        return false;
+    }
+
+    struct CJSON_Cursor element;
+    while(CJSON_ArrayIter_next(&iter, &element)) {
+        if(index-- == 0U) {
+            *value = element;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+EXTERN_C bool CJSON_Cursor_get(const struct CJSON_Cursor *const cursor, const char *query, struct CJSON_Cursor *const value) {
+    assert(cursor != NULL);
+    assert(query != NULL);
+    assert(value != NULL);
+
+    if(cursor->token.type != CJSON_TOKEN_LCURLY && cursor->token.type != CJSON_TOKEN_LBRACKET) {
+        return false;
+    }
+
+    if(*query == '\0' || strlen(query) > (size_t)UINT_MAX) {
+        return false;
+    }
+
+    bool is_object_key = *query != '[';
+    if(*query == '.' || *query == '[') {
+        query++;
+    }
+
+    struct CJSON_Cursor current = *cursor;
+    while(true) {
+        if(is_object_key && current.token.type == CJSON_TOKEN_LCURLY) {
+            const char *const key = query;
+            while(*query != '.' && *query != '[' && *query != '\0') {
+                query++;
+            }
+
+            const struct CJSON_Cursor object = current;
+            if(!CJSON_Cursor_find_field(&object, key, (unsigned)(query - key), &current)) {
+                return false;
+            }
+        } else if(!is_object_key && current.token.type == CJSON_TOKEN_LBRACKET) {
+            const char *const digits = query;
+            unsigned index = 0U;
+            while(*query != ']' && *query != '\0') {
+                if(*query < '0' || *query > '9') {
+                    return false;
+                }
+
+                const unsigned digit = (unsigned)(*query - '0');
+                if(index > (UINT_MAX - digit) / 10U) {
+                    return false;
+                }
+                index = index * 10U + digit;
+                query++;
+            }
+
+            if(*query != ']' || query == digits) {
+                return false;
+            }
+
+            const struct CJSON_Cursor array = current;
+            if(!CJSON_Cursor_at(&array, index, &current)) {
+                return false;
+            }
+            query++;
+        } else {
+            return false;
+        }
+
+        if(*query == '\0') {
+            break;
+        }
+
+        is_object_key = *query != '[';
+        query++;
+    }
+
+    *value = current;
+    return true;
+}
+
+EXTERN_C bool CJSON_Cursor_array_iter(const struct CJSON_Cursor *const array, struct CJSON_ArrayIter *const iter) {
+    assert(array != NULL);
+    assert(iter != NULL);
+
+    if(array->token.type != CJSON_TOKEN_LBRACKET) {
+        return false;
+    }
+
+    iter->doc      = array->doc;
+    iter->previous = array->token;
+    iter->position = array->token.offset + 1U;
+    iter->is_first = true;
+    iter->is_done  = false;
+
+    return true;
+}
+
+EXTERN_C bool CJSON_ArrayIter_next(struct CJSON_ArrayIter *const iter, struct CJSON_Cursor *const value) {
+    assert(iter != NULL);
+    assert(value != NULL);
+
+    if(iter->is_done) {
+        return false;
+    }
+
+    struct CJSON_Doc *const doc = iter->doc;
+    struct CJSON_Lexer      lexer;
+    struct CJSON_Token      token;
+
+    //the iteration stops for good on the closing bracket or an error
+    iter->is_done = true;
+
+    if(iter->is_first) {
+        CJSON_Doc_lexer(doc, &lexer, iter->position);
+        if(CJSON_Lexer_next(&lexer, &token) != CJSON_LEXER_ERROR_NONE) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_ARRAY);
+        }
+        if(token.type == CJSON_TOKEN_RBRACKET) {
+            return false;
+        }
+    } else {
+        CJSON_Doc_lexer(doc, &lexer, 0U);
+        if(!CJSON_Doc_skip(doc, &iter->previous, &lexer.position)) {
+            return false;
+        }
+        if(CJSON_Lexer_next(&lexer, &token) != CJSON_LEXER_ERROR_NONE) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_ARRAY);
+        }
+        if(token.type == CJSON_TOKEN_RBRACKET) {
+            return false;
+        }
+        if(token.type != CJSON_TOKEN_COMMA) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_MISSING_COMMA_OR_RBRACKET);
+        }
+        if(CJSON_Lexer_next(&lexer, &token) != CJSON_LEXER_ERROR_NONE) {
+            return CJSON_Doc_fail(doc, CJSON_ERROR_ARRAY_VALUE);
+        }
+    }
+
+    if(!CJSON_Token_is_value(&token)) {
+        return CJSON_Doc_fail(doc, CJSON_ERROR_ARRAY_VALUE);
+    }
+
+    iter->previous = token;
+    iter->position = lexer.position;
+    iter->is_first = false;
+    iter->is_done  = false;
+
+    value->doc   = doc;
+    value->token = token;
+
+    return true;
+}
+
+EXTERN_C const char *CJSON_Cursor_as_raw_string(const struct CJSON_Cursor *const cursor, unsigned *const length, bool *const success) {
+    assert(cursor != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    if(cursor->token.type != CJSON_TOKEN_STRING) {
+        *success = false;
+        return NULL;
+    }
+
+    *success = true;
+    *length  = CJSON_Token_length(&cursor->token, cursor->doc->data) - 2U;
+    return cursor->doc->data + cursor->token.offset + 1;
+}
+
+EXTERN_C bool CJSON_Cursor_decode_string(const struct CJSON_Cursor *const cursor, char *const destination, unsigned *const length) {
+    assert(cursor != NULL);
+    assert(destination != NULL);
+    assert(length != NULL);
+
+    bool success;
+    unsigned raw_length;
+    const char *const raw = CJSON_Cursor_as_raw_string(cursor, &raw_length, &success);
+    if(!success || !CJSON_unescape(destination, raw, raw_length, length)) {
+        return false;
+    }
+
+    destination[*length] = '\0';
+    return true;
+}
+
+EXTERN_C double CJSON_Cursor_as_float64(const struct CJSON_Cursor *const cursor, bool *const success) {
+    assert(cursor != NULL);
+    assert(success != NULL);
+
+    struct CJSON json;
+    if(!CJSON_Cursor_decode_number(cursor, &json)) {
+        *success = false;
+        return 0.0;
+    }
+
+    return CJSON_as_float64(&json, success);
+}
+
+EXTERN_C int64_t CJSON_Cursor_as_int64(const struct CJSON_Cursor *const cursor, bool *const success) {
+    assert(cursor != NULL);
+    assert(success != NULL);
+
+    struct CJSON json;
+    if(!CJSON_Cursor_decode_number(cursor, &json)) {
+        *success = false;
+        return 0;
+    }
+
+    return CJSON_as_int64(&json, success);
+}
+
+EXTERN_C uint64_t CJSON_Cursor_as_uint64(const struct CJSON_Cursor *const cursor, bool *const success) {
+    assert(cursor != NULL);
+    assert(success != NULL);
+
+    struct CJSON json;
+    if(!CJSON_Cursor_decode_number(cursor, &json)) {
+        *success = false;
+        return 0U;
+    }
+
+    return CJSON_as_uint64(&json, success);
+}
+
+EXTERN_C bool CJSON_Cursor_as_bool(const struct CJSON_Cursor *const cursor, bool *const success) {
+    assert(cursor != NULL);
+    assert(success != NULL);
+
+    if(cursor->token.type != CJSON_TOKEN_BOOL) {
+        *success = false;
+        return false;
+    }
+
+    *success = true;
+    return cursor->doc->data[cursor->token.offset] == 't';
+}
+
+EXTERN_C bool CJSON_Cursor_is_null(const struct CJSON_Cursor *const cursor) {
+    assert(cursor != NULL);
+
+    return cursor->token.type == CJSON_TOKEN_NULL;
+}
+
+EXTERN_C const char *CJSON_Cursor_get_raw_string(const struct CJSON_Cursor *const cursor, const char *const query, unsigned *const length, bool *const success) {
+    assert(cursor != NULL);
+    assert(query != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    struct CJSON_Cursor value;
+    if(!CJSON_Cursor_get(cursor, query, &value)) {
+        *success = false;
+        return NULL;
+    }
+
+    return CJSON_Cursor_as_raw_string(&value, length, success);
+}
+
+EXTERN_C double CJSON_Cursor_get_float64(const struct CJSON_Cursor *const cursor, const char *const query, bool *const success) {
+    assert(cursor != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_Cursor value;
+    if(!CJSON_Cursor_get(cursor, query, &value)) {
+        *success = false;
+        return 0.0;
+    }
+
+    return CJSON_Cursor_as_float64(&value, success);
+}
+
+EXTERN_C int64_t CJSON_Cursor_get_int64(const struct CJSON_Cursor *const cursor, const char *const query, bool *const success) {
+    assert(cursor != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_Cursor value;
+    if(!CJSON_Cursor_get(cursor, query, &value)) {
+        *success = false;
+        return 0;
+    }
+
+    return CJSON_Cursor_as_int64(&value, success);
+}
+
+EXTERN_C uint64_t CJSON_Cursor_get_uint64(const struct CJSON_Cursor *const cursor, const char *const query, bool *const success) {
+    assert(cursor != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_Cursor value;
+    if(!CJSON_Cursor_get(cursor, query, &value)) {
+        *success = false;
+        return 0U;
+    }
+
+    return CJSON_Cursor_as_uint64(&value, success);
+}
+
+EXTERN_C bool CJSON_Cursor_get_bool(const struct CJSON_Cursor *const cursor, const char *const query, bool *const success) {
+    assert(cursor != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_Cursor value;
+    if(!CJSON_Cursor_get(cursor, query, &value)) {
+        *success = false;
+        return false;
+    }
+
+    return CJSON_Cursor_as_bool(&value, success);
+}
@@ -0,0 +1,61 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_ONDEMAND_H
+#define CJSON_ONDEMAND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "json.h"
+#include "token.h"
+
+//JSON read in place without building a DOM, only the parts that are navigated to are read and validated
+struct CJSON_Doc {
+    const char      *data;
+    unsigned         length;
+    enum CJSON_Error error;
+};
+
+//a value inside a CJSON_Doc, token is its first token ('{' or '[' for containers)
+struct CJSON_Cursor {
+    struct CJSON_Doc  *doc;
+    struct CJSON_Token token;
+};
+
+struct CJSON_ArrayIter {
+    struct CJSON_Doc  *doc;
+    struct CJSON_Token previous; //the value returned by the last call to CJSON_ArrayIter_next, skipped by the next one
+    unsigned           position;
+    bool               is_first,
+                       is_done;
+};
+
+void            CJSON_Doc_init            (struct CJSON_Doc*, const char *data, unsigned length);
+//the first token of the input, what follows the root value is not read so trailing content like the 2 of "[1] 2"
+//is not an error, unlike with CJSON_parse
+bool            CJSON_Doc_root            (struct CJSON_Doc*, struct CJSON_Cursor*);
+enum CJSON_Type CJSON_Cursor_type         (const struct CJSON_Cursor*);
+bool            CJSON_Cursor_find_field   (const struct CJSON_Cursor*, const char *key, unsigned key_length, struct CJSON_Cursor *value);
+bool            CJSON_Cursor_at           (const struct CJSON_Cursor*, unsigned index, struct CJSON_Cursor *value);
+bool            CJSON_Cursor_get          (const struct CJSON_Cursor*, const char *query, struct CJSON_Cursor *value);
+bool            CJSON_Cursor_array_iter   (const struct CJSON_Cursor*, struct CJSON_ArrayIter*);
+bool            CJSON_ArrayIter_next      (struct CJSON_ArrayIter*, struct CJSON_Cursor *value);
+const char     *CJSON_Cursor_as_raw_string(const struct CJSON_Cursor*, unsigned *length, bool *success);
+bool            CJSON_Cursor_decode_string(const struct CJSON_Cursor*, char *destination, unsigned *length);
+double          CJSON_Cursor_as_float64   (const struct CJSON_Cursor*, bool *success);
+int64_t         CJSON_Cursor_as_int64     (const struct CJSON_Cursor*, bool *success);
+uint64_t        CJSON_Cursor_as_uint64    (const struct CJSON_Cursor*, bool *success);
+bool            CJSON_Cursor_as_bool      (const struct CJSON_Cursor*, bool *success);
+bool            CJSON_Cursor_is_null      (const struct CJSON_Cursor*);
+const char     *CJSON_Cursor_get_raw_string(const struct CJSON_Cursor*, const char *query, unsigned *length, bool *success);
+double          CJSON_Cursor_get_float64  (const struct CJSON_Cursor*, const char *query, bool *success);
+int64_t         CJSON_Cursor_get_int64    (const struct CJSON_Cursor*, const char *query, bool *success);
+uint64_t        CJSON_Cursor_get_uint64   (const struct CJSON_Cursor*, const char *query, bool *success);
+bool            CJSON_Cursor_get_bool     (const struct CJSON_Cursor*, const char *query, bool *success);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1014 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "parallel.h"
+#include "parser.h"
+#include "builder.h"
+#include "lexer.h"
+#include "stack.h"
+#include "thread.h"
+#include "allocator.h"
+#include "util.h"
+
+struct CJSON_Parallel;
+
+//a record kept until its chunk can be given in the order of the input
+struct CJSON_Parallel_Record {
+    struct CJSON    *json;
+    unsigned         offset;
+    enum CJSON_Error error;
+};
+
+struct CJSON_Parallel_Worker {
+    struct CJSON_Parallel        *parallel;
+    struct CJSON_Thread           thread;
+    struct CJSON_Mutex            mutex;       //guards first and count, other workers steal from them
+    unsigned                      index,
+                                  first,       //the chunks of the worker are first, first + stride, ...
+                                  count;
+    struct CJSON_Parser           parser;
+    struct CJSON_Tokens           tokens;
+    struct CJSON_Builder          builder;
+    struct CJSON_Parallel_Record *records;
+    unsigned                      record_count,
+                                  record_capacity;
+    bool                          is_started;
+};
+
+struct CJSON_Parallel {
+    const char                   *data;
+    unsigned                      length,
+                                  chunk_count,
+                                  worker_count,
+                                  stride;      //the number of workers that got chunks
+    enum CJSON_Parallel_Order     order;
+    bool                        (*callback)(void*, struct CJSON_Parser*, struct CJSON*, unsigned);
+    void                         *context;
+    struct CJSON_Parallel_Worker *workers;
+    struct CJSON_Mutex            mutex;       //guards the fields below
+    struct CJSON_Condition        condition;
+    unsigned                      next_chunk;  //the next chunk to give in the order of the input
+    bool                          is_dealt,
+                                  is_stopped;
+    enum CJSON_Error              error;
+};
+
+static void CJSON_Parallel_stop(struct CJSON_Parallel *const parallel, const enum CJSON_Error error) {
+    assert(parallel != NULL);
+
+    CJSON_Mutex_lock(&parallel->mutex);
+    if(!parallel->is_stopped) {
+        parallel->is_stopped = true;
+        parallel->error      = error;
+    }
+    CJSON_Condition_broadcast(&parallel->condition);
+    CJSON_Mutex_unlock(&parallel->mutex);
+}
+
+static bool CJSON_Parallel_is_stopped(struct CJSON_Parallel *const parallel) {
+    assert(parallel != NULL);
+
+    CJSON_Mutex_lock(&parallel->mutex);
+    const bool is_stopped = parallel->is_stopped;
+    CJSON_Mutex_unlock(&parallel->mutex);
+
+    return is_stopped;
+}
+
+//the chunks start after the first newline at or after a multiple of the chunk size,
+//a chunk inside a record longer than the chunk size is empty
+static unsigned CJSON_Parallel_chunk_start(const struct CJSON_Parallel *const parallel, const unsigned chunk) {
+    assert(parallel != NULL);
+
+    if(chunk == 0U) {
+        return 0U;
+    }
+    if(chunk >= parallel->chunk_count) {
+        return parallel->length;
+    }
+
+    const unsigned    position = chunk * CJSON_PARALLEL_CHUNK_SIZE - 1U;
+    const char *const newline  = (const char*)memchr(parallel->data + position, '\n', (size_t)(parallel->length - position));
+
+    return newline == NULL ? parallel->length : (unsigned)(newline - parallel->data) + 1U;
+}
+
+//the worker takes its own chunks from the front and steals from the back of the others,
+//a chunk is never taken before a smaller chunk of the same worker so the input order can't deadlock
+static bool CJSON_Parallel_take(struct CJSON_Parallel_Worker *const worker, unsigned *const chunk) {
+    assert(worker != NULL);
+    assert(chunk != NULL);
+
+    struct CJSON_Parallel *const parallel = worker->parallel;
+    const unsigned worker_count = parallel->worker_count;
+
+    CJSON_Mutex_lock(&worker->mutex);
+    if(worker->count > 0U) {
+        *chunk = worker->first;
+        worker->first += parallel->stride;
+        worker->count--;
+        CJSON_Mutex_unlock(&worker->mutex);
+        return true;
+    }
+    CJSON_Mutex_unlock(&worker->mutex);
+
+    for(unsigned i = 1U; i < worker_count; i++) {
+        struct CJSON_Parallel_Worker *const victim = parallel->workers + (worker->index + i) % worker_count;
+
+        CJSON_Mutex_lock(&victim->mutex);
+        if(victim->count > 0U) {
+            victim->count--;
+            *chunk = victim->first + victim->count * parallel->stride;
+            CJSON_Mutex_unlock(&victim->mutex);
+            return true;
+        }
+        CJSON_Mutex_unlock(&victim->mutex);
+    }
+
+    return false;
+}
+
+static bool CJSON_Parallel_push_record(struct CJSON_Parallel_Worker *const worker, struct CJSON *const json, const unsigned offset) {
+    assert(worker != NULL);
+
+    if(worker->record_count == worker->record_capacity) {
+        bool success;
+        unsigned capacity = CJSON_safe_unsigned_mult(worker->record_capacity, 2U, &success);
+        if(!success) {
+            return false;
+        }
+        if(capacity == 0U) {
+            capacity = 64U;
+        }
+
+        struct CJSON_Parallel_Record *const records = (struct CJSON_Parallel_Record*)CJSON_REALLOC(worker->records, (size_t)capacity * sizeof(*records));
+        if(records == NULL) {
+            return false;
+        }
+
+        worker->records         = records;
+        worker->record_capacity = capacity;
+    }
+
+    struct CJSON_Parallel_Record *const record = worker->records + worker->record_count;
+    record->json   = json;
+    record->offset = offset;
+    record->error  = worker->parser.error;
+    worker->record_count++;
+
+    return true;
+}
+
+//waits for the chunks before this one to be given
+static void CJSON_Parallel_give_records(struct CJSON_Parallel_Worker *const worker, const unsigned chunk) {
+    assert(worker != NULL);
+
+    struct CJSON_Parallel *const parallel = worker->parallel;
+
+    CJSON_Mutex_lock(&parallel->mutex);
+    while(parallel->next_chunk != chunk && !parallel->is_stopped) {
+        CJSON_Condition_wait(&parallel->condition, &parallel->mutex);
+    }
+    const bool is_stopped = parallel->is_stopped;
+    CJSON_Mutex_unlock(&parallel->mutex);
+
+    if(is_stopped) {
+        return;
+    }
+
+    for(unsigned i = 0U; i < worker->record_count; i++) {
+        const struct CJSON_Parallel_Record *const record = worker->records + i;
+
+        worker->parser.error = record->error;
+        if(!parallel->callback(parallel->context, &worker->parser, record->json, record->offset)) {
+            CJSON_Parallel_stop(parallel, CJSON_ERROR_HANDLER);
+            return;
+        }
+    }
+
+    CJSON_Mutex_lock(&parallel->mutex);
+    parallel->next_chunk++;
+    CJSON_Condition_broadcast(&parallel->condition);
+    CJSON_Mutex_unlock(&parallel->mutex);
+}
+
+//in the input order all the records of the chunk are kept in the arenas until they are given,
+//otherwise the arenas are reset for every record
+static void CJSON_Parallel_parse_chunk(struct CJSON_Parallel_Worker *const worker, const unsigned chunk) {
+    assert(worker != NULL);
+
+    struct CJSON_Parallel *const parallel   = worker->parallel;
+    const char *const            data       = parallel->data;
+    const bool                   is_ordered = parallel->order == CJSON_PARALLEL_ORDER_INPUT;
+    const unsigned               end        = CJSON_Parallel_chunk_start(parallel, chunk + 1U);
+    unsigned                     position   = CJSON_Parallel_chunk_start(parallel, chunk);
+
+    worker->record_count = 0U;
+    if(is_ordered) {
+        CJSON_Parser_reset(&worker->parser);
+    }
+
+    while(position < end) {
+        const char *const newline    = (const char*)memchr(data + position, '\n', (size_t)(end - position));
+        const unsigned    record_end = newline == NULL ? end : (unsigned)(newline - data);
+        const unsigned    offset     = position;
+
+        position = newline == NULL ? end : record_end + 1U;
+
+        if(CJSON_is_blank(data + offset, record_end - offset)) {
+            continue;
+        }
+
+        if(!is_ordered) {
+            CJSON_Parser_reset(&worker->parser);
+        }
+        struct CJSON *const json = CJSON_parse_record(&worker->parser, &worker->tokens, &worker->builder, data + offset, record_end - offset);
+
+        if(is_ordered) {
+            if(!CJSON_Parallel_push_record(worker, json, offset)) {
+                CJSON_Parallel_stop(parallel, CJSON_ERROR_MEMORY);
+                return;
+            }
+        } else if(!parallel->callback(parallel->context, &worker->parser, json, offset)) {
+            CJSON_Parallel_stop(parallel, CJSON_ERROR_HANDLER);
+            return;
+        }
+    }
+
+    if(is_ordered) {
+        CJSON_Parallel_give_records(worker, chunk);
+    }
+}
+
+static void CJSON_Parallel_run(void *const argument) {
+    struct CJSON_Parallel_Worker *const worker   = (struct CJSON_Parallel_Worker*)argument;
+    struct CJSON_Parallel *const        parallel = worker->parallel;
+
+    CJSON_Mutex_lock(&parallel->mutex);
+    while(!parallel->is_dealt) {
+        CJSON_Condition_wait(&parallel->condition, &parallel->mutex);
+    }
+    CJSON_Mutex_unlock(&parallel->mutex);
+
+    unsigned chunk;
+    while(!CJSON_Parallel_is_stopped(worker->parallel) && CJSON_Parallel_take(worker, &chunk)) {
+        CJSON_Parallel_parse_chunk(worker, chunk);
+    }
+}
+
+EXTERN_C enum CJSON_Error CJSON_parse_many_parallel(
+    const char *const data,
+    const unsigned length,
+    const unsigned options,
+    unsigned thread_count,
+    const enum CJSON_Parallel_Order order,
+    bool (*const callback)(void *context, struct CJSON_Parser*, struct CJSON *json, unsigned offset),
+    void *const context
+) {
+    assert(data != NULL);
+    assert(callback != NULL);
+
+    if(length == 0U) {
+        return CJSON_ERROR_NONE;
+    }
+
+    if(thread_count == 0U) {
+        thread_count = CJSON_Thread_count();
+    }
+
+    struct CJSON_Parallel parallel;
+    parallel.data         = data;
+    parallel.length       = length;
+    parallel.chunk_count  = length / CJSON_PARALLEL_CHUNK_SIZE + (length % CJSON_PARALLEL_CHUNK_SIZE != 0U ? 1U : 0U);
+    parallel.worker_count = MIN(thread_count, parallel.chunk_count);
+    parallel.order        = order;
+    parallel.callback     = callback;
+    parallel.context      = context;
+    parallel.stride       = 0U;
+    parallel.next_chunk   = 0U;
+    parallel.is_dealt     = false;
+    parallel.is_stopped   = false;
+    parallel.error        = CJSON_ERROR_NONE;
+
+    parallel.workers = (struct CJSON_Parallel_Worker*)CJSON_MALLOC((size_t)parallel.worker_count * sizeof(*parallel.workers));
+    if(parallel.workers == NULL) {
+        return CJSON_ERROR_MEMORY;
+    }
+
+    if(!CJSON_Mutex_init(&parallel.mutex)) {
+        CJSON_FREE(parallel.workers);
+        return CJSON_ERROR_MEMORY;
+    }
+    if(!CJSON_Condition_init(&parallel.condition)) {
+        CJSON_Mutex_free(&parallel.mutex);
+        CJSON_FREE(parallel.workers);
+        return CJSON_ERROR_MEMORY;
+    }
+
+    unsigned worker_count = 0U;
+    for(; worker_count < parallel.worker_count; worker_count++) {
+        struct CJSON_Parallel_Worker *const worker = parallel.workers + worker_count;
+        if(!CJSON_Mutex_init(&worker->mutex)) {
+            break;
+        }
+
+        worker->parallel        = &parallel;
+        worker->index           = worker_count;
+        worker->first           = 0U;
+        worker->count           = 0U;
+        worker->records         = NULL;
+        worker->record_count    = 0U;
+        worker->record_capacity = 0U;
+        worker->is_started      = false;
+        CJSON_Parser_init(&worker->parser);
+        worker->parser.options  = options;
+        CJSON_Tokens_init(&worker->tokens);
+        CJSON_Builder_init(&worker->builder);
+    }
+
+    if(worker_count < parallel.worker_count) {
+        parallel.error = CJSON_ERROR_MEMORY;
+    } else {
+        //the calling thread is the first worker, the others wait for the chunks to be dealt
+        parallel.workers[0].is_started = true;
+        for(unsigned i = 1U; i < worker_count; i++) {
+            struct CJSON_Parallel_Worker *const worker = parallel.workers + i;
+            worker->is_started = CJSON_Thread_create(&worker->thread, CJSON_Parallel_run, worker);
+        }
+
+        //the chunks are dealt like cards to the workers that started so they move through the input together,
+        //a worker that failed to start would leave a hole in the input order
+        for(unsigned i = 0U; i < worker_count; i++) {
+            parallel.stride += parallel.workers[i].is_started ? 1U : 0U;
+        }
+        unsigned dealt = 0U;
+        for(unsigned i = 0U; i < worker_count; i++) {
+            struct CJSON_Parallel_Worker *const worker = parallel.workers + i;
+            if(worker->is_started) {
+                worker->first = dealt;
+                worker->count = (parallel.chunk_count - dealt + parallel.stride - 1U) / parallel.stride;
+                dealt++;
+            }
+        }
+
+        CJSON_Mutex_lock(&parallel.mutex);
+        parallel.is_dealt = true;
+        CJSON_Condition_broadcast(&parallel.condition);
+        CJSON_Mutex_unlock(&parallel.mutex);
+
+        CJSON_Parallel_run(parallel.workers);
+
+        for(unsigned i = 1U; i < worker_count; i++) {
+            if(parallel.workers[i].is_started) {
+                CJSON_Thread_join(&parallel.workers[i].thread);
+            }
+        }
+    }
+
+    for(unsigned i = 0U; i < worker_count; i++) {
+        struct CJSON_Parallel_Worker *const worker = parallel.workers + i;
+
+        CJSON_Builder_free(&worker->builder);
+        CJSON_Tokens_free(&worker->tokens);
+        CJSON_Parser_free(&worker->parser);
+        CJSON_FREE(worker->records);
+        CJSON_Mutex_free(&worker->mutex);
+    }
+    CJSON_Condition_free(&parallel.condition);
+    CJSON_Mutex_free(&parallel.mutex);
+    CJSON_FREE(parallel.workers);
+
+    return parallel.error;
+}
+
+//the commas of a container opened in a previous chunk and the bracket closing it, the last one of a chunk isn't closed
+struct CJSON_Parallel_Close {
+    const struct CJSON_Token *closer;
+    unsigned                  commas,
+                              first_comma; //token index, only set when there are commas
+};
+
+struct CJSON_Parallel_Chunk {
+    const char                  *data;
+    unsigned                     first,          //the bytes given to the chunk to count the quotes
+                                 last,
+                                 quotes,
+                                 start,          //the bytes lexed by the chunk, they start outside of a string and of a token
+                                 end,
+                                 token_offset;   //the index of the first token of the chunk in the document
+    bool                         is_escaped,     //the chunk starts after an odd number of backslashes
+                                 is_failed;
+    enum CJSON_Lexer_Error       error;
+    struct CJSON_Tokens          tokens;
+    struct CJSON_Tokens         *document;
+    struct CJSON_Counters        counters;
+    struct CJSON_Stack           openers;        //the containers still open at the end of the chunk, a token and its element count
+    struct CJSON_Parallel_Close *closes;
+    unsigned                     close_count,
+                                 close_capacity;
+};
+
+//a part of the elements of the root, built with its own parser
+struct CJSON_Parallel_Part {
+    struct CJSON_Parser       parser;
+    struct CJSON_Tokens       tokens;
+    const struct CJSON_Token *end;
+    struct CJSON             *values;
+    struct CJSON_KV          *entries;
+    unsigned                  slot,
+                              count;
+};
+
+//runs the function on every argument, the first one on the calling thread.
+//an argument whose thread failed to start is run on the calling thread once the others are started
+static void CJSON_Parallel_for(struct CJSON_Thread *const threads, bool *const is_started, void (*const function)(void*), void *const arguments, const unsigned count, const size_t size) {
+    assert(threads != NULL);
+    assert(is_started != NULL);
+    assert(function != NULL);
+    assert(arguments != NULL);
+
+    unsigned char *const argument = (unsigned char*)arguments;
+    for(unsigned i = 1U; i < count; i++) {
+        is_started[i] = CJSON_Thread_create(threads + i, function, argument + i * size);
+    }
+
+    function(argument);
+
+    for(unsigned i = 1U; i < count; i++) {
+        if(is_started[i]) {
+            CJSON_Thread_join(threads + i);
+        } else {
+            function(argument + i * size);
+        }
+    }
+}
+
+//the quotes that are not escaped, their parity tells if the next chunk starts in a string.
+//a backslash outside of a string is an invalid token anyway so the escapes are followed everywhere
+static void CJSON_Parallel_count_quotes(void *const argument) {
+    struct CJSON_Parallel_Chunk *const chunk = (struct CJSON_Parallel_Chunk*)argument;
+    const char *const                  data  = chunk->data;
+
+    unsigned backslashes = 0U;
+    while(backslashes < chunk->first && data[chunk->first - backslashes - 1U] == '\\') {
+        backslashes++;
+    }
+    chunk->is_escaped = backslashes % 2U == 1U;
+
+    unsigned quotes  = 0U;
+    bool     escaped = chunk->is_escaped;
+    for(unsigned i = chunk->first; i < chunk->last; i++) {
+        if(escaped) {
+            escaped = false;
+        } else if(data[i] == '\\') {
+            escaped = true;
+        } else if(data[i] == '"') {
+            quotes++;
+        }
+    }
+    chunk->quotes = quotes;
+}
+
+static void CJSON_Parallel_lex(void *const argument) {
+    struct CJSON_Parallel_Chunk *const chunk = (struct CJSON_Parallel_Chunk*)argument;
+
+    chunk->error = CJSON_LEXER_ERROR_NONE;
+    if(chunk->start == chunk->end) {
+        return;
+    }
+
+    if(!CJSON_Tokens_reserve(&chunk->tokens, (chunk->end - chunk->start) / 8U)) {
+        chunk->error = CJSON_LEXER_ERROR_MEMORY;
+        return;
+    }
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, chunk->data, chunk->end);
+    lexer.position = chunk->start;
+    chunk->error   = CJSON_Lexer_scan(&lexer, &chunk->tokens, &chunk->counters);
+}
+
+static bool CJSON_Parallel_add_close(struct CJSON_Parallel_Chunk *const chunk, const struct CJSON_Parallel_Close *const close) {
+    assert(chunk != NULL);
+    assert(close != NULL);
+
+    if(chunk->close_count == chunk->close_capacity) {
+        bool success;
+        unsigned capacity = CJSON_safe_unsigned_mult(chunk->close_capacity, 2U, &success);
+        if(!success) {
+            return false;
+        }
+        if(capacity == 0U) {
+            capacity = 8U;
+        }
+
+        struct CJSON_Parallel_Close *const closes = (struct CJSON_Parallel_Close*)CJSON_REALLOC(chunk->closes, (size_t)capacity * sizeof(*closes));
+        if(closes == NULL) {
+            return false;
+        }
+
+        chunk->closes         = closes;
+        chunk->close_capacity = capacity;
+    }
+
+    chunk->closes[chunk->close_count] = *close;
+    chunk->close_count++;
+
+    return true;
+}
+
+//an open container is two entries of the stack like in CJSON_Lexer_tokenize: its token and its element count on top
+static bool CJSON_Parallel_open_container(struct CJSON_Stack *const stack, struct CJSON_Token *const container, const unsigned count) {
+    assert(stack != NULL);
+    assert(container != NULL);
+
+    return CJSON_Stack_push(stack, container) && CJSON_Stack_push(stack, UNSIGNED_TO_VOID_PTR(count));
+}
+
+static void CJSON_Parallel_add_elements(struct CJSON_Stack *const stack, const unsigned count) {
+    assert(stack != NULL);
+    assert(stack->count >= 2U);
+
+    void **const top = stack->data + stack->count - 1U;
+    *top = UNSIGNED_TO_VOID_PTR(VOID_PTR_TO_UNSIGNED(*top) + count);
+}
+
+//pops the container, the token gets its element count capped to CJSON_TOKEN_MAXIMUM_LENGTH and the counters all of it
+static unsigned CJSON_Parallel_close_container(struct CJSON_Stack *const stack, struct CJSON_Counters *const counters) {
+    assert(stack != NULL);
+    assert(stack->count >= 2U);
+    assert(counters != NULL);
+
+    void *const               top       = CJSON_Stack_unsafe_pop(stack);
+    struct CJSON_Token *const container = (struct CJSON_Token*)CJSON_Stack_unsafe_pop(stack);
+    const unsigned            count     = VOID_PTR_TO_UNSIGNED(top);
+    assert(container->type == CJSON_TOKEN_LCURLY || container->type == CJSON_TOKEN_LBRACKET);
+
+    container->length = MIN(count, CJSON_TOKEN_MAXIMUM_LENGTH) & CJSON_TOKEN_MAXIMUM_LENGTH;
+    if(container->type == CJSON_TOKEN_LCURLY) {
+        counters->object_elements += count;
+        counters->object_tables   += CJSON_Object_table_size(count);
+    } else {
+        counters->array_elements += MAX(count, CJSON_ARRAY_MINIMUM_CAPACITY);
+    }
+
+    return count;
+}
+
+//copies the tokens of the chunk in the document and counts the elements of the containers opened and closed in the chunk,
+//the commas and brackets of the others are kept for CJSON_Parallel_count_elements
+static void CJSON_Parallel_merge_tokens(void *const argument) {
+    struct CJSON_Parallel_Chunk *const chunk = (struct CJSON_Parallel_Chunk*)argument;
+
+    struct CJSON_Token *const tokens = chunk->document->data + chunk->token_offset;
+    if(chunk->tokens.count > 0U) {
+        memcpy(tokens, chunk->tokens.data, (size_t)chunk->tokens.count * sizeof(*tokens));
+    }
+    const unsigned count = chunk->tokens.count;
+    CJSON_Tokens_free(&chunk->tokens);
+
+    struct CJSON_Parallel_Close close;
+    close.closer      = NULL;
+    close.commas      = 0U;
+    close.first_comma = 0U;
+
+    for(unsigned i = 0U; i < count; i++) {
+        struct CJSON_Token *const token = tokens + i;
+
+        switch(token->type) {
+        case CJSON_TOKEN_LCURLY:
+        case CJSON_TOKEN_LBRACKET:
+            if(!CJSON_Parallel_open_container(&chunk->openers, token, 1U)) {
+                chunk->is_failed = true;
+                return;
+            }
+            continue;
+
+        case CJSON_TOKEN_RCURLY:
+        case CJSON_TOKEN_RBRACKET:
+            if(chunk->openers.count > 0U) {
+                CJSON_Parallel_close_container(&chunk->openers, &chunk->counters);
+                continue;
+            }
+
+            close.closer = token;
+            if(!CJSON_Parallel_add_close(chunk, &close)) {
+                chunk->is_failed = true;
+                return;
+            }
+            close.closer = NULL;
+            close.commas = 0U;
+            continue;
+
+        case CJSON_TOKEN_COMMA:
+            if(chunk->openers.count > 0U) {
+                CJSON_Parallel_add_elements(&chunk->openers, 1U);
+                continue;
+            }
+
+            if(close.commas == 0U) {
+                close.first_comma = chunk->token_offset + i;
+            }
+            close.commas++;
+            continue;
+
+        default:
+            continue;
+        }
+    }
+
+    if(!CJSON_Parallel_add_close(chunk, &close)) {
+        chunk->is_failed = true;
+    }
+}
+
+static void CJSON_Parallel_build_part(void *const argument) {
+    struct CJSON_Parallel_Part *const part = (struct CJSON_Parallel_Part*)argument;
+
+    const bool success = part->entries != NULL
+        ? CJSON_parse_object_range(&part->parser, part->entries, part->count, &part->tokens)
+        : CJSON_parse_array_range(&part->parser, part->values, part->count, &part->tokens);
+
+    if(success && part->tokens.current_token != part->end) {
+        part->parser.error = part->entries != NULL
+            ? CJSON_ERROR_MISSING_COMMA_OR_RCURLY
+            : CJSON_ERROR_MISSING_COMMA_OR_RBRACKET;
+    }
+}
+
+//finishes the counts of the containers spanning several chunks like CJSON_Lexer_tokenize does,
+//the root is split at the first root comma of every chunk after the first one
+static enum CJSON_Error CJSON_Parallel_count_elements(
+    struct CJSON_Parallel_Chunk *const chunks,
+    const unsigned chunk_count,
+    struct CJSON_Counters *const counters,
+    struct CJSON_Parallel_Part *const parts,
+    unsigned *const part_count,
+    const struct CJSON_Token **const root_closer,
+    unsigned *const root_count
+) {
+    assert(chunks != NULL);
+    assert(counters != NULL);
+    assert(parts != NULL);
+    assert(part_count != NULL);
+    assert(root_closer != NULL);
+    assert(root_count != NULL);
+
+    struct CJSON_Stack stack;
+    CJSON_Stack_init(&stack);
+
+    *part_count  = 0U;
+    *root_closer = NULL;
+    *root_count  = 0U;
+    for(unsigned i = 0U; i < chunk_count; i++) {
+        const struct CJSON_Parallel_Chunk *const chunk = chunks + i;
+        bool is_split = i == 0U;
+
+        for(unsigned j = 0U; j < chunk->close_count; j++) {
+            const struct CJSON_Parallel_Close *const close = chunk->closes + j;
+
+            if(close->commas > 0U) {
+                if(stack.count == 0U) {
+                    CJSON_Stack_free(&stack);
+                    return CJSON_ERROR_TOKEN;
+                }
+
+                //the count of an open container is one more than the commas seen so far, the index of the element after the comma
+                if(stack.count == 2U && !is_split) {
+                    void *const count = CJSON_Stack_unsafe_peek(&stack);
+                    parts[*part_count].slot                 = VOID_PTR_TO_UNSIGNED(count);
+                    parts[*part_count].tokens.current_token = chunk->document->data + close->first_comma + 1U;
+                    (*part_count)++;
+                    is_split = true;
+                }
+                CJSON_Parallel_add_elements(&stack, close->commas);
+            }
+
+            if(close->closer != NULL) {
+                if(stack.count == 0U) {
+                    CJSON_Stack_free(&stack);
+                    return CJSON_ERROR_TOKEN;
+                }
+                const unsigned count = CJSON_Parallel_close_container(&stack, counters);
+                if(stack.count == 0U && *root_closer == NULL) {
+                    *root_closer = close->closer;
+                    *root_count  = count;
+                }
+            }
+        }
+
+        for(unsigned j = 0U; j < chunk->openers.count; j++) {
+            if(!CJSON_Stack_push(&stack, chunk->openers.data[j])) {
+                CJSON_Stack_free(&stack);
+                return CJSON_ERROR_MEMORY;
+            }
+        }
+    }
+
+    CJSON_Stack_free(&stack);
+    return CJSON_ERROR_NONE;
+}
+
+//builds the elements of a big root array or object on several threads, each part is parsed with its own parser
+//and the arenas are merged in the parser at the end. The members of an object are inserted in it once they are parsed
+static struct CJSON *CJSON_Parallel_build(
+    struct CJSON_Parser *const parser,
+    struct CJSON_Tokens *const tokens,
+    struct CJSON_Parallel_Part *const parts,
+    const unsigned part_count,
+    const struct CJSON_Token *const root_closer,
+    const unsigned root_count,
+    struct CJSON_Thread *const threads,
+    bool *const is_started
+) {
+    assert(parser != NULL);
+    assert(tokens != NULL);
+    assert(parts != NULL);
+    assert(part_count > 1U);
+    assert(root_closer != NULL);
+
+    const struct CJSON_Token *const root = tokens->data;
+    const bool is_object = root->type == CJSON_TOKEN_LCURLY;
+
+    if((root->type == CJSON_TOKEN_LCURLY) != (root_closer->type == CJSON_TOKEN_RCURLY)) {
+        parser->error = is_object
+            ? CJSON_ERROR_MISSING_COMMA_OR_RCURLY
+            : CJSON_ERROR_MISSING_COMMA_OR_RBRACKET;
+        return NULL;
+    }
+
+    //nothing can follow the root value
+    if(root_closer + 1 != tokens->data + tokens->count - 1U) {
+        parser->error = CJSON_ERROR_TOKEN;
+        return NULL;
+    }
+
+    struct CJSON *const json = CJSON_new(parser);
+    if(json == NULL) {
+        return NULL;
+    }
+
+    struct CJSON_Array *const array = &json->value.array;
+    CJSON_Array_init(array);
+    if(!is_object && !CJSON_Array_reserve(array, parser, root_count)) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    for(unsigned i = 0U; i < part_count; i++) {
+        struct CJSON_Parallel_Part *const part = parts + i;
+        const unsigned next_slot = i + 1U < part_count ? parts[i + 1U].slot : root_count;
+
+        part->end     = i + 1U < part_count ? parts[i + 1U].tokens.current_token - 1 : root_closer;
+        part->count   = next_slot - part->slot;
+        part->values  = is_object ? NULL : array->values + part->slot;
+        part->entries = NULL;
+        if(is_object) {
+            part->entries = (struct CJSON_KV*)CJSON_MALLOC((size_t)part->count * sizeof(*part->entries));
+            if(part->entries == NULL) {
+                parser->error = CJSON_ERROR_MEMORY;
+            }
+        }
+    }
+
+    if(parser->error == CJSON_ERROR_NONE) {
+        CJSON_Parallel_for(threads, is_started, CJSON_Parallel_build_part, parts, part_count, sizeof(*parts));
+
+        for(unsigned i = 0U; i < part_count; i++) {
+            if(parts[i].parser.error != CJSON_ERROR_NONE) {
+                parser->error = parts[i].parser.error;
+                break;
+            }
+        }
+    }
+
+    if(parser->error == CJSON_ERROR_NONE) {
+        if(is_object) {
+            struct CJSON_Object *const object = &json->value.object;
+            CJSON_Object_init(object);
+            if(!CJSON_Object_reserve(object, parser, root_count)) {
+                parser->error = CJSON_ERROR_MEMORY;
+            }
+
+            for(unsigned i = 0U; i < part_count && parser->error == CJSON_ERROR_NONE; i++) {
+                for(unsigned j = 0U; j < parts[i].count; j++) {
+                    struct CJSON_KV *const entry = CJSON_Object_get_entry_hashed(object, parser, parts[i].entries[j].key, parts[i].entries[j].key_length, parts[i].entries[j].hash);
+                    if(entry == NULL) {
+                        parser->error = CJSON_ERROR_MEMORY;
+                        break;
+                    }
+                    entry->key   = parts[i].entries[j].key;
+                    entry->value = parts[i].entries[j].value;
+                }
+            }
+            json->type = CJSON_OBJECT;
+        } else {
+            array->count = root_count;
+            json->type   = CJSON_ARRAY;
+        }
+    }
+
+    for(unsigned i = 0U; i < part_count; i++) {
+        CJSON_FREE(parts[i].entries);
+        parts[i].entries = NULL;
+        CJSON_Parser_merge(parser, &parts[i].parser);
+    }
+
+    return parser->error == CJSON_ERROR_NONE ? json : NULL;
+}
+
+//the chunk boundaries are moved forward to the end of the string or of the token they fall in
+static void CJSON_Parallel_place_chunks(struct CJSON_Parallel_Chunk *const chunks, const unsigned chunk_count, const char *const data, const unsigned length) {
+    assert(chunks != NULL);
+    assert(data != NULL);
+
+    bool in_string = false;
+    chunks[0].start = 0U;
+    for(unsigned i = 1U; i < chunk_count; i++) {
+        in_string = in_string != (chunks[i - 1U].quotes % 2U == 1U);
+
+        unsigned position = chunks[i].first;
+        if(in_string) {
+            bool escaped = chunks[i].is_escaped;
+            while(position < length) {
+                const char c = data[position++];
+                if(escaped) {
+                    escaped = false;
+                } else if(c == '\\') {
+                    escaped = true;
+                } else if(c == '"') {
+                    break;
+                }
+            }
+        } else {
+            while(position < length && !CJSON_is_whitespace(data[position]) && !CJSON_is_delimiter(data[position]) && data[position] != '"') {
+                position++;
+            }
+        }
+
+        chunks[i].start = MAX(position, chunks[i - 1U].start);
+        chunks[i - 1U].end = chunks[i].start;
+    }
+    chunks[chunk_count - 1U].end = length;
+}
+
+EXTERN_C struct CJSON *CJSON_parse_parallel(struct CJSON_Parser *const parser, const char *const data, const unsigned length, unsigned thread_count) {
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(length > 0U);
+
+    if(thread_count == 0U) {
+        thread_count = CJSON_Thread_count();
+    }
+
+    const unsigned chunk_count = MIN(thread_count, length / CJSON_PARALLEL_CHUNK_SIZE);
+    if(chunk_count < 2U) {
+        return CJSON_parse(parser, data, length);
+    }
+
+    parser->error = CJSON_ERROR_NONE;
+
+    struct CJSON_Parallel_Chunk *const chunks     = (struct CJSON_Parallel_Chunk*)CJSON_MALLOC((size_t)chunk_count * sizeof(*chunks));
+    struct CJSON_Parallel_Part  *const parts      = (struct CJSON_Parallel_Part*) CJSON_MALLOC((size_t)chunk_count * sizeof(*parts));
+    struct CJSON_Thread         *const threads    = (struct CJSON_Thread*)        CJSON_MALLOC((size_t)chunk_count * sizeof(*threads));
+    bool                        *const is_started = (bool*)                       CJSON_MALLOC((size_t)chunk_count * sizeof(*is_started));
+
+    struct CJSON_Tokens tokens;
+    CJSON_Tokens_init(&tokens);
+
+    const bool is_allocated = chunks != NULL && parts != NULL && threads != NULL && is_started != NULL;
+
+    struct CJSON *json = NULL;
+    unsigned part_count = 0U;
+    do {
+        if(!is_allocated) {
+            parser->error = CJSON_ERROR_MEMORY;
+            break;
+        }
+
+        for(unsigned i = 0U; i < chunk_count; i++) {
+            struct CJSON_Parallel_Chunk *const chunk = chunks + i;
+
+            chunk->data           = data;
+            chunk->first          = (unsigned)((uint64_t)length * i / chunk_count);
+            chunk->last           = (unsigned)((uint64_t)length * (i + 1U) / chunk_count);
+            chunk->is_failed      = false;
+            chunk->document       = &tokens;
+            chunk->closes         = NULL;
+            chunk->close_count    = 0U;
+            chunk->close_capacity = 0U;
+            CJSON_Tokens_init(&chunk->tokens);
+            CJSON_Counters_init(&chunk->counters);
+            CJSON_Stack_init(&chunk->openers);
+
+            CJSON_Parser_init(&parts[i].parser);
+            parts[i].parser.options   = parser->options;
+            parts[i].parser.max_depth = parser->max_depth;
+            parts[i].entries        = NULL;
+        }
+
+        //a quote parity pass first so every chunk starts outside of a string
+        CJSON_Parallel_for(threads, is_started, CJSON_Parallel_count_quotes, chunks, chunk_count, sizeof(*chunks));
+        CJSON_Parallel_place_chunks(chunks, chunk_count, data, length);
+        CJSON_Parallel_for(threads, is_started, CJSON_Parallel_lex, chunks, chunk_count, sizeof(*chunks));
+
+        unsigned token_count = 0U;
+        for(unsigned i = 0U; i < chunk_count && parser->error == CJSON_ERROR_NONE; i++) {
+            if(chunks[i].error == CJSON_LEXER_ERROR_TOKEN) {
+                parser->error = CJSON_ERROR_TOKEN;
+            } else if(chunks[i].error == CJSON_LEXER_ERROR_MEMORY) {
+                parser->error = CJSON_ERROR_MEMORY;
+            }
+            chunks[i].token_offset = token_count;
+            token_count += chunks[i].tokens.count;
+        }
+        if(parser->error != CJSON_ERROR_NONE) {
+            break;
+        }
+
+        if(token_count == UINT_MAX || !CJSON_Tokens_reserve(&tokens, token_count + 1U)) {
+            parser->error = CJSON_ERROR_MEMORY;
+            break;
+        }
+        tokens.input         = data;
+        tokens.count         = token_count + 1U;
+        tokens.current_token = tokens.data;
+
+        struct CJSON_Token *const done = tokens.data + token_count;
+        done->offset = length;
+        done->length = 0U;
+        done->type   = CJSON_TOKEN_DONE;
+
+        CJSON_Parallel_for(threads, is_started, CJSON_Parallel_merge_tokens, chunks, chunk_count, sizeof(*chunks));
+
+        struct CJSON_Counters counters;
+        CJSON_Counters_init(&counters);
+        for(unsigned i = 0U; i < chunk_count; i++) {
+            if(chunks[i].is_failed) {
+                parser->error = chunks[i].error == CJSON_LEXER_ERROR_TOKEN ? CJSON_ERROR_TOKEN : CJSON_ERROR_MEMORY;
+                break;
+            }
+            counters.object          += chunks[i].counters.object;
+            counters.array           += chunks[i].counters.array;
+            counters.chars           += chunks[i].counters.chars;
+            counters.object_elements += chunks[i].counters.object_elements;
+            counters.array_elements  += chunks[i].counters.array_elements;
+            counters.object_tables   += chunks[i].counters.object_tables;
+        }
+        if(parser->error != CJSON_ERROR_NONE) {
+            break;
+        }
+
+        const struct CJSON_Token *root_closer;
+        unsigned                  root_count;
+        parts[0].slot                 = 0U;
+        parts[0].tokens.current_token = tokens.data + 1;
+        if((parser->error = CJSON_Parallel_count_elements(chunks, chunk_count, &counters, parts + 1, &part_count, &root_closer, &root_count)) != CJSON_ERROR_NONE) {
+            break;
+        }
+        part_count++;
+
+        const enum CJSON_Token_Type root_type = (enum CJSON_Token_Type)tokens.data[0].type;
+        if(part_count < 2U || root_closer == NULL || (root_type != CJSON_TOKEN_LBRACKET && root_type != CJSON_TOKEN_LCURLY)) {
+            if(!CJSON_Parser_reserve(parser, &counters)) {
+                parser->error = CJSON_ERROR_MEMORY;
+                break;
+            }
+            if((json = CJSON_new(parser)) != NULL && !CJSON_parse_token(parser, json, &tokens)) {
+                json = NULL;
+            }
+            break;
+        }
+
+        for(unsigned i = 0U; i < part_count; i++) {
+            struct CJSON_Token *const current_token = parts[i].tokens.current_token;
+
+            parts[i].tokens               = tokens;
+            parts[i].tokens.current_token = current_token;
+        }
+        json = CJSON_Parallel_build(parser, &tokens, parts, part_count, root_closer, root_count, threads, is_started);
+    } while(0);
+
+    if(is_allocated) {
+        for(unsigned i = 0U; i < chunk_count; i++) {
+            CJSON_Tokens_free(&chunks[i].tokens);
+            CJSON_Stack_free(&chunks[i].openers);
+            CJSON_FREE(chunks[i].closes);
+            CJSON_Parser_free(&parts[i].parser);
+        }
+    }
+    CJSON_Tokens_free(&tokens);
+    CJSON_FREE(is_started);
+    CJSON_FREE(threads);
+    CJSON_FREE(parts);
+    CJSON_FREE(chunks);
+
+    if(parser->error != CJSON_ERROR_NONE) {
+        CJSON_Parser_free(parser);
+        return NULL;
+    }
+    return json;
+}
@@ -0,0 +1,44 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_PARALLEL_H
+#define CJSON_PARALLEL_H
+
+//the input is split in chunks of about this size, cut at the first newline after it
+#define CJSON_PARALLEL_CHUNK_SIZE (1U << 20)
+
+#include <stdbool.h>
+#include "json.h"
+
+struct CJSON_Parser;
+
+enum CJSON_Parallel_Order {
+    //one callback at a time, in the order of the input
+    CJSON_PARALLEL_ORDER_INPUT,
+    //as soon as a record is parsed, the callback is called from several threads at the same time
+    CJSON_PARALLEL_ORDER_COMPLETION
+};
+
+//parses newline delimited JSON on thread_count threads (0 for one per processor), each with its own parser.
+//the callback gets the byte offset of the record in the input and is used like with CJSON_parse_many
+enum CJSON_Error CJSON_parse_many_parallel(
+    const char *data,
+    unsigned length,
+    unsigned options,
+    unsigned thread_count,
+    enum CJSON_Parallel_Order,
+    bool (*callback)(void *context, struct CJSON_Parser*, struct CJSON *json, unsigned offset),
+    void *context
+);
+
+//parses one document on thread_count threads (0 for one per processor) and returns it like CJSON_parse.
+//the chunks are lexed in parallel and the elements of a big root array or object are built in parallel,
+//an input smaller than two chunks is parsed by CJSON_parse. CJSON_PARSER_OPTION_SINGLE_PASS is ignored
+struct CJSON *CJSON_parse_parallel(struct CJSON_Parser*, const char *data, unsigned length, unsigned thread_count);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,428 +7,173 @@
 #include "util.h"
 #include "file.h"
 #include "lexer.h"
+#include "decoder.h"
+#include "builder.h"
+#include "walker.h"
 
 #define CJSON_DEFAULT_ARENA_SIZE     CJSON_ARENA_MINIMUM_SIZE
 #define CJSON_DEFAULT_ARENA_NODE_MAX CJSON_ARENA_INFINITE_NODES
 
-static bool CJSON_parse_token(struct CJSON_Parser*, struct CJSON*, struct CJSON_Tokens*);
-
-static bool CJSON_decode_string_token(struct CJSON_Parser *const parser, struct CJSON_String *const string, struct CJSON_Tokens *const tokens) {
-    assert(parser != NULL);
-    assert(string != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token->length >= 2);
-
-    const struct CJSON_Token *const token = tokens->current_token;
-    char *output_current = CJSON_ARENA_ALLOC(&parser->string_arena, token->length - 1U, char);
-    if(output_current == NULL) {
-        return false;
-    }
-    char *const output_start    = output_current;
-    const char *const input_end = token->value + token->length - 2;
-    const char *input_current   = token->value + 1;
-    bool escaping               = false;
+//the CJSON DOM built by the walker, values or entries are the elements of a range of the root when one is walked
+struct CJSON_Dom {
+    struct CJSON_Parser *parser;
+    const char          *data;
+    struct CJSON        *values;
+    struct CJSON_KV     *entries;
+    unsigned             index;
+};
+
+static bool CJSON_Dom_scalar(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Dom *const dom  = (struct CJSON_Dom*)context;
+    struct CJSON *const     json = (struct CJSON*)value;
+    assert(dom != NULL);
+    assert(json != NULL);
+    assert(token != NULL);
 
-    while(input_current != input_end + 1) {
-        if(CJSON_is_control_char(*input_current)) {
+    switch(token->type) {
+    case CJSON_TOKEN_STRING:
+        if(!CJSON_decode_string(dom->parser, &json->value.string, dom->data, token)) {
+            dom->parser->error = CJSON_ERROR_STRING;
             return false;
         }
+        json->type = CJSON_STRING;
+        return true;
 
-        if(!escaping) {
-            if(*input_current == '\\') {
-                escaping = true;
-                input_current++;
-                continue;
-            }
-
-            *(output_current++) = *(input_current++);
-            continue;
-        } 
-        
-        switch(*input_current) {
-        case '"':
-            escaping            = false;
-            *(output_current++) = '"';
-            input_current++;
-            continue;
-        case 'b':
-            escaping            = false;
-            *(output_current++) = '\b';
-            input_current++;
-            continue;
-        case 'f':
-            escaping            = false;
-            *(output_current++) = '\f';
-            input_current++;
-            continue;
-        case 'n':
-            escaping            = false;
-            *(output_current++) = '\n';
-            input_current++;
-            continue;
-        case 'r':
-            escaping            = false;
-            *(output_current++) = '\r';
-            input_current++;
-            continue;
-        case 't':
-            escaping            = false;
-            *(output_current++) = '\t';
-            input_current++;
-            continue;
-        case '/':
-            escaping            = false;
-            *(output_current++) = '/';
-            input_current++;
-            continue;
-        case '\\': {
-            escaping            = false;
-            *(output_current++) = '\\';
-            input_current++;
-            continue;
-        }
-        case 'u': {
-            if(input_end - input_current < 4) {
-                return false;
-            }
-
-            input_current++;
-
-            bool success;
-            const uint16_t high = CJSON_hex_to_utf16(input_current, &success);
-            //\u0000 is apparently an acceptable escaped character in JSON so if the parsing function returns 0 then it's either an error or \u0000. \0 would break cstrings so it's gonna be treated as an error as well.
-            if(high == 0U) {
-                return false;    
-            }
-
-            if(IS_VALID_2_BYTES_UTF16(high)) {
-                output_current += CJSON_utf16_to_utf8_2bytes(output_current, high);
-                input_current  += 4;
-                escaping        = false;
-                continue;
-            }
-
-            if(input_end - input_current < 9 || input_current[4] != '\\' || input_current[5] != 'u') {
-                return false;
-            }
-
-            const uint16_t low = CJSON_hex_to_utf16(input_current + 6, &success);
-            if(!success || !IS_VALID_4_BYTES_UTF16(high, low)) {
-                return false; 
-            }
-
-            CJSON_utf16_to_utf8_4bytes(output_current, high, low);
-            output_current += 4;
-            input_current  += 10;
-            escaping        = false;
-            continue;
-        }
-        default:
-            return false;        
-    }
-    }
-
-    if(escaping) {
-        return false;
-    }
-
-    const unsigned length = (unsigned)(output_current - output_start);
-    output_start[length]  = '\0';
-    string->chars         = output_start;
-    string->length        = length;
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT:
+        return CJSON_decode_number(dom->parser, json, dom->data, token);
 
-    return true;
-}
+    case CJSON_TOKEN_BOOL:
+        json->type          = CJSON_BOOL;
+        json->value.boolean = dom->data[token->offset] == 't';
+        return true;
 
-static bool CJSON_parse_string(struct CJSON_Parser *const parser, struct CJSON *const json, struct CJSON_Tokens *const tokens) {
-    assert(parser != NULL);
-    assert(json != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token != NULL);
-    
-    if(!CJSON_decode_string_token(parser, &json->value.string, tokens)) {
-        parser->error = CJSON_ERROR_STRING;
-        return false;
+    default:
+        assert(token->type == CJSON_TOKEN_NULL);
+        json->type       = CJSON_NULL;
+        json->value.null = NULL;
+        return true;
     }
-
-    json->type = CJSON_STRING;
-    tokens->current_token++;
-    return true;
 }
 
-static bool CJSON_parse_number(struct CJSON_Parser *const parser, struct CJSON *const json, struct CJSON_Tokens *const tokens) {
-    assert(parser != NULL);
+//the container is reserved for the element count of the lexer, it's capped for a very big one which grows past it
+static void *CJSON_Dom_open(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Dom *const dom  = (struct CJSON_Dom*)context;
+    struct CJSON *const     json = (struct CJSON*)value;
+    assert(dom != NULL);
     assert(json != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token != NULL);
-
-    char number[1 << 9] = {0};
-
-    bool success;
-    const struct CJSON_Token *const token = tokens->current_token;
-    if((size_t)token->length >= sizeof(number)) {
-        return false;
-    }
-
-    memcpy(number, token->value, (size_t)token->length);
-
-    if(token->type == CJSON_TOKEN_FLOAT) {
-        const double value = CJSON_parse_float64(number, &success);
-        if(!success) {
-            parser->error = CJSON_ERROR_FLOAT64;
-            return false;
-        }
+    assert(token != NULL);
 
-        json->type          = CJSON_FLOAT64;
-        json->value.float64 = value;
-    } else if(number[0] == '-') {
-        if(token->type == CJSON_TOKEN_SCIENTIFIC_INT) {
-            const long double value = CJSON_parse_long_double(number, &success);
-            if(!success || value < (long double)INT64_MIN || value > (long double)INT64_MAX) {
-                parser->error = CJSON_ERROR_INT64;
-                return false;
-            }
-            json->type        = CJSON_INT64;
-            json->value.int64 = (int64_t)value;
-
-        } else {
-            const int64_t value = CJSON_parse_int64(number, &success);
-            if(!success) {
-                parser->error = CJSON_ERROR_INT64;
-                return false;     
-            }
-            json->type        = CJSON_INT64;
-            json->value.int64 = value;
-        }
-    } else if(token->type == CJSON_TOKEN_SCIENTIFIC_INT) {
-        const long double value = CJSON_parse_long_double(number, &success);
-        if(!success || value > (long double)UINT64_MAX) {
-            parser->error = CJSON_ERROR_UINT64;
-            return false;
+    if(token->type == CJSON_TOKEN_LCURLY) {
+        json->type = CJSON_OBJECT;
+        if(!CJSON_Object_start(&json->value.object, dom->parser, token->length)) {
+            dom->parser->error = CJSON_ERROR_MEMORY;
+            return NULL;
         }
-        json->type         = CJSON_UINT64;
-        json->value.uint64 = (uint64_t)value;
     } else {
-        const uint64_t value = CJSON_parse_uint64(number, &success);
-        if(!success) {
-            parser->error = CJSON_ERROR_UINT64;
-            return false; 
+        json->type = CJSON_ARRAY;
+        CJSON_Array_init(&json->value.array);
+        if(!CJSON_Array_reserve(&json->value.array, dom->parser, token->length)) {
+            dom->parser->error = CJSON_ERROR_MEMORY;
+            return NULL;
         }
-        json->type         = CJSON_UINT64;
-        json->value.uint64 = value;
     }
 
-    tokens->current_token++;
-    return true;
-}
-
-static void CJSON_parse_bool(struct CJSON *const json, struct CJSON_Tokens *const tokens) {
-    assert(json != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token != NULL);
-
-    json->type = CJSON_BOOL;
-    json->value.boolean = tokens->current_token->value[0] == 't';
-
-    tokens->current_token++;
-}
-
-static void CJSON_parse_null(struct CJSON *const json, struct CJSON_Tokens *const tokens) {
-    assert(json != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token != NULL);
-
-    json->type = CJSON_NULL;
-    json->value.null = NULL;
-
-    tokens->current_token++;
+    return json;
 }
 
-static bool CJSON_parse_object( struct CJSON_Parser *const parser, struct CJSON *const json, struct CJSON_Tokens *const tokens) {
-    assert(parser != NULL);
-    assert(json != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token != NULL);
-
-    const unsigned length = tokens->current_token->length;
-    tokens->current_token++;
-
-    const struct CJSON_Token *const last_token = tokens->data + tokens->count - 1;
-    if(tokens->current_token == last_token) {
-        parser->error = CJSON_ERROR_OBJECT;
-        return false;
+static void *CJSON_Dom_element(void *const context, void *const container, const struct CJSON_Token *const key) {
+    struct CJSON_Dom *const dom  = (struct CJSON_Dom*)context;
+    struct CJSON *const     json = (struct CJSON*)container;
+    assert(dom != NULL);
+
+    if(key == NULL) {
+        struct CJSON *const value = json != NULL
+            ? CJSON_Array_next(&json->value.array, dom->parser)
+            : dom->values + dom->index++;
+        if(value == NULL) {
+            dom->parser->error = CJSON_ERROR_MEMORY;
+        }
+        return value;
     }
 
-    struct CJSON_Object *const object = &json->value.object;
-    CJSON_Object_init(object);
-    if(!CJSON_Object_reserve(object, parser, length)) {
-        parser->error = CJSON_ERROR_MEMORY;
-        return false;
+    struct CJSON_String key_string;
+    unsigned            hash;
+    if(!CJSON_decode_key(dom->parser, &key_string, &hash, dom->data, key)) {
+        dom->parser->error = CJSON_ERROR_OBJECT_KEY;
+        return NULL;
     }
 
-    if(tokens->current_token->type == CJSON_TOKEN_RCURLY) {
-        json->type = CJSON_OBJECT;
-        tokens->current_token++;
-        return true;
+    //the members of a range are inserted in the object by the caller
+    if(json == NULL) {
+        struct CJSON_KV *const entry = dom->entries + dom->index++;
+        entry->key        = key_string.chars;
+        entry->key_length = key_string.length;
+        entry->hash       = hash;
+        return &entry->value;
     }
 
-    while(last_token - tokens->current_token >= 4) {
-        if(tokens->current_token->type != CJSON_TOKEN_STRING) {
-            parser->error = CJSON_ERROR_OBJECT_KEY;
-            return false;
-        }
-
-        struct CJSON_String key;
-        if(!CJSON_decode_string_token(parser, &key, tokens)) {
-            parser->error = CJSON_ERROR_OBJECT_KEY;
-            return false;
-        }
-
-        tokens->current_token++;
-    
-        if(tokens->current_token->type != CJSON_TOKEN_COLON) {
-            parser->error = CJSON_ERROR_MISSING_COLON;
-            return false;
-        }
-
-        tokens->current_token++;
-
-        struct CJSON_KV *const entry = CJSON_Object_get_entry(object, parser, key.chars);
-        if(entry == NULL) {
-            parser->error = CJSON_ERROR_MEMORY;
-            return false;
-        }
-        entry->key = key.chars;
-
-        if(!CJSON_parse_token(parser, &entry->value, tokens)) {
-            if(parser->error == CJSON_ERROR_TOKEN) {
-                parser->error = CJSON_ERROR_OBJECT_VALUE;
-            }
-            return false;
-        }
-
-        if(tokens->current_token->type == CJSON_TOKEN_COMMA) {
-            tokens->current_token++;
-            continue;
-        }
-
-        if(tokens->current_token->type == CJSON_TOKEN_RCURLY) {
-            json->type = CJSON_OBJECT;
-            tokens->current_token++;
-            return true;
-        }
-
-        parser->error = CJSON_ERROR_MISSING_COMMA_OR_RCURLY;
-        return false;
+    struct CJSON *const value = CJSON_Object_add(&json->value.object, dom->parser, key_string.chars, key_string.length, hash);
+    if(value == NULL) {
+        dom->parser->error = CJSON_ERROR_MEMORY;
     }
-    
-    parser->error = CJSON_ERROR_OBJECT;
-    return false;
+
+    return value;
 }
 
-static bool CJSON_parse_array(struct CJSON_Parser *const parser, struct CJSON *const json, struct CJSON_Tokens *const tokens) {
-    assert(parser != NULL);
+static bool CJSON_Dom_close(void *const context, void *const container, const struct CJSON_Token *const token) {
+    struct CJSON_Dom *const dom  = (struct CJSON_Dom*)context;
+    struct CJSON *const     json = (struct CJSON*)container;
+    assert(dom != NULL);
     assert(json != NULL);
-    assert(tokens != NULL);
-    assert(tokens->current_token != NULL);
-
-    const unsigned length = tokens->current_token->length;
-    tokens->current_token++;
-
-    const struct CJSON_Token *const last_token = tokens->data + tokens->count - 1U;
-    if(tokens->current_token == last_token) {
-        parser->error = CJSON_ERROR_ARRAY;
-        return false;
-    }
-    
-    struct CJSON_Array *const array = &json->value.array;
-    CJSON_Array_init(array);
-    if(!CJSON_Array_reserve(array, parser, length)) {
-        parser->error = CJSON_ERROR_MEMORY;
-        return false;
-    }
+    (void)token;
 
-    if(tokens->current_token->type == CJSON_TOKEN_RBRACKET) {
-        json->type = CJSON_ARRAY;
-        tokens->current_token++;
-        return true;
+    if(json->type == CJSON_OBJECT) {
+        CJSON_Object_finish(&json->value.object, dom->parser);
     }
 
-    while(last_token - tokens->current_token >= 2) {
-        struct CJSON *const next_json = CJSON_Array_next(array, parser);
-        assert(next_json != NULL);
-
-        if(!CJSON_parse_token(parser, next_json, tokens)) {
-            if(parser->error == CJSON_ERROR_TOKEN) {
-                parser->error = CJSON_ERROR_ARRAY_VALUE;
-            }
-            return false;
-        }
- 
-        if(tokens->current_token->type == CJSON_TOKEN_COMMA) {
-            tokens->current_token++;
-            continue;
-        }
-
-        if(tokens->current_token->type == CJSON_TOKEN_RBRACKET) {
-            json->type = CJSON_ARRAY;
-            tokens->current_token++;
-            return true;
-        }
+    return true;
+}
 
-        parser->error = CJSON_ERROR_MISSING_COMMA_OR_RBRACKET;
-        return false;
-    }
+static void CJSON_Dom_init(struct CJSON_Dom *const dom, struct CJSON_Walker *const walker, struct CJSON_Parser *const parser, const char *const data) {
+    assert(dom != NULL);
+    assert(walker != NULL);
+    assert(parser != NULL);
+    assert(data != NULL);
 
-    parser->error = CJSON_ERROR_ARRAY;
-    return false;
+    dom->parser  = parser;
+    dom->data    = data;
+    dom->values  = NULL;
+    dom->entries = NULL;
+    dom->index   = 0U;
+
+    walker->open      = CJSON_Dom_open;
+    walker->element   = CJSON_Dom_element;
+    walker->scalar    = CJSON_Dom_scalar;
+    walker->close     = CJSON_Dom_close;
+    walker->context   = dom;
+    walker->error     = &parser->error;
+    walker->max_depth = parser->max_depth;
 }
 
-static bool CJSON_parse_token(struct CJSON_Parser *const parser, struct CJSON *const json, struct CJSON_Tokens *const tokens) {
+EXTERN_C bool CJSON_parse_token(struct CJSON_Parser *const parser, struct CJSON *const json, struct CJSON_Tokens *const tokens) {
     assert(parser != NULL);
     assert(json != NULL);
+    assert(tokens != NULL);
 
-    switch(tokens->current_token->type) {
-    case CJSON_TOKEN_STRING:
-        return CJSON_parse_string(parser, json, tokens);
-    
-    case CJSON_TOKEN_INT:
-    case CJSON_TOKEN_FLOAT:
-    case CJSON_TOKEN_SCIENTIFIC_INT:
-        return CJSON_parse_number(parser, json, tokens);
-
-    case CJSON_TOKEN_BOOL:
-        CJSON_parse_bool(json, tokens);
-        return true;
-
-    case CJSON_TOKEN_NULL:
-        CJSON_parse_null(json, tokens);
-        return true;
-
-    case CJSON_TOKEN_LBRACKET:
-        return CJSON_parse_array(parser, json, tokens);
-
-    case CJSON_TOKEN_LCURLY:
-        return CJSON_parse_object(parser, json, tokens);
-
-    default:
-        parser->error = CJSON_ERROR_TOKEN;
-        return false;
-    }
+    struct CJSON_Dom    dom;
+    struct CJSON_Walker walker;
+    CJSON_Dom_init(&dom, &walker, parser, tokens->input);
 
+    return CJSON_walk(&walker, json, tokens);
 }
 
+//only what the input needs is reserved, a minimum size here would start a new node for every small record parsed in the same arenas
 static bool CJSON_reserve_arenas(struct CJSON_Parser *const parser, const unsigned sizes[4]) {
     assert(parser != NULL);
     assert(sizes != NULL);
 
-    static const unsigned CJSON_SIZES[] = {
-        (unsigned)sizeof(struct CJSON_KV),
-        (unsigned)sizeof(struct CJSON),
-        (unsigned)sizeof(char),
-        (unsigned)sizeof(struct CJSON)
-    };
-
     struct CJSON_Arena *const arenas[] = {
         &parser->object_arena,
         &parser->array_arena,
@@ -444,16 +189,12 @@ static bool CJSON_reserve_arenas(struct CJSON_Parser *const parser, const unsign
         (unsigned)CJSON_ALIGNOF(struct CJSON) 
     };
 
-    const unsigned *object_size = CJSON_SIZES;
     const unsigned *alignment = alignments;
     for(struct CJSON_Arena *const *arena = arenas; 
         *arena != NULL; 
-        arena++, sizes++, object_size++, alignment++
+        arena++, sizes++, alignment++
     ) {
-        assert(!CJSON_check_unsigned_mult_overflow(CJSON_DEFAULT_ARENA_SIZE, *object_size));
-
-        const unsigned arena_size = MAX(*sizes, CJSON_DEFAULT_ARENA_SIZE * *object_size);
-        if(!CJSON_Arena_reserve(*arena, arena_size, *alignment)) {
+        if(*sizes > 0U && !CJSON_Arena_reserve(*arena, *sizes, *alignment)) {
             return false;
         }
     }
@@ -508,14 +249,27 @@ static struct CJSON *CJSON_Parser_new_json(struct CJSON_Parser *const parser) {
     return json;
 }
 
+//the shape and the last object are in the arenas
+static void CJSON_Parser_forget_shape(struct CJSON_Parser *const parser) {
+    assert(parser != NULL);
+
+    parser->shape = NULL;
+    CJSON_Object_init(&parser->last_object);
+}
+
 EXTERN_C void CJSON_Parser_init(struct CJSON_Parser *const parser) {
     assert(parser != NULL);
 
-    parser->error = CJSON_ERROR_NONE;
+    parser->error   = CJSON_ERROR_NONE;
+    parser->options   = CJSON_PARSER_OPTION_NONE;
+    parser->max_depth = CJSON_PARSER_DEFAULT_MAX_DEPTH;
+    parser->insitu    = NULL;
     CJSON_Arena_init(&parser->object_arena, CJSON_DEFAULT_ARENA_NODE_MAX, "Object Arena");
     CJSON_Arena_init(&parser->array_arena,  CJSON_DEFAULT_ARENA_NODE_MAX, "Array Arena");
     CJSON_Arena_init(&parser->string_arena, CJSON_DEFAULT_ARENA_NODE_MAX, "String Arena");
     CJSON_Arena_init(&parser->json_arena,   CJSON_DEFAULT_ARENA_NODE_MAX, "JSON Arena");
+    CJSON_Symbols_init(&parser->symbols);
+    CJSON_Parser_forget_shape(parser);
 }
 
 EXTERN_C void CJSON_Parser_free(struct CJSON_Parser *const parser) {
@@ -525,74 +279,316 @@ EXTERN_C void CJSON_Parser_free(struct CJSON_Parser *const parser) {
     CJSON_Arena_free(&parser->array_arena);
     CJSON_Arena_free(&parser->string_arena);
     CJSON_Arena_free(&parser->json_arena);
+    CJSON_Symbols_free(&parser->symbols);
+    CJSON_Parser_forget_shape(parser);
 }
 
-EXTERN_C struct CJSON *CJSON_parse(struct CJSON_Parser *const parser, const char *const data, const unsigned length) {
+EXTERN_C void CJSON_Parser_reset(struct CJSON_Parser *const parser) {
     assert(parser != NULL);
-    assert(data != NULL);
-    assert(length > 0U);
 
-    struct CJSON *json = NULL;
+    CJSON_Arena_reset(&parser->object_arena);
+    CJSON_Arena_reset(&parser->array_arena);
+    CJSON_Arena_reset(&parser->string_arena);
+    CJSON_Arena_reset(&parser->json_arena);
+    CJSON_Parser_forget_shape(parser);
     parser->error = CJSON_ERROR_NONE;
+}
 
-    struct CJSON_Tokens tokens;
-    CJSON_Tokens_init(&tokens);
-    if(!CJSON_Tokens_reserve(&tokens, length / 2U)) {
+EXTERN_C struct CJSON_Key CJSON_Parser_key(struct CJSON_Parser *const parser, const char *const chars, const unsigned length) {
+    assert(parser != NULL);
+    assert(chars != NULL);
+
+    struct CJSON_Key key = CJSON_Key_make(chars, length);
+
+    const char *const symbol = CJSON_Symbols_intern(&parser->symbols, chars, length, key.hash);
+    if(symbol != NULL) {
+        key.chars = symbol;
+    }
+
+    return key;
+}
+
+EXTERN_C bool CJSON_Parser_reserve(struct CJSON_Parser *const parser, const struct CJSON_Counters *const counters) {
+    assert(parser != NULL);
+    assert(counters != NULL);
+
+    //the entries of the objects are between their headers and their hash tables, the next object may need padding
+    const unsigned object_size      = counters->object_elements * (unsigned)sizeof(struct CJSON_KV)
+                                    + counters->object_tables
+                                    + counters->object * (unsigned)CJSON_ALIGNOF(struct CJSON_KV);
+    //in situ and zero copy strings are mostly not allocated so the string arena grows on demand
+    const bool     strings_in_input = parser->insitu != NULL || (parser->options & CJSON_PARSER_OPTION_ZERO_COPY) != 0U;
+    const unsigned arena_sizes[]    = {
+        object_size,
+        counters->array_elements  * (unsigned)sizeof(struct CJSON),
+        strings_in_input ? 0U : counters->chars * (unsigned)sizeof(char),
+        (unsigned)sizeof(struct CJSON)
+    };
+
+    return parser->object_arena.head != NULL
+        ? CJSON_reserve_arenas(parser, arena_sizes)
+        : CJSON_init_arenas(parser, arena_sizes);
+}
+
+EXTERN_C void CJSON_Parser_merge(struct CJSON_Parser *const parser, struct CJSON_Parser *const other) {
+    assert(parser != NULL);
+    assert(other != NULL);
+
+    CJSON_Arena_merge(&parser->object_arena, &other->object_arena);
+    CJSON_Arena_merge(&parser->array_arena,  &other->array_arena);
+    CJSON_Arena_merge(&parser->string_arena, &other->string_arena);
+    CJSON_Arena_merge(&parser->json_arena,   &other->json_arena);
+    CJSON_Symbols_merge(&parser->symbols,    &other->symbols);
+    CJSON_Parser_forget_shape(other);
+}
+
+EXTERN_C bool CJSON_parse_array_range(struct CJSON_Parser *const parser, struct CJSON *const values, const unsigned count, struct CJSON_Tokens *const tokens) {
+    assert(parser != NULL);
+    assert(values != NULL);
+    assert(tokens != NULL);
+
+    struct CJSON_Dom    dom;
+    struct CJSON_Walker walker;
+    CJSON_Dom_init(&dom, &walker, parser, tokens->input);
+    dom.values = values;
+
+    return CJSON_walk_elements(&walker, false, count, tokens);
+}
+
+EXTERN_C bool CJSON_parse_object_range(struct CJSON_Parser *const parser, struct CJSON_KV *const entries, const unsigned count, struct CJSON_Tokens *const tokens) {
+    assert(parser != NULL);
+    assert(entries != NULL);
+    assert(tokens != NULL);
+
+    struct CJSON_Dom    dom;
+    struct CJSON_Walker walker;
+    CJSON_Dom_init(&dom, &walker, parser, tokens->input);
+    dom.entries = entries;
+
+    return CJSON_walk_elements(&walker, true, count, tokens);
+}
+
+//the builder is reset for the input so CJSON_parse_many can reuse its frames between records
+static struct CJSON *CJSON_build(struct CJSON_Parser *const parser, struct CJSON_Builder *const builder, const char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(builder != NULL);
+    assert(data != NULL);
+
+    static const unsigned arena_default_sizes[] = {0U, 0U, 0U, 0U};
+
+    if(parser->object_arena.head == NULL && !CJSON_init_arenas(parser, arena_default_sizes)) {
         parser->error = CJSON_ERROR_MEMORY;
         return NULL;
     }
-    
-    struct CJSON_Counters counters;
-    CJSON_Counters_init(&counters);
+
+    struct CJSON *const json = CJSON_Parser_new_json(parser);
+    if(json == NULL) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+    CJSON_Builder_reset(builder, json);
 
     struct CJSON_Lexer lexer;
     CJSON_Lexer_init(&lexer, data, length);
 
+    struct CJSON_Token       token;
+    enum   CJSON_Lexer_Error error;
     do {
-        const enum CJSON_Lexer_Error error = CJSON_Lexer_tokenize(&lexer, &tokens, &counters);
+        error = CJSON_Lexer_next(&lexer, &token);
         if(error == CJSON_LEXER_ERROR_TOKEN) {
             parser->error = CJSON_ERROR_TOKEN;
-            break;
+            return NULL;
         }
-        if(error == CJSON_LEXER_ERROR_MEMORY) {
-            parser->error = CJSON_ERROR_MEMORY;
-            break;
+
+        if(!CJSON_Builder_push(builder, parser, data, &token)) {
+            return NULL;
         }
+    } while(error != CJSON_LEXER_ERROR_DONE);
+
+    return json;
+}
+
+static struct CJSON *CJSON_parse_single_pass(struct CJSON_Parser *const parser, const char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(data != NULL);
+
+    struct CJSON_Builder builder;
+    CJSON_Builder_init(&builder);
+
+    struct CJSON *const json = CJSON_build(parser, &builder, data, length);
+
+    CJSON_Builder_free(&builder);
+    if(parser->error != CJSON_ERROR_NONE) {
+        CJSON_Parser_free(parser);
+        return NULL;
+    }
+
+    return json;
+}
+
+//the token buffer is given by the caller so CJSON_parse_many can reuse it between records
+static struct CJSON *CJSON_parse_tokens(struct CJSON_Parser *const parser, struct CJSON_Tokens *const tokens, const char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(tokens != NULL);
+    assert(data != NULL);
+
+    struct CJSON_Counters counters;
+    CJSON_Counters_init(&counters);
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, data, length);
+
+    const enum CJSON_Lexer_Error error = CJSON_Lexer_tokenize(&lexer, tokens, &counters);
+    if(error == CJSON_LEXER_ERROR_TOKEN) {
+        parser->error = CJSON_ERROR_TOKEN;
+        return NULL;
+    }
+    if(error == CJSON_LEXER_ERROR_MEMORY) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    if(!CJSON_Parser_reserve(parser, &counters)) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    struct CJSON *const json = CJSON_Parser_new_json(parser);
+    if(json == NULL) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    if(!CJSON_parse_token(parser, json, tokens)) {
+        return NULL;
+    }
+
+    return json;
+}
+
+EXTERN_C struct CJSON *CJSON_parse(struct CJSON_Parser *const parser, const char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(length > 0U);
+
+    //the keys of the shape can point into the input of the last document
+    parser->error = CJSON_ERROR_NONE;
+    CJSON_Parser_forget_shape(parser);
+
+    if((parser->options & CJSON_PARSER_OPTION_SINGLE_PASS) != 0U) {
+        return CJSON_parse_single_pass(parser, data, length);
+    }
+
+    struct CJSON_Tokens tokens;
+    CJSON_Tokens_init(&tokens);
+    if(!CJSON_Tokens_reserve(&tokens, length / 4U)) {
+        parser->error = CJSON_ERROR_MEMORY;
+        return NULL;
+    }
+
+    struct CJSON *const json = CJSON_parse_tokens(parser, &tokens, data, length);
+
+    CJSON_Tokens_free(&tokens);
+    if(parser->error != CJSON_ERROR_NONE) {
+        CJSON_Parser_free(parser);
+        return NULL;
+    }
+    return json;
+}
 
-        const unsigned arena_sizes[] = {
-            counters.object_elements * (unsigned)sizeof(struct CJSON_KV),
-            counters.array_elements  * (unsigned)sizeof(struct CJSON),
-            counters.chars           * (unsigned)sizeof(char),
-            CJSON_DEFAULT_ARENA_SIZE
-        };
-
-        if(parser->object_arena.head != NULL) {
-            if(!CJSON_reserve_arenas(parser, arena_sizes)) {
-                parser->error = CJSON_ERROR_MEMORY;
-                break;
-            }
-        } else if(!CJSON_init_arenas(parser, arena_sizes)) {
+EXTERN_C struct CJSON *CJSON_parse_record(
+    struct CJSON_Parser *const parser,
+    struct CJSON_Tokens *const tokens,
+    struct CJSON_Builder *const builder,
+    const char *const data,
+    const unsigned length
+) {
+    assert(parser != NULL);
+    assert(tokens != NULL);
+    assert(builder != NULL);
+    assert(data != NULL);
+
+    parser->error = CJSON_ERROR_NONE;
+
+    struct CJSON *json;
+    if((parser->options & CJSON_PARSER_OPTION_SINGLE_PASS) != 0U) {
+        json = CJSON_build(parser, builder, data, length);
+    } else {
+        CJSON_Tokens_reset(tokens);
+        if(!CJSON_Tokens_reserve(tokens, length / 4U)) {
             parser->error = CJSON_ERROR_MEMORY;
-            break;
+            return NULL;
         }
+        json = CJSON_parse_tokens(parser, tokens, data, length);
+    }
 
-        json = CJSON_Parser_new_json(parser);
-        if(json == NULL) {
-            parser->error = CJSON_ERROR_MEMORY;
-            break;
+    return parser->error == CJSON_ERROR_NONE ? json : NULL;
+}
+
+EXTERN_C bool CJSON_parse_many(
+    struct CJSON_Parser *const parser,
+    const char *const data,
+    const unsigned length,
+    bool (*const callback)(void *context, struct CJSON_Parser*, struct CJSON *json, unsigned line),
+    void *const context
+) {
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(callback != NULL);
+
+    struct CJSON_Tokens tokens;
+    CJSON_Tokens_init(&tokens);
+
+    struct CJSON_Builder builder;
+    CJSON_Builder_init(&builder);
+
+    bool     success  = true;
+    unsigned position = 0U,
+             line     = 0U;
+    while(position < length) {
+        //a raw newline is not allowed in a JSON string so every newline ends a record,
+        //a broken record can't swallow the ones after it. No string state is needed to find them so the indexer
+        //is not used, memchr already scans a word or a vector at a time in the C libraries
+        const char *const newline = (const char*)memchr(data + position, '\n', (size_t)(length - position));
+        const unsigned    end     = newline == NULL ? length : (unsigned)(newline - data);
+        const char *const record  = data + position;
+        const unsigned    size    = end - position;
+
+        line++;
+        position = newline == NULL ? length : end + 1U;
+
+        if(CJSON_is_blank(record, size)) {
+            continue;
         }
 
-        if(!CJSON_parse_token(parser, json, &tokens)) {
-            //remove the last CJSON allocated from the arena here
-            json = NULL;
+        //the arenas and the token buffer of the previous record are reused
+        CJSON_Parser_reset(parser);
+        struct CJSON *const json = CJSON_parse_record(parser, &tokens, &builder, record, size);
+
+        if(!callback(context, parser, json, line)) {
+            parser->error = CJSON_ERROR_HANDLER;
+            success = false;
             break;
         }
-    } while(0);
+    }
 
-    CJSON_Tokens_free(&tokens);
-    if(parser->error != CJSON_ERROR_NONE) {
-        CJSON_Parser_free(parser);
+    if(success) {
+        parser->error = CJSON_ERROR_NONE;
     }
+    CJSON_Builder_free(&builder);
+    CJSON_Tokens_free(&tokens);
+    return success;
+}
+
+EXTERN_C struct CJSON *CJSON_parse_insitu(struct CJSON_Parser *const parser, char *const data, const unsigned length) {
+    assert(parser != NULL);
+    assert(data != NULL);
+    assert(length > 0U);
+
+    parser->insitu = data;
+    struct CJSON *const json = CJSON_parse(parser, data, length);
+    parser->insitu = NULL;
+
     return json;
 }
 
@@ -601,20 +597,15 @@ EXTERN_C struct CJSON *CJSON_parse_file(struct CJSON_Parser *const parser, const
     assert(path != NULL);
     assert(path[0] != '\0');
 
+    //the file is read in the string arena so it lives as long as the strings parsed in situ in it
     struct CJSON_FileContents file_contents;
-    CJSON_FileContents_init(&file_contents);
-
-    const enum CJSON_FileContents_Error error = CJSON_FileContents_get(&file_contents, path);  
+    const enum CJSON_FileContents_Error error = CJSON_FileContents_get_in_arena(&file_contents, path, &parser->string_arena);
     if(error != CJSON_FILECONTENTS_ERROR_NONE) {
         parser->error = CJSON_ERROR_FILE;
         return NULL;
     }
 
-    struct CJSON *const json = CJSON_parse(parser, (const char*)file_contents.data, file_contents.size);
-
-    CJSON_FileContents_free(&file_contents);
-    
-    return json;
+    return CJSON_parse_insitu(parser, (char*)file_contents.data, file_contents.size);
 }
 
 EXTERN_C struct CJSON *CJSON_new(struct CJSON_Parser *const parser) {
@@ -624,7 +615,7 @@ EXTERN_C struct CJSON *CJSON_new(struct CJSON_Parser *const parser) {
 
     struct CJSON *json = NULL;
     do {
-        if(parser->object_arena.head != NULL 
+        if(parser->object_arena.head == NULL 
             && !CJSON_init_arenas(parser, arena_default_sizes)
         ) {
             parser->error = CJSON_ERROR_MEMORY;
@@ -681,6 +672,10 @@ EXTERN_C const char *CJSON_get_error(const struct CJSON_Parser *const parser) {
         return "Failed to open file.";
     case CJSON_ERROR_MEMORY:
         return "Failed to allocate memory.";
+    case CJSON_ERROR_HANDLER:
+        return "Stopped by the handler.";
+    case CJSON_ERROR_DEPTH:
+        return "Too deeply nested.";
     }
 
     return NULL;
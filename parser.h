@@ -9,19 +9,79 @@ extern "C" {
 #include "json.h"
 #include "tokens.h"
 #include "allocator.h"
+#include "symbols.h"
+
+//the most nested arrays and objects a document can have by default
+#define CJSON_PARSER_DEFAULT_MAX_DEPTH 1024U
+
+struct CJSON_Builder;
+
+enum CJSON_Parser_Option {
+    CJSON_PARSER_OPTION_NONE        = 0,
+    //build the DOM straight from the input without a token buffer
+    CJSON_PARSER_OPTION_SINGLE_PASS = 1 << 0,
+    //strings without escapes point into the input instead of being copied, the input must outlive the DOM
+    CJSON_PARSER_OPTION_ZERO_COPY   = 1 << 1,
+    //numbers keep their lexeme and are decoded on access, the input must outlive the DOM.
+    //only the grammar of a number is checked while parsing, a number out of range like 1e400 makes the accessors fail
+    CJSON_PARSER_OPTION_LAZY_NUMBERS = 1 << 2
+};
+
 struct CJSON_Parser {
-    enum   CJSON_Error error;
-    struct CJSON_Arena array_arena,
-                       object_arena,
-                       string_arena,
-                       json_arena;
+    enum   CJSON_Error   error;
+    unsigned             options,
+                         max_depth; //deeper documents fail with CJSON_ERROR_DEPTH, the containers are never parsed recursively
+    char                *insitu; //the input being parsed by CJSON_parse_insitu, NULL otherwise
+    struct CJSON_Arena   array_arena,
+                         object_arena,
+                         string_arena,
+                         json_arena;
+    struct CJSON_Symbols symbols; //the object keys, kept by CJSON_Parser_reset
+    //the keys shared by the objects being parsed and the last object parsed with its own entries, see CJSON_Object_finish
+    const struct CJSON_Shape *shape;
+    struct CJSON_Object       last_object;
 };
 
 void          CJSON_Parser_init(struct CJSON_Parser*);
 void          CJSON_Parser_free(struct CJSON_Parser*);
+//keeps the memory of the arenas for the next parse, the CJSON parsed before become invalid.
+//the interned object keys are kept as well
+void          CJSON_Parser_reset(struct CJSON_Parser*);
+//the key interned in the parser, it's valid until CJSON_Parser_free and matches the keys of the parsed objects by address.
+//a key past the limits of the symbol table (or if memory allocation fails) is not copied
+struct CJSON_Key CJSON_Parser_key(struct CJSON_Parser*, const char *chars, unsigned length);
 struct CJSON *CJSON_new        (struct CJSON_Parser*);
 struct CJSON *CJSON_parse      (struct CJSON_Parser*, const char *data, unsigned length);
+struct CJSON *CJSON_parse_insitu(struct CJSON_Parser*, char *data, unsigned length);
 struct CJSON *CJSON_parse_file (struct CJSON_Parser*, const char *path);
+//parses every line of newline delimited JSON, blank lines are skipped. The callback gets NULL and the parser error
+//for a record that failed, the record is only valid during the callback. Returning false stops with CJSON_ERROR_HANDLER
+bool          CJSON_parse_many (
+    struct CJSON_Parser*,
+    const char *data,
+    unsigned length,
+    bool (*callback)(void *context, struct CJSON_Parser*, struct CJSON *json, unsigned line),
+    void *context
+);
+//reserves the arenas for the values counted by the lexer
+bool          CJSON_Parser_reserve(struct CJSON_Parser*, const struct CJSON_Counters*);
+//moves the arenas of the other parser in this one, the CJSON parsed by the other one are then owned by this one
+void          CJSON_Parser_merge  (struct CJSON_Parser*, struct CJSON_Parser *other);
+//parses the value at tokens->current_token, the parser is not freed on error
+bool          CJSON_parse_token   (struct CJSON_Parser*, struct CJSON*, struct CJSON_Tokens*);
+//parses count values or members separated by commas from tokens->current_token, the token after the last one is left to the caller.
+//the members are not inserted in an object, used to build the root of a document on several threads
+bool          CJSON_parse_array_range (struct CJSON_Parser*, struct CJSON *values, unsigned count, struct CJSON_Tokens*);
+bool          CJSON_parse_object_range(struct CJSON_Parser*, struct CJSON_KV *entries, unsigned count, struct CJSON_Tokens*);
+//parses one record in the arenas without resetting them, the parser is not freed on error.
+//the token buffer and the builder are reused from one record to the next
+struct CJSON *CJSON_parse_record(
+    struct CJSON_Parser*,
+    struct CJSON_Tokens*,
+    struct CJSON_Builder*,
+    const char *data,
+    unsigned length
+);
 
 const char *CJSON_get_error(const struct CJSON_Parser*);
 
@@ -0,0 +1,274 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "reader.h"
+#include "parser.h"
+#include "file.h"
+#include "allocator.h"
+#include "util.h"
+
+static bool CJSON_ArrayReader_fail(struct CJSON_ArrayReader *const reader, const enum CJSON_Error error) {
+    assert(reader != NULL);
+
+    reader->parser->error = error;
+    reader->is_done       = true;
+    return false;
+}
+
+//moves the bytes not parsed yet to the start of the buffer and reads the next block after them
+static bool CJSON_ArrayReader_fill(struct CJSON_ArrayReader *const reader) {
+    assert(reader != NULL);
+
+    if(reader->is_end_of_file) {
+        return false;
+    }
+
+    const unsigned remaining = reader->length - reader->position;
+    if(reader->position > 0U) {
+        memmove(reader->buffer, reader->buffer + reader->position, (size_t)remaining);
+        reader->position = 0U;
+        reader->length   = remaining;
+    }
+
+    if(reader->capacity - reader->length < CJSON_ARRAYREADER_BLOCK_SIZE) {
+        if(reader->length > UINT_MAX - CJSON_ARRAYREADER_BLOCK_SIZE) {
+            return CJSON_ArrayReader_fail(reader, CJSON_ERROR_MEMORY);
+        }
+
+        bool success;
+        unsigned capacity = CJSON_safe_unsigned_mult(reader->capacity, 2U, &success);
+        if(!success || capacity < reader->length + CJSON_ARRAYREADER_BLOCK_SIZE) {
+            capacity = reader->length + CJSON_ARRAYREADER_BLOCK_SIZE;
+        }
+
+        char *const buffer = (char*)CJSON_REALLOC(reader->buffer, (size_t)capacity);
+        if(buffer == NULL) {
+            return CJSON_ArrayReader_fail(reader, CJSON_ERROR_MEMORY);
+        }
+
+        reader->buffer   = buffer;
+        reader->capacity = capacity;
+    }
+
+    const size_t size = fread(reader->buffer + reader->length, 1U, CJSON_ARRAYREADER_BLOCK_SIZE, reader->file);
+    if(size < (size_t)CJSON_ARRAYREADER_BLOCK_SIZE) {
+        if(ferror(reader->file)) {
+            return CJSON_ArrayReader_fail(reader, CJSON_ERROR_FILE);
+        }
+        reader->is_end_of_file = true;
+    }
+    reader->length += (unsigned)size;
+
+    return size > 0U;
+}
+
+//the next byte that is not whitespace, false at the end of the file
+static bool CJSON_ArrayReader_peek(struct CJSON_ArrayReader *const reader, char *const c) {
+    assert(reader != NULL);
+    assert(c != NULL);
+
+    while(true) {
+        while(reader->position < reader->length && CJSON_is_whitespace(reader->buffer[reader->position])) {
+            reader->position++;
+        }
+
+        if(reader->position < reader->length) {
+            *c = reader->buffer[reader->position];
+            return true;
+        }
+
+        if(!CJSON_ArrayReader_fill(reader)) {
+            return false;
+        }
+    }
+}
+
+//the length of the element starting at position, containers are delimited by matching their brackets
+//and scalars end at the next delimiter. The element itself is validated by CJSON_parse
+static bool CJSON_ArrayReader_find_element(struct CJSON_ArrayReader *const reader, unsigned *const length) {
+    assert(reader != NULL);
+    assert(length != NULL);
+    assert(reader->position < reader->length);
+
+    const char first     = reader->buffer[reader->position];
+    const bool is_string = first == '"';
+    const bool is_scalar = !is_string && first != '[' && first != '{';
+
+    unsigned offset     = 1U;
+    unsigned depth      = is_scalar || is_string ? 0U : 1U;
+    bool     in_string  = is_string,
+             is_escaped = false;
+
+    while(true) {
+        if(reader->position + offset >= reader->length) {
+            if(!CJSON_ArrayReader_fill(reader)) {
+                if(reader->parser->error != CJSON_ERROR_NONE) {
+                    return false;
+                }
+                if(is_scalar) {
+                    *length = offset;
+                    return true;
+                }
+                return CJSON_ArrayReader_fail(reader, CJSON_ERROR_ARRAY);
+            }
+            continue;
+        }
+
+        const char c = reader->buffer[reader->position + offset];
+        if(in_string) {
+            offset++;
+            if(is_escaped) {
+                is_escaped = false;
+            } else if(c == '\\') {
+                is_escaped = true;
+            } else if(c == '"') {
+                in_string = false;
+                if(is_string) {
+                    *length = offset;
+                    return true;
+                }
+            }
+            continue;
+        }
+
+        if(is_scalar) {
+            if(CJSON_is_delimiter(c) || CJSON_is_whitespace(c) || c == '"') {
+                *length = offset;
+                return true;
+            }
+            offset++;
+            continue;
+        }
+
+        offset++;
+        switch(c) {
+        case '"':
+            in_string = true;
+            break;
+        case '[':
+        case '{':
+            depth++;
+            break;
+        case ']':
+        case '}':
+            if(--depth == 0U) {
+                *length = offset;
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+EXTERN_C bool CJSON_ArrayReader_open(struct CJSON_ArrayReader *const reader, struct CJSON_Parser *const parser, const char *const path) {
+    assert(reader != NULL);
+    assert(parser != NULL);
+    assert(path != NULL);
+
+    reader->parser         = parser;
+    reader->file           = NULL;
+    reader->buffer         = NULL;
+    reader->length         = 0U;
+    reader->position       = 0U;
+    reader->capacity       = 0U;
+    reader->is_first       = true;
+    reader->is_end_of_file = false;
+    reader->is_done        = false;
+    parser->error          = CJSON_ERROR_NONE;
+
+    if(CJSON_FileContents_open(&reader->file, path) != CJSON_FILECONTENTS_ERROR_NONE) {
+        return CJSON_ArrayReader_fail(reader, CJSON_ERROR_FILE);
+    }
+
+    char c;
+    if(!CJSON_ArrayReader_peek(reader, &c) || c != '[') {
+        if(parser->error == CJSON_ERROR_NONE) {
+            CJSON_ArrayReader_fail(reader, CJSON_ERROR_TOKEN);
+        }
+        CJSON_ArrayReader_close(reader);
+        return false;
+    }
+    reader->position++;
+
+    return true;
+}
+
+EXTERN_C void CJSON_ArrayReader_close(struct CJSON_ArrayReader *const reader) {
+    assert(reader != NULL);
+
+    if(reader->file != NULL) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+    CJSON_FREE(reader->buffer);
+    reader->buffer   = NULL;
+    reader->length   = 0U;
+    reader->position = 0U;
+    reader->capacity = 0U;
+    reader->is_done  = true;
+}
+
+EXTERN_C struct CJSON *CJSON_ArrayReader_next(struct CJSON_ArrayReader *const reader) {
+    assert(reader != NULL);
+
+    if(reader->is_done) {
+        return NULL;
+    }
+
+    //the memory of the previous element is reused
+    CJSON_Parser_reset(reader->parser);
+
+    char c;
+    if(!CJSON_ArrayReader_peek(reader, &c)) {
+        if(reader->parser->error == CJSON_ERROR_NONE) {
+            CJSON_ArrayReader_fail(reader, CJSON_ERROR_ARRAY);
+        }
+        return NULL;
+    }
+
+    if(!reader->is_first) {
+        if(c == ']') {
+            reader->is_done = true;
+            return NULL;
+        }
+        if(c != ',') {
+            CJSON_ArrayReader_fail(reader, CJSON_ERROR_MISSING_COMMA_OR_RBRACKET);
+            return NULL;
+        }
+        reader->position++;
+
+        if(!CJSON_ArrayReader_peek(reader, &c)) {
+            if(reader->parser->error == CJSON_ERROR_NONE) {
+                CJSON_ArrayReader_fail(reader, CJSON_ERROR_ARRAY);
+            }
+            return NULL;
+        }
+    } else if(c == ']') {
+        reader->is_done = true;
+        return NULL;
+    }
+
+    if(c == ']' || c == ',') {
+        CJSON_ArrayReader_fail(reader, CJSON_ERROR_ARRAY_VALUE);
+        return NULL;
+    }
+    reader->is_first = false;
+
+    unsigned length;
+    if(!CJSON_ArrayReader_find_element(reader, &length)) {
+        return NULL;
+    }
+
+    struct CJSON *const json = CJSON_parse(reader->parser, reader->buffer + reader->position, length);
+    if(json == NULL) {
+        reader->is_done = true;
+        return NULL;
+    }
+    reader->position += length;
+
+    return json;
+}
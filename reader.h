@@ -0,0 +1,39 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_READER_H
+#define CJSON_READER_H
+
+#define CJSON_ARRAYREADER_BLOCK_SIZE (1U << 16)
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "json.h"
+
+struct CJSON_Parser;
+
+//reads the elements of a file made of one top level array one at a time.
+//the file is read in blocks and the buffer only has to hold the current element
+struct CJSON_ArrayReader {
+    struct CJSON_Parser *parser;
+    FILE                *file;
+    char                *buffer;
+    unsigned             length,   //bytes read in the buffer
+                         position, //first byte of the buffer not parsed yet
+                         capacity;
+    bool                 is_first,
+                         is_end_of_file,
+                         is_done;
+};
+
+bool          CJSON_ArrayReader_open (struct CJSON_ArrayReader*, struct CJSON_Parser*, const char *path);
+void          CJSON_ArrayReader_close(struct CJSON_ArrayReader*);
+//the element stays valid until the next call, NULL at the end of the array or on error (the parser error is set)
+struct CJSON *CJSON_ArrayReader_next (struct CJSON_ArrayReader*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
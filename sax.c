@@ -0,0 +1,237 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sax.h"
+#include "lexer.h"
+#include "walker.h"
+#include "decoder.h"
+#include "number.h"
+#include "allocator.h"
+#include "util.h"
+
+#define CJSON_SAX_MINIMUM_CAPACITY 64U
+
+//the values go to the handler from the callbacks of the walker instead of a DOM
+struct CJSON_Sax {
+    const struct CJSON_Handler *handler;
+    void                       *context;
+    const char                 *data;      //the input the offsets of the tokens point into
+    char                       *scratch;   //escaped strings are decoded here
+    unsigned                    scratch_capacity;
+    enum CJSON_Error            error;
+};
+
+static bool CJSON_Sax_call(struct CJSON_Sax *const sax, const bool success) {
+    assert(sax != NULL);
+
+    if(!success) {
+        sax->error = CJSON_ERROR_HANDLER;
+    }
+
+    return success;
+}
+
+//raw strings are given straight from the input, the others are decoded in the scratch buffer
+static bool CJSON_Sax_decode_string(struct CJSON_Sax *const sax, const struct CJSON_Token *const token, const char **const chars, unsigned *const length) {
+    assert(sax != NULL);
+    assert(token != NULL);
+    assert(token->length >= 2U);
+    assert(chars != NULL);
+    assert(length != NULL);
+
+    const char *const raw        = sax->data + token->offset + 1;
+    const unsigned    raw_length = CJSON_Token_length(token, sax->data) - 2U;
+
+    if(CJSON_is_raw_string(raw, raw_length)) {
+        *chars  = raw;
+        *length = raw_length;
+        return true;
+    }
+
+    if(raw_length > sax->scratch_capacity) {
+        const unsigned capacity = MAX(raw_length, CJSON_SAX_MINIMUM_CAPACITY);
+        char *const scratch = (char*)CJSON_REALLOC(sax->scratch, (size_t)capacity);
+        if(scratch == NULL) {
+            sax->error = CJSON_ERROR_MEMORY;
+            return false;
+        }
+
+        sax->scratch          = scratch;
+        sax->scratch_capacity = capacity;
+    }
+
+    if(!CJSON_unescape(sax->scratch, raw, raw_length, length)) {
+        return false;
+    }
+    *chars = sax->scratch;
+
+    return true;
+}
+
+static bool CJSON_Sax_number(struct CJSON_Sax *const sax, const struct CJSON_Token *const token) {
+    assert(sax != NULL);
+    assert(token != NULL);
+
+    const struct CJSON_Handler *const handler = sax->handler;
+
+    struct CJSON number;
+    const enum CJSON_Error error = CJSON_Number_decode(sax->data + token->offset, token->length, &number);
+    if(error != CJSON_ERROR_NONE) {
+        sax->error = error;
+        return false;
+    }
+
+    switch(number.type) {
+    case CJSON_INT64:
+        return handler->int64 == NULL || CJSON_Sax_call(sax, handler->int64(sax->context, number.value.int64));
+    case CJSON_UINT64:
+        return handler->uint64 == NULL || CJSON_Sax_call(sax, handler->uint64(sax->context, number.value.uint64));
+    default:
+        assert(number.type == CJSON_FLOAT64);
+        return handler->float64 == NULL || CJSON_Sax_call(sax, handler->float64(sax->context, number.value.float64));
+    }
+}
+
+static bool CJSON_Sax_scalar(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Sax *const sax = (struct CJSON_Sax*)context;
+    assert(sax != NULL);
+    assert(token != NULL);
+    (void)value;
+
+    const struct CJSON_Handler *const handler = sax->handler;
+
+    switch(token->type) {
+    case CJSON_TOKEN_STRING: {
+        const char *chars;
+        unsigned    length;
+        if(!CJSON_Sax_decode_string(sax, token, &chars, &length)) {
+            if(sax->error == CJSON_ERROR_NONE) {
+                sax->error = CJSON_ERROR_STRING;
+            }
+            return false;
+        }
+        return handler->string == NULL || CJSON_Sax_call(sax, handler->string(sax->context, chars, length));
+    }
+
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT:
+        return CJSON_Sax_number(sax, token);
+
+    case CJSON_TOKEN_BOOL:
+        return handler->boolean == NULL || CJSON_Sax_call(sax, handler->boolean(sax->context, sax->data[token->offset] == 't'));
+
+    default:
+        assert(token->type == CJSON_TOKEN_NULL);
+        return handler->null == NULL || CJSON_Sax_call(sax, handler->null(sax->context));
+    }
+}
+
+//nothing is built so the containers and their elements are all the state
+static void *CJSON_Sax_open(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Sax *const sax = (struct CJSON_Sax*)context;
+    assert(sax != NULL);
+    assert(token != NULL);
+    (void)value;
+
+    const struct CJSON_Handler *const handler = sax->handler;
+    const bool success = token->type == CJSON_TOKEN_LBRACKET
+        ? handler->start_array  == NULL || CJSON_Sax_call(sax, handler->start_array(sax->context))
+        : handler->start_object == NULL || CJSON_Sax_call(sax, handler->start_object(sax->context));
+
+    return success ? sax : NULL;
+}
+
+static void *CJSON_Sax_element(void *const context, void *const container, const struct CJSON_Token *const key) {
+    struct CJSON_Sax *const sax = (struct CJSON_Sax*)context;
+    assert(sax != NULL);
+    assert(container != NULL);
+
+    if(key == NULL) {
+        return container;
+    }
+
+    const char *chars;
+    unsigned    length;
+    if(!CJSON_Sax_decode_string(sax, key, &chars, &length)) {
+        if(sax->error == CJSON_ERROR_NONE) {
+            sax->error = CJSON_ERROR_OBJECT_KEY;
+        }
+        return NULL;
+    }
+
+    return sax->handler->key == NULL || CJSON_Sax_call(sax, sax->handler->key(sax->context, chars, length)) ? container : NULL;
+}
+
+static bool CJSON_Sax_close(void *const context, void *const container, const struct CJSON_Token *const token) {
+    struct CJSON_Sax *const sax = (struct CJSON_Sax*)context;
+    assert(sax != NULL);
+    assert(token != NULL);
+    (void)container;
+
+    const struct CJSON_Handler *const handler = sax->handler;
+    return token->type == CJSON_TOKEN_RBRACKET
+        ? handler->end_array  == NULL || CJSON_Sax_call(sax, handler->end_array(sax->context))
+        : handler->end_object == NULL || CJSON_Sax_call(sax, handler->end_object(sax->context));
+}
+
+static void CJSON_Sax_walk(struct CJSON_Sax *const sax, struct CJSON_Tokens *const tokens, const unsigned length) {
+    assert(sax != NULL);
+    assert(tokens != NULL);
+
+    struct CJSON_Counters counters;
+    CJSON_Counters_init(&counters);
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, sax->data, length);
+
+    const enum CJSON_Lexer_Error error = CJSON_Lexer_tokenize(&lexer, tokens, &counters);
+    if(error == CJSON_LEXER_ERROR_TOKEN) {
+        sax->error = CJSON_ERROR_TOKEN;
+        return;
+    }
+    if(error == CJSON_LEXER_ERROR_MEMORY) {
+        sax->error = CJSON_ERROR_MEMORY;
+        return;
+    }
+
+    struct CJSON_Walker walker;
+    walker.open      = CJSON_Sax_open;
+    walker.element   = CJSON_Sax_element;
+    walker.scalar    = CJSON_Sax_scalar;
+    walker.close     = CJSON_Sax_close;
+    walker.context   = sax;
+    walker.error     = &sax->error;
+    walker.max_depth = UINT_MAX;
+
+    CJSON_walk(&walker, sax, tokens);
+}
+
+EXTERN_C enum CJSON_Error CJSON_parse_sax(const char *const data, const unsigned length, const struct CJSON_Handler *const handler, void *const context) {
+    assert(data != NULL);
+    assert(length > 0U);
+    assert(handler != NULL);
+
+    struct CJSON_Sax sax;
+    sax.handler          = handler;
+    sax.context          = context;
+    sax.data             = data;
+    sax.scratch          = NULL;
+    sax.scratch_capacity = 0U;
+    sax.error            = CJSON_ERROR_NONE;
+
+    struct CJSON_Tokens tokens;
+    CJSON_Tokens_init(&tokens);
+    if(!CJSON_Tokens_reserve(&tokens, length / 4U)) {
+        return CJSON_ERROR_MEMORY;
+    }
+
+    CJSON_Sax_walk(&sax, &tokens, length);
+
+    CJSON_Tokens_free(&tokens);
+    CJSON_FREE(sax.scratch);
+
+    return sax.error;
+}
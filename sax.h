@@ -0,0 +1,34 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_SAX_H
+#define CJSON_SAX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "json.h"
+
+//the callbacks can be NULL, returning false stops the parsing with CJSON_ERROR_HANDLER.
+//keys and strings are not NUL terminated and are only valid during the callback
+struct CJSON_Handler {
+    bool (*start_object)(void *context);
+    bool (*end_object)  (void *context);
+    bool (*start_array) (void *context);
+    bool (*end_array)   (void *context);
+    bool (*key)         (void *context, const char *chars, unsigned length);
+    bool (*string)      (void *context, const char *chars, unsigned length);
+    bool (*int64)       (void *context, int64_t value);
+    bool (*uint64)      (void *context, uint64_t value);
+    bool (*float64)     (void *context, double value);
+    bool (*boolean)     (void *context, bool value);
+    bool (*null)        (void *context);
+};
+
+enum CJSON_Error CJSON_parse_sax(const char *data, unsigned length, const struct CJSON_Handler*, void *context);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,307 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "stream.h"
+#include "parser.h"
+#include "lexer.h"
+#include "allocator.h"
+#include "util.h"
+
+//the chunks don't outlive CJSON_StreamParser_feed so nothing can point into them
+#define CJSON_STREAM_BORROWING_OPTIONS (CJSON_PARSER_OPTION_ZERO_COPY | CJSON_PARSER_OPTION_LAZY_NUMBERS)
+
+//the end of a number or a keyword
+static bool CJSON_StreamParser_is_word_end(const char c) {
+    return CJSON_is_delimiter(c) || CJSON_is_whitespace(c) || c == '"';
+}
+
+//returns the position of the closing quote, length if the string doesn't end in chars
+static unsigned CJSON_StreamParser_scan_string(const char *const chars, const unsigned length, unsigned position, bool *const is_escaped) {
+    assert(chars != NULL);
+    assert(is_escaped != NULL);
+
+    for(; position < length; position++) {
+        if(*is_escaped) {
+            *is_escaped = false;
+        } else if(chars[position] == '\\') {
+            *is_escaped = true;
+        } else if(chars[position] == '"') {
+            return position;
+        }
+    }
+
+    return length;
+}
+
+//returns the position of the first delimiter, length if there is none
+static unsigned CJSON_StreamParser_scan_word(const char *const chars, const unsigned length, unsigned position) {
+    assert(chars != NULL);
+
+    while(position < length && !CJSON_StreamParser_is_word_end(chars[position])) {
+        position++;
+    }
+
+    return position;
+}
+
+static bool CJSON_StreamParser_fail(struct CJSON_StreamParser *const stream) {
+    assert(stream != NULL);
+    assert(stream->parser->error != CJSON_ERROR_NONE);
+
+    CJSON_Parser_free(stream->parser);
+    CJSON_StreamParser_free(stream);
+    return false;
+}
+
+static bool CJSON_StreamParser_append(struct CJSON_StreamParser *const stream, const char *const chars, const unsigned length) {
+    assert(stream != NULL);
+    assert(chars != NULL);
+
+    if(length > UINT_MAX - stream->carry_length) {
+        stream->parser->error = CJSON_ERROR_MEMORY;
+        return false;
+    }
+
+    bool           success;
+    const unsigned carry_length = stream->carry_length + length;
+
+    if(carry_length > stream->carry_capacity) {
+        unsigned capacity = MAX(stream->carry_capacity, CJSON_STREAM_MINIMUM_CAPACITY);
+        while(capacity < carry_length) {
+            capacity = CJSON_safe_unsigned_mult(capacity, 2U, &success);
+            if(!success) {
+                capacity = carry_length;
+                break;
+            }
+        }
+
+        char *const carry = (char*)CJSON_REALLOC(stream->carry, (size_t)capacity);
+        if(carry == NULL) {
+            stream->parser->error = CJSON_ERROR_MEMORY;
+            return false;
+        }
+
+        stream->carry          = carry;
+        stream->carry_capacity = capacity;
+    }
+
+    memcpy(stream->carry + stream->carry_length, chars, (size_t)length);
+    stream->carry_length = carry_length;
+
+    return true;
+}
+
+static bool CJSON_StreamParser_push(struct CJSON_StreamParser *const stream, const char *const data, const struct CJSON_Token *const token) {
+    assert(stream != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+
+    struct CJSON_Parser *const parser  = stream->parser;
+    const unsigned             options = parser->options;
+
+    parser->options &= ~(unsigned)CJSON_STREAM_BORROWING_OPTIONS;
+    const bool success = CJSON_Builder_push(&stream->builder, parser, data, token);
+    parser->options = options;
+
+    return success;
+}
+
+//the carry holds complete tokens once it's closed by a quote or a delimiter, or when the input ends
+static bool CJSON_StreamParser_push_carry(struct CJSON_StreamParser *const stream) {
+    assert(stream != NULL);
+    assert(stream->carry_length > 0U);
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, stream->carry, stream->carry_length);
+
+    struct CJSON_Token token;
+    while(true) {
+        const enum CJSON_Lexer_Error error = CJSON_Lexer_next(&lexer, &token);
+        if(error == CJSON_LEXER_ERROR_DONE) {
+            break;
+        }
+        if(error != CJSON_LEXER_ERROR_NONE) {
+            stream->parser->error = CJSON_ERROR_TOKEN;
+            return false;
+        }
+        if(!CJSON_StreamParser_push(stream, stream->carry, &token)) {
+            return false;
+        }
+    }
+
+    stream->carry_length = 0U;
+    return true;
+}
+
+//a token is cut if it could continue in the next chunk: a string without its closing quote or a number or keyword touching the end
+static bool CJSON_StreamParser_is_cut(struct CJSON_StreamParser *const stream, const char *const chunk, const unsigned length, const unsigned start, const enum CJSON_Lexer_Error error, const struct CJSON_Token *const token) {
+    assert(stream != NULL);
+    assert(chunk != NULL);
+    assert(token != NULL);
+
+    if(chunk[start] == '"') {
+        if(error == CJSON_LEXER_ERROR_NONE) {
+            return false;
+        }
+
+        bool is_escaped = false;
+        if(CJSON_StreamParser_scan_string(chunk, length, start + 1U, &is_escaped) < length) {
+            return false;
+        }
+
+        stream->is_carry_string = true;
+        stream->is_escaped      = is_escaped;
+        return true;
+    }
+
+    if(CJSON_StreamParser_is_word_end(chunk[start])) {
+        return false;
+    }
+
+    if(error == CJSON_LEXER_ERROR_NONE && start + CJSON_Token_length(token, chunk) < length) {
+        return false;
+    }
+
+    if(CJSON_StreamParser_scan_word(chunk, length, start) < length) {
+        return false;
+    }
+
+    stream->is_carry_string = false;
+    return true;
+}
+
+EXTERN_C void CJSON_StreamParser_init(struct CJSON_StreamParser *const stream, struct CJSON_Parser *const parser) {
+    assert(stream != NULL);
+    assert(parser != NULL);
+
+    stream->parser          = parser;
+    stream->root            = NULL;
+    stream->carry           = NULL;
+    stream->carry_length    = 0U;
+    stream->carry_capacity  = 0U;
+    stream->is_carry_string = false;
+    stream->is_escaped      = false;
+    CJSON_Builder_init(&stream->builder);
+
+    parser->error = CJSON_ERROR_NONE;
+}
+
+EXTERN_C void CJSON_StreamParser_free(struct CJSON_StreamParser *const stream) {
+    assert(stream != NULL);
+
+    CJSON_FREE(stream->carry);
+    stream->carry          = NULL;
+    stream->carry_length   = 0U;
+    stream->carry_capacity = 0U;
+    CJSON_Builder_free(&stream->builder);
+}
+
+EXTERN_C bool CJSON_StreamParser_feed(struct CJSON_StreamParser *const stream, const char *const chunk, const unsigned length) {
+    assert(stream != NULL);
+    assert(chunk != NULL);
+
+    struct CJSON_Parser *const parser = stream->parser;
+    if(parser->error != CJSON_ERROR_NONE) {
+        return false;
+    }
+
+    if(stream->root == NULL) {
+        stream->root = CJSON_new(parser);
+        if(stream->root == NULL) {
+            return false;
+        }
+        CJSON_Builder_reset(&stream->builder, stream->root);
+    }
+
+    if(length == 0U) {
+        return true;
+    }
+
+    unsigned position = 0U;
+    if(stream->carry_length > 0U) {
+        unsigned end = stream->is_carry_string
+            ? CJSON_StreamParser_scan_string(chunk, length, 0U, &stream->is_escaped)
+            : CJSON_StreamParser_scan_word(chunk, length, 0U);
+        const bool is_complete = end < length;
+        if(is_complete && stream->is_carry_string) {
+            end++;
+        }
+
+        if(!CJSON_StreamParser_append(stream, chunk, end)) {
+            return CJSON_StreamParser_fail(stream);
+        }
+        if(!is_complete) {
+            return true;
+        }
+        if(!CJSON_StreamParser_push_carry(stream)) {
+            return CJSON_StreamParser_fail(stream);
+        }
+        position = end;
+    }
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, chunk, length);
+    lexer.position = position;
+
+    struct CJSON_Token token;
+    while(true) {
+        const enum CJSON_Lexer_Error error = CJSON_Lexer_next(&lexer, &token);
+        if(error == CJSON_LEXER_ERROR_DONE) {
+            break;
+        }
+
+        const unsigned start = token.offset;
+        if(CJSON_StreamParser_is_cut(stream, chunk, length, start, error, &token)) {
+            if(!CJSON_StreamParser_append(stream, chunk + start, length - start)) {
+                return CJSON_StreamParser_fail(stream);
+            }
+            break;
+        }
+
+        if(error != CJSON_LEXER_ERROR_NONE) {
+            parser->error = CJSON_ERROR_TOKEN;
+            return CJSON_StreamParser_fail(stream);
+        }
+        if(!CJSON_StreamParser_push(stream, chunk, &token)) {
+            return CJSON_StreamParser_fail(stream);
+        }
+    }
+
+    return true;
+}
+
+EXTERN_C struct CJSON *CJSON_StreamParser_finish(struct CJSON_StreamParser *const stream) {
+    assert(stream != NULL);
+
+    static const char empty[] = "";
+
+    if(stream->parser->error != CJSON_ERROR_NONE) {
+        return NULL;
+    }
+
+    //nothing was fed, like an empty input
+    if(stream->root == NULL) {
+        stream->parser->error = CJSON_ERROR_TOKEN;
+        CJSON_StreamParser_free(stream);
+        return NULL;
+    }
+
+    if(stream->carry_length > 0U && !CJSON_StreamParser_push_carry(stream)) {
+        CJSON_StreamParser_fail(stream);
+        return NULL;
+    }
+
+    struct CJSON_Token done;
+    done.offset = 0U;
+    done.length = 0U;
+    done.type   = CJSON_TOKEN_DONE;
+    if(!CJSON_StreamParser_push(stream, empty, &done)) {
+        CJSON_StreamParser_fail(stream);
+        return NULL;
+    }
+
+    CJSON_StreamParser_free(stream);
+    return stream->root;
+}
@@ -0,0 +1,38 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_STREAM_H
+#define CJSON_STREAM_H
+
+#define CJSON_STREAM_MINIMUM_CAPACITY 64U
+
+#include <stdbool.h>
+#include "json.h"
+#include "builder.h"
+
+struct CJSON_Parser;
+
+//parses a document received in chunks. The DOM is built in the parser as the chunks arrive,
+//a token cut by the end of a chunk is kept in carry until the chunk that completes it
+struct CJSON_StreamParser {
+    struct CJSON_Parser *parser;
+    struct CJSON        *root;
+    char                *carry;
+    struct CJSON_Builder builder;
+    unsigned             carry_length,
+                         carry_capacity;
+    bool                 is_carry_string, //the carry is a string, otherwise a number or a keyword
+                         is_escaped;      //the carry is a string ending with an unfinished escape
+};
+
+void          CJSON_StreamParser_init  (struct CJSON_StreamParser*, struct CJSON_Parser*);
+void          CJSON_StreamParser_free  (struct CJSON_StreamParser*);
+bool          CJSON_StreamParser_feed  (struct CJSON_StreamParser*, const char *chunk, unsigned length);
+struct CJSON *CJSON_StreamParser_finish(struct CJSON_StreamParser*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symbols.h"
+#include "util.h"
+
+static bool CJSON_Symbols_resize(struct CJSON_Symbols *const symbols, const unsigned capacity) {
+    assert(symbols != NULL);
+    assert(capacity > symbols->capacity);
+    assert((capacity & (capacity - 1U)) == 0U);
+
+    struct CJSON_Key *const entries = (struct CJSON_Key*)CJSON_CALLOC((size_t)capacity, sizeof(*entries));
+    if(entries == NULL) {
+        return false;
+    }
+
+    for(unsigned i = 0U; i < symbols->capacity; i++) {
+        const struct CJSON_Key *const entry = symbols->entries + i;
+        if(entry->chars == NULL) {
+            continue;
+        }
+
+        unsigned index = entry->hash & (capacity - 1U);
+        while(entries[index].chars != NULL) {
+            index = (index + 1U) & (capacity - 1U);
+        }
+        entries[index] = *entry;
+    }
+
+    CJSON_FREE(symbols->entries);
+    symbols->entries  = entries;
+    symbols->capacity = capacity;
+
+    return true;
+}
+
+EXTERN_C void CJSON_Symbols_init(struct CJSON_Symbols *const symbols) {
+    assert(symbols != NULL);
+
+    symbols->entries  = NULL;
+    symbols->capacity = 0U;
+    symbols->count    = 0U;
+    CJSON_Arena_init(&symbols->arena, CJSON_ARENA_INFINITE_NODES, "Symbol Arena");
+}
+
+EXTERN_C void CJSON_Symbols_free(struct CJSON_Symbols *const symbols) {
+    assert(symbols != NULL);
+
+    CJSON_FREE(symbols->entries);
+    CJSON_Arena_free(&symbols->arena);
+    CJSON_Symbols_init(symbols);
+}
+
+EXTERN_C const char *CJSON_Symbols_intern(struct CJSON_Symbols *const symbols, const char *const chars, const unsigned length, const unsigned hash) {
+    assert(symbols != NULL);
+    assert(chars != NULL);
+    assert(hash == CJSON_hash(chars, length));
+
+    if(length > CJSON_SYMBOLS_MAXIMUM_LENGTH) {
+        return NULL;
+    }
+
+    //the table is kept at most half full
+    if(symbols->count >= symbols->capacity / 2U) {
+        if(symbols->count == CJSON_SYMBOLS_MAXIMUM_COUNT) {
+            return NULL;
+        }
+
+        if(!CJSON_Symbols_resize(symbols, MAX(symbols->capacity * 2U, CJSON_SYMBOLS_MINIMUM_CAPACITY))) {
+            return NULL;
+        }
+    }
+
+    unsigned index = hash & (symbols->capacity - 1U);
+    for(; symbols->entries[index].chars != NULL; index = (index + 1U) & (symbols->capacity - 1U)) {
+        const struct CJSON_Key *const entry = symbols->entries + index;
+        if(entry->hash == hash && entry->length == length && memcmp(entry->chars, chars, (size_t)length) == 0) {
+            return entry->chars;
+        }
+    }
+
+    char *const copy = CJSON_Arena_strndup(&symbols->arena, chars, length);
+    if(copy == NULL) {
+        return NULL;
+    }
+
+    struct CJSON_Key *const entry = symbols->entries + index;
+    entry->chars  = copy;
+    entry->length = length;
+    entry->hash   = hash;
+    symbols->count++;
+
+    return copy;
+}
+
+EXTERN_C void CJSON_Symbols_merge(struct CJSON_Symbols *const symbols, struct CJSON_Symbols *const other) {
+    assert(symbols != NULL);
+    assert(other != NULL);
+    assert(symbols != other);
+
+    //the keys of the other table stay where they are, this table only takes their memory and interns its own keys
+    CJSON_Arena_merge(&symbols->arena, &other->arena);
+    CJSON_FREE(other->entries);
+    other->entries  = NULL;
+    other->capacity = 0U;
+    other->count    = 0U;
+}
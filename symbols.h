@@ -0,0 +1,38 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_SYMBOLS_H
+#define CJSON_SYMBOLS_H
+
+#define CJSON_SYMBOLS_MINIMUM_CAPACITY 64U
+//past these limits keys are copied like any other string, so a document with unbounded keys can't grow the table forever
+#define CJSON_SYMBOLS_MAXIMUM_COUNT    (1U << 16)
+#define CJSON_SYMBOLS_MAXIMUM_LENGTH   256U
+
+#include <stdbool.h>
+#include "allocator.h"
+#include "object.h"
+
+//the object keys interned by a parser, each distinct key is stored once in the arena and kept across CJSON_Parser_reset.
+//entries is an open addressing table, an entry with NULL chars is empty
+struct CJSON_Symbols {
+    struct CJSON_Key  *entries;
+    unsigned           capacity,
+                       count;
+    struct CJSON_Arena arena;
+};
+
+void        CJSON_Symbols_init  (struct CJSON_Symbols*);
+void        CJSON_Symbols_free  (struct CJSON_Symbols*);
+//the interned copy of the key, hash must be CJSON_hash(chars, length).
+//NULL if the key is past the limits or memory allocation fails
+const char *CJSON_Symbols_intern(struct CJSON_Symbols*, const char *chars, unsigned length, unsigned hash);
+//moves the keys of the other table in this one, the other table is left empty
+void        CJSON_Symbols_merge (struct CJSON_Symbols*, struct CJSON_Symbols *other);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
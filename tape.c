@@ -0,0 +1,805 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <float.h>
+
+#include "tape.h"
+#include "parser.h"
+#include "lexer.h"
+#include "walker.h"
+#include "decoder.h"
+#include "number.h"
+#include "allocator.h"
+#include "util.h"
+
+#define CJSON_TAPE_WORD(TAG, PAYLOAD) (((uint64_t)(TAG) << 56) | (uint64_t)(PAYLOAD))
+#define CJSON_TAPE_TAG(WORD)          ((enum CJSON_Tape_Tag)((WORD) >> 56))
+#define CJSON_TAPE_PAYLOAD(WORD)      ((WORD) & UINT64_C(0xFFFFFFFFFFFFFF))
+#define CJSON_TAPE_END(WORD)          ((unsigned)((WORD) & UINT64_C(0xFFFFFFFF)))
+#define CJSON_TAPE_COUNT(WORD)        ((unsigned)(((WORD) >> 32) & CJSON_TAPE_MAXIMUM_COUNT))
+#define CJSON_TAPE_COUNT_ONE          (UINT64_C(1) << 32)
+//the 32 bits length before the characters of a string
+#define CJSON_TAPE_LENGTH_SIZE        4U
+#define CJSON_TAPE_NUMBER_SIZE        32U
+
+//the words and the strings of the lexed input in one allocation: a token is at most one word except a number that is two,
+//a string is at most its raw length and a NUL, plus its length
+static bool CJSON_Tape_allocate(struct CJSON_Tape *const tape, const struct CJSON_Tokens *const tokens, const struct CJSON_Counters *const counters) {
+    assert(tape != NULL);
+    assert(tokens != NULL);
+    assert(counters != NULL);
+
+    const size_t word_capacity    = (size_t)tokens->count + (size_t)counters->number;
+    const size_t strings_capacity = (size_t)counters->chars + (size_t)counters->string * CJSON_TAPE_LENGTH_SIZE;
+    if(word_capacity > (size_t)UINT_MAX || strings_capacity > (size_t)UINT_MAX) {
+        return false;
+    }
+
+    tape->words = (uint64_t*)CJSON_MALLOC(word_capacity * sizeof(*tape->words) + strings_capacity);
+    if(tape->words == NULL) {
+        return false;
+    }
+    tape->strings = (char*)(tape->words + word_capacity);
+
+    return true;
+}
+
+//the string is unescaped after its length, the word has the offset of the length
+static bool CJSON_Tape_push_string(struct CJSON_Tape *const tape, const enum CJSON_Tape_Tag tag, const char *const data, const struct CJSON_Token *const token) {
+    assert(tape != NULL);
+    assert(data != NULL);
+    assert(token != NULL);
+    assert(token->length >= 2);
+
+    const char *const chars  = data + token->offset + 1;
+    const unsigned    length = CJSON_Token_length(token, data) - 2U;
+    const unsigned    offset = tape->strings_length;
+    char *const       output = tape->strings + offset + CJSON_TAPE_LENGTH_SIZE;
+
+    uint32_t output_length = length;
+    if(CJSON_is_raw_string(chars, length)) {
+        memcpy(output, chars, (size_t)length);
+    } else {
+        unsigned unescaped_length;
+        if(!CJSON_unescape(output, chars, length, &unescaped_length)) {
+            return false;
+        }
+        output_length = unescaped_length;
+    }
+
+    memcpy(tape->strings + offset, &output_length, sizeof(output_length));
+    output[output_length] = '\0';
+
+    tape->strings_length             += CJSON_TAPE_LENGTH_SIZE + output_length + 1U;
+    tape->words[tape->word_count++]   = CJSON_TAPE_WORD(tag, offset);
+
+    return true;
+}
+
+//the words are pushed in the order of the walk, a container is its open word and so is the value of its elements
+struct CJSON_Tape_Walk {
+    struct CJSON_Tape *tape;
+    const char        *data;
+};
+
+static bool CJSON_Tape_push_scalar(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Tape_Walk *const walk = (struct CJSON_Tape_Walk*)context;
+    assert(walk != NULL);
+    assert(token != NULL);
+    (void)value;
+
+    struct CJSON_Tape *const tape = walk->tape;
+
+    switch(token->type) {
+    case CJSON_TOKEN_STRING:
+        if(!CJSON_Tape_push_string(tape, CJSON_TAPE_TAG_STRING, walk->data, token)) {
+            tape->error = CJSON_ERROR_STRING;
+            return false;
+        }
+        break;
+
+    case CJSON_TOKEN_INT:
+    case CJSON_TOKEN_FLOAT:
+    case CJSON_TOKEN_SCIENTIFIC_INT: {
+        struct CJSON number;
+        const enum CJSON_Error error = CJSON_Number_decode(walk->data + token->offset, token->length, &number);
+        if(error != CJSON_ERROR_NONE) {
+            tape->error = error;
+            return false;
+        }
+
+        uint64_t bits;
+        if(number.type == CJSON_FLOAT64) {
+            memcpy(&bits, &number.value.float64, sizeof(bits));
+            tape->words[tape->word_count++] = CJSON_TAPE_WORD(CJSON_TAPE_TAG_FLOAT64, 0U);
+        } else if(number.type == CJSON_INT64) {
+            memcpy(&bits, &number.value.int64, sizeof(bits));
+            tape->words[tape->word_count++] = CJSON_TAPE_WORD(CJSON_TAPE_TAG_INT64, 0U);
+        } else {
+            assert(number.type == CJSON_UINT64);
+            bits = number.value.uint64;
+            tape->words[tape->word_count++] = CJSON_TAPE_WORD(CJSON_TAPE_TAG_UINT64, 0U);
+        }
+        tape->words[tape->word_count++] = bits;
+        break;
+    }
+
+    case CJSON_TOKEN_BOOL:
+        tape->words[tape->word_count++] = CJSON_TAPE_WORD(walk->data[token->offset] == 't' ? CJSON_TAPE_TAG_TRUE : CJSON_TAPE_TAG_FALSE, 0U);
+        break;
+
+    default:
+        assert(token->type == CJSON_TOKEN_NULL);
+        tape->words[tape->word_count++] = CJSON_TAPE_WORD(CJSON_TAPE_TAG_NULL, 0U);
+    }
+
+    return true;
+}
+
+static void *CJSON_Tape_push_open(void *const context, void *const value, const struct CJSON_Token *const token) {
+    struct CJSON_Tape_Walk *const walk = (struct CJSON_Tape_Walk*)context;
+    assert(walk != NULL);
+    assert(token != NULL);
+    (void)value;
+
+    struct CJSON_Tape *const tape = walk->tape;
+    uint64_t *const          open = tape->words + tape->word_count++;
+    *open = CJSON_TAPE_WORD(token->type == CJSON_TOKEN_LCURLY ? CJSON_TAPE_TAG_OBJECT : CJSON_TAPE_TAG_ARRAY, 0U);
+
+    return open;
+}
+
+//counts the next element of an open container and pushes the key of an object member
+static void *CJSON_Tape_push_element(void *const context, void *const container, const struct CJSON_Token *const key) {
+    struct CJSON_Tape_Walk *const walk = (struct CJSON_Tape_Walk*)context;
+    uint64_t *const               open = (uint64_t*)container;
+    assert(walk != NULL);
+    assert(open != NULL);
+
+    if(CJSON_TAPE_COUNT(*open) < CJSON_TAPE_MAXIMUM_COUNT) {
+        *open += CJSON_TAPE_COUNT_ONE;
+    }
+
+    if(key != NULL && !CJSON_Tape_push_string(walk->tape, CJSON_TAPE_TAG_KEY, walk->data, key)) {
+        walk->tape->error = CJSON_ERROR_OBJECT_KEY;
+        return NULL;
+    }
+
+    return open;
+}
+
+//the matching close and the open are linked both ways so a container is skipped in one step
+static bool CJSON_Tape_push_close(void *const context, void *const container, const struct CJSON_Token *const token) {
+    struct CJSON_Tape_Walk *const walk = (struct CJSON_Tape_Walk*)context;
+    uint64_t *const               open = (uint64_t*)container;
+    assert(walk != NULL);
+    assert(open != NULL);
+    assert(token != NULL);
+
+    struct CJSON_Tape *const  tape       = walk->tape;
+    const unsigned            open_index = (unsigned)(open - tape->words);
+    const enum CJSON_Tape_Tag tag        = token->type == CJSON_TOKEN_RCURLY ? CJSON_TAPE_TAG_OBJECT_END : CJSON_TAPE_TAG_ARRAY_END;
+
+    tape->words[tape->word_count++] = CJSON_TAPE_WORD(tag, open_index);
+    *open |= (uint64_t)tape->word_count;
+
+    return true;
+}
+
+static bool CJSON_Tape_push_tokens(struct CJSON_Tape *const tape, struct CJSON_Tokens *const tokens, const char *const data, const unsigned length) {
+    assert(tape != NULL);
+    assert(tokens != NULL);
+    assert(data != NULL);
+
+    struct CJSON_Counters counters;
+    CJSON_Counters_init(&counters);
+
+    struct CJSON_Lexer lexer;
+    CJSON_Lexer_init(&lexer, data, length);
+
+    const enum CJSON_Lexer_Error error = CJSON_Lexer_tokenize(&lexer, tokens, &counters);
+    if(error == CJSON_LEXER_ERROR_TOKEN) {
+        tape->error = CJSON_ERROR_TOKEN;
+        return false;
+    }
+    if(error == CJSON_LEXER_ERROR_MEMORY || !CJSON_Tape_allocate(tape, tokens, &counters)) {
+        tape->error = CJSON_ERROR_MEMORY;
+        return false;
+    }
+
+    struct CJSON_Tape_Walk walk;
+    walk.tape = tape;
+    walk.data = data;
+
+    struct CJSON_Walker walker;
+    walker.open      = CJSON_Tape_push_open;
+    walker.element   = CJSON_Tape_push_element;
+    walker.scalar    = CJSON_Tape_push_scalar;
+    walker.close     = CJSON_Tape_push_close;
+    walker.context   = &walk;
+    walker.error     = &tape->error;
+    walker.max_depth = CJSON_PARSER_DEFAULT_MAX_DEPTH;
+
+    return CJSON_walk(&walker, NULL, tokens);
+}
+
+//the index of the word after the value
+static unsigned CJSON_Tape_skip(const struct CJSON_Tape *const tape, const unsigned index) {
+    assert(tape != NULL);
+    assert(index < tape->word_count);
+
+    switch(CJSON_TAPE_TAG(tape->words[index])) {
+    case CJSON_TAPE_TAG_OBJECT:
+    case CJSON_TAPE_TAG_ARRAY:
+        return CJSON_TAPE_END(tape->words[index]);
+
+    case CJSON_TAPE_TAG_INT64:
+    case CJSON_TAPE_TAG_UINT64:
+    case CJSON_TAPE_TAG_FLOAT64:
+        return index + 2U;
+
+    default:
+        return index + 1U;
+    }
+}
+
+static const char *CJSON_Tape_string(const struct CJSON_Tape *const tape, const unsigned index, unsigned *const length) {
+    assert(tape != NULL);
+    assert(index < tape->word_count);
+    assert(length != NULL);
+
+    const char *const string = tape->strings + CJSON_TAPE_PAYLOAD(tape->words[index]);
+
+    uint32_t string_length;
+    memcpy(&string_length, string, sizeof(string_length));
+    *length = string_length;
+
+    return string + CJSON_TAPE_LENGTH_SIZE;
+}
+
+//the scalar as a CJSON so it's converted by the CJSON_as_ functions
+static struct CJSON CJSON_TapeValue_to_json(const struct CJSON_TapeValue *const value) {
+    assert(value != NULL);
+
+    const uint64_t *const words = value->tape->words + value->index;
+
+    struct CJSON json;
+    json.type       = CJSON_TapeValue_type(value);
+    json.value.null = NULL;
+
+    switch(json.type) {
+    case CJSON_FLOAT64:
+        memcpy(&json.value.float64, words + 1, sizeof(json.value.float64));
+        break;
+
+    case CJSON_INT64:
+        memcpy(&json.value.int64, words + 1, sizeof(json.value.int64));
+        break;
+
+    case CJSON_UINT64:
+        json.value.uint64 = words[1];
+        break;
+
+    case CJSON_BOOL:
+        json.value.boolean = CJSON_TAPE_TAG(*words) == CJSON_TAPE_TAG_TRUE;
+        break;
+
+    default:
+        break;
+    }
+
+    return json;
+}
+
+static char *CJSON_Tape_write(char *const string, unsigned *const size, const char *const chars, const unsigned length) {
+    assert(size != NULL);
+    assert(chars != NULL);
+
+    if(string == NULL) {
+        *size += length;
+        return NULL;
+    }
+
+    memcpy(string, chars, (size_t)length);
+    return string + length;
+}
+
+//the size of the document without the NUL terminator when the string is NULL, the document is written otherwise
+static unsigned CJSON_Tape_serialize(const struct CJSON_Tape *const tape, char *string) {
+    assert(tape != NULL);
+
+    unsigned size       = 0U;
+    bool     needs_comma = false;
+
+    for(unsigned i = 0U; i < tape->word_count; i++) {
+        const enum CJSON_Tape_Tag tag = CJSON_TAPE_TAG(tape->words[i]);
+        const bool is_end = tag == CJSON_TAPE_TAG_OBJECT_END || tag == CJSON_TAPE_TAG_ARRAY_END;
+
+        if(needs_comma && !is_end) {
+            string = CJSON_Tape_write(string, &size, ",", 1U);
+        }
+        needs_comma = !(tag == CJSON_TAPE_TAG_OBJECT || tag == CJSON_TAPE_TAG_ARRAY || tag == CJSON_TAPE_TAG_KEY);
+
+        char     number[CJSON_TAPE_NUMBER_SIZE];
+        int      count = 0;
+        unsigned length;
+
+        switch(tag) {
+        case CJSON_TAPE_TAG_OBJECT:
+        case CJSON_TAPE_TAG_OBJECT_END:
+        case CJSON_TAPE_TAG_ARRAY:
+        case CJSON_TAPE_TAG_ARRAY_END: {
+            const char c = (char)tag;
+            string = CJSON_Tape_write(string, &size, &c, 1U);
+            break;
+        }
+
+        case CJSON_TAPE_TAG_KEY:
+        case CJSON_TAPE_TAG_STRING: {
+            const char *const chars = CJSON_Tape_string(tape, i, &length);
+            string = CJSON_Tape_write(string, &size, "\"", 1U);
+            if(string == NULL) {
+                size += CJSON_escaped_length(chars, length);
+            } else {
+                string = CJSON_escape(string, chars, length);
+            }
+            string = CJSON_Tape_write(string, &size, tag == CJSON_TAPE_TAG_KEY ? "\":" : "\"", tag == CJSON_TAPE_TAG_KEY ? 2U : 1U);
+            break;
+        }
+
+        case CJSON_TAPE_TAG_INT64: {
+            int64_t int64;
+            memcpy(&int64, tape->words + ++i, sizeof(int64));
+            count = snprintf(number, sizeof(number), "%" PRIi64, int64);
+            break;
+        }
+
+        case CJSON_TAPE_TAG_UINT64:
+            count = snprintf(number, sizeof(number), "%" PRIu64, tape->words[++i]);
+            break;
+
+        case CJSON_TAPE_TAG_FLOAT64: {
+            double float64;
+            memcpy(&float64, tape->words + ++i, sizeof(float64));
+            count = snprintf(number, sizeof(number), "%.*g", DBL_PRECISION, float64);
+            break;
+        }
+
+        case CJSON_TAPE_TAG_TRUE:
+            string = CJSON_Tape_write(string, &size, "true", 4U);
+            break;
+
+        case CJSON_TAPE_TAG_FALSE:
+            string = CJSON_Tape_write(string, &size, "false", 5U);
+            break;
+
+        default:
+            assert(tag == CJSON_TAPE_TAG_NULL);
+            string = CJSON_Tape_write(string, &size, "null", 4U);
+        }
+
+        if(count > 0) {
+            assert(count < (int)sizeof(number));
+            string = CJSON_Tape_write(string, &size, number, (unsigned)count);
+        }
+    }
+
+    return size;
+}
+
+EXTERN_C void CJSON_Tape_init(struct CJSON_Tape *const tape) {
+    assert(tape != NULL);
+
+    tape->words          = NULL;
+    tape->strings        = NULL;
+    tape->word_count     = 0U;
+    tape->strings_length = 0U;
+    tape->error          = CJSON_ERROR_NONE;
+}
+
+EXTERN_C void CJSON_Tape_free(struct CJSON_Tape *const tape) {
+    assert(tape != NULL);
+
+    CJSON_FREE(tape->words);
+    CJSON_Tape_init(tape);
+}
+
+EXTERN_C bool CJSON_Tape_parse(struct CJSON_Tape *const tape, const char *const data, const unsigned length) {
+    assert(tape != NULL);
+    assert(data != NULL);
+    assert(length > 0U);
+
+    CJSON_Tape_free(tape);
+
+    struct CJSON_Tokens tokens;
+    CJSON_Tokens_init(&tokens);
+    if(!CJSON_Tokens_reserve(&tokens, length / 4U)) {
+        tape->error = CJSON_ERROR_MEMORY;
+        return false;
+    }
+
+    const bool success = CJSON_Tape_push_tokens(tape, &tokens, data, length);
+
+    CJSON_Tokens_free(&tokens);
+    if(!success) {
+        const enum CJSON_Error error = tape->error;
+        CJSON_Tape_free(tape);
+        tape->error = error;
+        return false;
+    }
+
+    return true;
+}
+
+EXTERN_C bool CJSON_Tape_copy(struct CJSON_Tape *const destination, const struct CJSON_Tape *const source) {
+    assert(destination != NULL);
+    assert(source != NULL);
+    assert(destination != source);
+
+    CJSON_Tape_free(destination);
+
+    if(source->words == NULL) {
+        return true;
+    }
+
+    const size_t words_size = (size_t)source->word_count * sizeof(*source->words);
+
+    destination->words = (uint64_t*)CJSON_MALLOC(words_size + (size_t)source->strings_length);
+    if(destination->words == NULL) {
+        destination->error = CJSON_ERROR_MEMORY;
+        return false;
+    }
+    destination->strings = (char*)(destination->words + source->word_count);
+
+    memcpy(destination->words, source->words, words_size);
+    memcpy(destination->strings, source->strings, (size_t)source->strings_length);
+    destination->word_count     = source->word_count;
+    destination->strings_length = source->strings_length;
+
+    return true;
+}
+
+EXTERN_C char *CJSON_Tape_to_string(const struct CJSON_Tape *const tape) {
+    assert(tape != NULL);
+
+    const unsigned size   = CJSON_Tape_serialize(tape, NULL);
+    char *const    string = (char*)CJSON_MALLOC((size_t)size + 1U);
+    if(string == NULL) {
+        return NULL;
+    }
+
+    CJSON_Tape_serialize(tape, string);
+    string[size] = '\0';
+
+    return string;
+}
+
+EXTERN_C bool CJSON_Tape_root(const struct CJSON_Tape *const tape, struct CJSON_TapeValue *const value) {
+    assert(tape != NULL);
+    assert(value != NULL);
+
+    if(tape->word_count == 0U) {
+        return false;
+    }
+
+    value->tape  = tape;
+    value->index = 0U;
+    return true;
+}
+
+EXTERN_C enum CJSON_Type CJSON_TapeValue_type(const struct CJSON_TapeValue *const value) {
+    assert(value != NULL);
+    assert(value->tape != NULL);
+    assert(value->index < value->tape->word_count);
+
+    switch(CJSON_TAPE_TAG(value->tape->words[value->index])) {
+    case CJSON_TAPE_TAG_OBJECT:
+        return CJSON_OBJECT;
+
+    case CJSON_TAPE_TAG_ARRAY:
+        return CJSON_ARRAY;
+
+    case CJSON_TAPE_TAG_STRING:
+        return CJSON_STRING;
+
+    case CJSON_TAPE_TAG_INT64:
+        return CJSON_INT64;
+
+    case CJSON_TAPE_TAG_UINT64:
+        return CJSON_UINT64;
+
+    case CJSON_TAPE_TAG_FLOAT64:
+        return CJSON_FLOAT64;
+
+    case CJSON_TAPE_TAG_TRUE:
+    case CJSON_TAPE_TAG_FALSE:
+        return CJSON_BOOL;
+
+    default:
+        assert(CJSON_TAPE_TAG(value->tape->words[value->index]) == CJSON_TAPE_TAG_NULL);
+        return CJSON_NULL;
+    }
+}
+
+EXTERN_C unsigned CJSON_TapeValue_length(const struct CJSON_TapeValue *const value) {
+    assert(value != NULL);
+
+    const struct CJSON_Tape *const tape = value->tape;
+    const uint64_t                 word = tape->words[value->index];
+
+    switch(CJSON_TAPE_TAG(word)) {
+    case CJSON_TAPE_TAG_STRING: {
+        unsigned length;
+        CJSON_Tape_string(tape, value->index, &length);
+        return length;
+    }
+
+    case CJSON_TAPE_TAG_OBJECT:
+    case CJSON_TAPE_TAG_ARRAY: {
+        if(CJSON_TAPE_COUNT(word) < CJSON_TAPE_MAXIMUM_COUNT) {
+            return CJSON_TAPE_COUNT(word);
+        }
+
+        const bool     is_object = CJSON_TAPE_TAG(word) == CJSON_TAPE_TAG_OBJECT;
+        const unsigned end       = CJSON_TAPE_END(word) - 1U;
+        unsigned       count     = 0U;
+        for(unsigned i = value->index + 1U; i < end; i = CJSON_Tape_skip(tape, is_object ? i + 1U : i)) {
+            count++;
+        }
+        return count;
+    }
+
+    default:
+        return 0U;
+    }
+}
+
+EXTERN_C bool CJSON_TapeValue_find_field(const struct CJSON_TapeValue *const object, const char *const key, const unsigned key_length, struct CJSON_TapeValue *const value) {
+    assert(object != NULL);
+    assert(key != NULL);
+    assert(value != NULL);
+
+    const struct CJSON_Tape *const tape = object->tape;
+    const uint64_t                 word = tape->words[object->index];
+
+    if(CJSON_TAPE_TAG(word) != CJSON_TAPE_TAG_OBJECT) {
+        return false;
+    }
+
+    const unsigned end = CJSON_TAPE_END(word) - 1U;
+    for(unsigned i = object->index + 1U; i < end; i = CJSON_Tape_skip(tape, i + 1U)) {
+        unsigned          length;
+        const char *const chars = CJSON_Tape_string(tape, i, &length);
+        if(length == key_length && memcmp(chars, key, (size_t)key_length) == 0) {
+            value->tape  = tape;
+            value->index = i + 1U;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+EXTERN_C bool CJSON_TapeValue_at(const struct CJSON_TapeValue *const array, unsigned index, struct CJSON_TapeValue *const value) {
+    assert(array != NULL);
+    assert(value != NULL);
+
+    const struct CJSON_Tape *const tape = array->tape;
+    const uint64_t                 word = tape->words[array->index];
+
+    if(CJSON_TAPE_TAG(word) != CJSON_TAPE_TAG_ARRAY) {
+        return false;
+    }
+
+    const unsigned end = CJSON_TAPE_END(word) - 1U;
+    for(unsigned i = array->index + 1U; i < end; i = CJSON_Tape_skip(tape, i)) {
+        if(index-- == 0U) {
+            value->tape  = tape;
+            value->index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+EXTERN_C bool CJSON_TapeValue_get(const struct CJSON_TapeValue *const tape_value, const char *query, struct CJSON_TapeValue *const value) {
+    assert(tape_value != NULL);
+    assert(query != NULL);
+    assert(value != NULL);
+
+    const enum CJSON_Type type = CJSON_TapeValue_type(tape_value);
+    if(type != CJSON_OBJECT && type != CJSON_ARRAY) {
+        return false;
+    }
+
+    if(*query == '\0' || strlen(query) > (size_t)UINT_MAX) {
+        return false;
+    }
+
+    bool is_object_key = *query != '[';
+    if(*query == '.' || *query == '[') {
+        query++;
+    }
+
+    struct CJSON_TapeValue current = *tape_value;
+    while(true) {
+        if(is_object_key && CJSON_TapeValue_type(&current) == CJSON_OBJECT) {
+            const char *const key = query;
+            while(*query != '.' && *query != '[' && *query != '\0') {
+                query++;
+            }
+
+            const struct CJSON_TapeValue object = current;
+            if(!CJSON_TapeValue_find_field(&object, key, (unsigned)(query - key), &current)) {
+                return false;
+            }
+        } else if(!is_object_key && CJSON_TapeValue_type(&current) == CJSON_ARRAY) {
+            const char *const digits = query;
+            unsigned index = 0U;
+            while(*query != ']' && *query != '\0') {
+                if(*query < '0' || *query > '9') {
+                    return false;
+                }
+
+                const unsigned digit = (unsigned)(*query - '0');
+                if(index > (UINT_MAX - digit) / 10U) {
+                    return false;
+                }
+                index = index * 10U + digit;
+                query++;
+            }
+
+            if(*query != ']' || query == digits) {
+                return false;
+            }
+
+            const struct CJSON_TapeValue array = current;
+            if(!CJSON_TapeValue_at(&array, index, &current)) {
+                return false;
+            }
+            query++;
+        } else {
+            return false;
+        }
+
+        if(*query == '\0') {
+            break;
+        }
+
+        is_object_key = *query != '[';
+        query++;
+    }
+
+    *value = current;
+    return true;
+}
+
+EXTERN_C const char *CJSON_TapeValue_as_string_n(const struct CJSON_TapeValue *const value, unsigned *const length, bool *const success) {
+    assert(value != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    if(CJSON_TAPE_TAG(value->tape->words[value->index]) != CJSON_TAPE_TAG_STRING) {
+        *success = false;
+        return NULL;
+    }
+    *success = true;
+    return CJSON_Tape_string(value->tape, value->index, length);
+}
+
+EXTERN_C double CJSON_TapeValue_as_float64(const struct CJSON_TapeValue *const value, bool *const success) {
+    assert(value != NULL);
+    assert(success != NULL);
+
+    struct CJSON json = CJSON_TapeValue_to_json(value);
+    return CJSON_as_float64(&json, success);
+}
+
+EXTERN_C int64_t CJSON_TapeValue_as_int64(const struct CJSON_TapeValue *const value, bool *const success) {
+    assert(value != NULL);
+    assert(success != NULL);
+
+    struct CJSON json = CJSON_TapeValue_to_json(value);
+    return CJSON_as_int64(&json, success);
+}
+
+EXTERN_C uint64_t CJSON_TapeValue_as_uint64(const struct CJSON_TapeValue *const value, bool *const success) {
+    assert(value != NULL);
+    assert(success != NULL);
+
+    struct CJSON json = CJSON_TapeValue_to_json(value);
+    return CJSON_as_uint64(&json, success);
+}
+
+EXTERN_C bool CJSON_TapeValue_as_bool(const struct CJSON_TapeValue *const value, bool *const success) {
+    assert(value != NULL);
+    assert(success != NULL);
+
+    if(CJSON_TapeValue_type(value) != CJSON_BOOL) {
+        *success = false;
+        return false;
+    }
+    *success = true;
+    return CJSON_TAPE_TAG(value->tape->words[value->index]) == CJSON_TAPE_TAG_TRUE;
+}
+
+EXTERN_C bool CJSON_TapeValue_is_null(const struct CJSON_TapeValue *const value) {
+    assert(value != NULL);
+
+    return CJSON_TapeValue_type(value) == CJSON_NULL;
+}
+
+EXTERN_C const char *CJSON_TapeValue_get_string_n(const struct CJSON_TapeValue *const tape_value, const char *const query, unsigned *const length, bool *const success) {
+    assert(tape_value != NULL);
+    assert(query != NULL);
+    assert(length != NULL);
+    assert(success != NULL);
+
+    struct CJSON_TapeValue value;
+    if(!CJSON_TapeValue_get(tape_value, query, &value)) {
+        *success = false;
+        return NULL;
+    }
+
+    return CJSON_TapeValue_as_string_n(&value, length, success);
+}
+
+EXTERN_C double CJSON_TapeValue_get_float64(const struct CJSON_TapeValue *const tape_value, const char *const query, bool *const success) {
+    assert(tape_value != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_TapeValue value;
+    if(!CJSON_TapeValue_get(tape_value, query, &value)) {
+        *success = false;
+        return 0.0;
+    }
+
+    return CJSON_TapeValue_as_float64(&value, success);
+}
+
+EXTERN_C int64_t CJSON_TapeValue_get_int64(const struct CJSON_TapeValue *const tape_value, const char *const query, bool *const success) {
+    assert(tape_value != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_TapeValue value;
+    if(!CJSON_TapeValue_get(tape_value, query, &value)) {
+        *success = false;
+        return 0;
+    }
+
+    return CJSON_TapeValue_as_int64(&value, success);
+}
+
+EXTERN_C uint64_t CJSON_TapeValue_get_uint64(const struct CJSON_TapeValue *const tape_value, const char *const query, bool *const success) {
+    assert(tape_value != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_TapeValue value;
+    if(!CJSON_TapeValue_get(tape_value, query, &value)) {
+        *success = false;
+        return 0U;
+    }
+
+    return CJSON_TapeValue_as_uint64(&value, success);
+}
+
+EXTERN_C bool CJSON_TapeValue_get_bool(const struct CJSON_TapeValue *const tape_value, const char *const query, bool *const success) {
+    assert(tape_value != NULL);
+    assert(query != NULL);
+    assert(success != NULL);
+
+    struct CJSON_TapeValue value;
+    if(!CJSON_TapeValue_get(tape_value, query, &value)) {
+        *success = false;
+        return false;
+    }
+
+    return CJSON_TapeValue_as_bool(&value, success);
+}
@@ -0,0 +1,82 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_TAPE_H
+#define CJSON_TAPE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "json.h"
+
+//the element count kept in the word of a container, a bigger container is counted by walking it
+#define CJSON_TAPE_MAXIMUM_COUNT 0xFFFFFFU
+
+//the tag is the top byte of a word and the other 56 bits are its payload
+enum CJSON_Tape_Tag {
+    CJSON_TAPE_TAG_OBJECT     = '{', //the element count in bits 32 to 55 and the index of the word after the matching '}'
+    CJSON_TAPE_TAG_OBJECT_END = '}', //the index of the matching '{'
+    CJSON_TAPE_TAG_ARRAY      = '[',
+    CJSON_TAPE_TAG_ARRAY_END  = ']',
+    CJSON_TAPE_TAG_KEY        = ':', //the offset of the key in the strings, the value is the next word
+    CJSON_TAPE_TAG_STRING     = '"',
+    CJSON_TAPE_TAG_INT64      = 'l', //the value is the next word
+    CJSON_TAPE_TAG_UINT64     = 'u',
+    CJSON_TAPE_TAG_FLOAT64    = 'd',
+    CJSON_TAPE_TAG_TRUE       = 't',
+    CJSON_TAPE_TAG_FALSE      = 'f',
+    CJSON_TAPE_TAG_NULL       = 'n'
+};
+
+//an immutable document: every value is one word (two for a number) in the order of the input.
+//a string is a 32 bits length followed by its characters and a NUL terminator in strings.
+//the words and the strings are one allocation, the input is not needed once the tape is built
+struct CJSON_Tape {
+    uint64_t        *words;
+    char            *strings;
+    unsigned         word_count,
+                     strings_length;
+    enum CJSON_Error error;
+};
+
+//a value of a tape, index is its first word
+struct CJSON_TapeValue {
+    const struct CJSON_Tape *tape;
+    unsigned                 index;
+};
+
+void            CJSON_Tape_init             (struct CJSON_Tape*);
+void            CJSON_Tape_free             (struct CJSON_Tape*);
+//builds the tape from the tokens of the input, the document held by the tape is freed first.
+//false with the error in the tape if the input is not valid
+bool            CJSON_Tape_parse            (struct CJSON_Tape*, const char *data, unsigned length);
+//the destination is freed first and gets a copy of the words and the strings of the source
+bool            CJSON_Tape_copy             (struct CJSON_Tape *destination, const struct CJSON_Tape *source);
+//the document without whitespace, the string must be freed
+char           *CJSON_Tape_to_string        (const struct CJSON_Tape*);
+bool            CJSON_Tape_root             (const struct CJSON_Tape*, struct CJSON_TapeValue*);
+enum CJSON_Type CJSON_TapeValue_type        (const struct CJSON_TapeValue*);
+//the elements of an array or an object, the length of a string, 0 for the other values
+unsigned        CJSON_TapeValue_length      (const struct CJSON_TapeValue*);
+//the value of the first member with the key
+bool            CJSON_TapeValue_find_field  (const struct CJSON_TapeValue*, const char *key, unsigned key_length, struct CJSON_TapeValue *value);
+bool            CJSON_TapeValue_at          (const struct CJSON_TapeValue*, unsigned index, struct CJSON_TapeValue *value);
+//the queries are the same as the ones of CJSON_get
+bool            CJSON_TapeValue_get         (const struct CJSON_TapeValue*, const char *query, struct CJSON_TapeValue *value);
+const char     *CJSON_TapeValue_as_string_n (const struct CJSON_TapeValue*, unsigned *length, bool *success);
+double          CJSON_TapeValue_as_float64  (const struct CJSON_TapeValue*, bool *success);
+int64_t         CJSON_TapeValue_as_int64    (const struct CJSON_TapeValue*, bool *success);
+uint64_t        CJSON_TapeValue_as_uint64   (const struct CJSON_TapeValue*, bool *success);
+bool            CJSON_TapeValue_as_bool     (const struct CJSON_TapeValue*, bool *success);
+bool            CJSON_TapeValue_is_null     (const struct CJSON_TapeValue*);
+const char     *CJSON_TapeValue_get_string_n(const struct CJSON_TapeValue*, const char *query, unsigned *length, bool *success);
+double          CJSON_TapeValue_get_float64 (const struct CJSON_TapeValue*, const char *query, bool *success);
+int64_t         CJSON_TapeValue_get_int64   (const struct CJSON_TapeValue*, const char *query, bool *success);
+uint64_t        CJSON_TapeValue_get_uint64  (const struct CJSON_TapeValue*, const char *query, bool *success);
+bool            CJSON_TapeValue_get_bool    (const struct CJSON_TapeValue*, const char *query, bool *success);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,8 +2,14 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <inttypes.h>
 
 #include "../cjson.h"
+#include "../lexer.h"
+#include "../indexer.h"
+#include "../file.h"
 
 static bool success;
 
@@ -323,6 +329,846 @@ static void test_exponent(void) {
     CJSON_Parser_free(&parser);
 }
 
+static void test_numbers(void) {
+    const char numbers[] = 
+        "[18446744073709551615, -9223372036854775808, 1.5e3, 1.5e0, 1e300, 0.1, -0.0, 12345678.87654321,"
+        " 4.9e-324, 2.2250738585072011e-308, 123456789012345678901234567890e-10, 1E+2, 250e-2]";
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    struct CJSON *const json = CJSON_parse(&parser, numbers, sizeof(numbers) - 1);
+    assert(json != NULL);
+    assert(parser.error == CJSON_ERROR_NONE);
+
+    assert(CJSON_get_uint64(json, "[0]", &success) == UINT64_MAX);
+    assert(success);
+    assert(CJSON_get_int64(json, "[1]", &success) == INT64_MIN);
+    assert(success);
+    assert(CJSON_get_uint64(json, "[2]", &success) == 1500U);
+    assert(success);
+    assert(CJSON_get_float64(json, "[3]", &success) == 1.5);
+    assert(success);
+    assert(CJSON_get_float64(json, "[4]", &success) == 1e300);
+    assert(success);
+    assert(CJSON_get_float64(json, "[5]", &success) == 0.1);
+    assert(success);
+    assert(CJSON_get_float64(json, "[6]", &success) == 0.0);
+    assert(success);
+    assert(CJSON_get_float64(json, "[7]", &success) == 12345678.87654321);
+    assert(success);
+    assert(CJSON_get_float64(json, "[8]", &success) == 4.9e-324);
+    assert(success);
+    assert(CJSON_get_float64(json, "[9]", &success) == 2.2250738585072011e-308);
+    assert(success);
+    assert(CJSON_get_float64(json, "[10]", &success) == 12345678901234567890.1234567890);
+    assert(success);
+    assert(CJSON_get_uint64(json, "[11]", &success) == 100U);
+    assert(success);
+    assert(CJSON_get_float64(json, "[12]", &success) == 2.5);
+    assert(success);
+
+    CJSON_Parser_free(&parser);
+
+    const char *const invalid_numbers[] = {
+        "18446744073709551616",
+        "-9223372036854775809",
+        "1e400",
+        "-1e400"
+    };
+    const enum CJSON_Error errors[] = {
+        CJSON_ERROR_UINT64,
+        CJSON_ERROR_INT64,
+        CJSON_ERROR_FLOAT64,
+        CJSON_ERROR_FLOAT64
+    };
+
+    for(unsigned i = 0U; i < sizeof(invalid_numbers) / sizeof(invalid_numbers[0]); i++) {
+        CJSON_Parser_init(&parser);
+        assert(CJSON_parse(&parser, invalid_numbers[i], (unsigned)strlen(invalid_numbers[i])) == NULL);
+        assert(parser.error == errors[i]);
+        CJSON_Parser_free(&parser);
+    }
+
+    const char *const malformed_numbers[] = {"01", "1.", "-", "1e", "1e+", "-01"};
+    for(unsigned i = 0U; i < sizeof(malformed_numbers) / sizeof(malformed_numbers[0]); i++) {
+        CJSON_Parser_init(&parser);
+        assert(CJSON_parse(&parser, malformed_numbers[i], (unsigned)strlen(malformed_numbers[i])) == NULL);
+        CJSON_Parser_free(&parser);
+    }
+}
+
+static void test_lazy_numbers(void) {
+    const char numbers[] = "[1.10,1E+2,-0.0,123456789012345678901234567890,[7,8e-1]]";
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    parser.options |= CJSON_PARSER_OPTION_LAZY_NUMBERS;
+    struct CJSON *const json = CJSON_parse(&parser, numbers, sizeof(numbers) - 1);
+    assert(json != NULL);
+    assert(parser.error == CJSON_ERROR_NONE);
+
+    struct CJSON *const float_json = CJSON_get(json, "[0]");
+    assert(float_json != NULL);
+    assert(float_json->type == CJSON_NUMBER);
+    assert(float_json->value.number.chars == numbers + 1);
+    assert(float_json->value.number.length == 4U);
+
+    //not decoded yet, the lexemes are written back as they were
+    char *string = CJSON_to_string(json, 0U);
+    assert(string != NULL);
+    assert(strcmp(string, numbers) == 0);
+    free(string);
+
+    assert(CJSON_as_float64(float_json, &success) == 1.1);
+    assert(success);
+    assert(float_json->type == CJSON_NUMBER);
+    assert(CJSON_get_uint64(json, "[1]", &success) == 100U);
+    assert(success);
+    assert(CJSON_get_float64(json, "[2]", &success) == 0.0);
+    assert(success);
+    assert(CJSON_Array_get_uint64(CJSON_get_array(json, "[4]", &success), 0U, &success) == 7U);
+    assert(success);
+    assert(CJSON_get_float64(json, "[4][1]", &success) == 0.8);
+    assert(success);
+
+    //a number that can't be decoded stays as it was
+    CJSON_get_uint64(json, "[3]", &success);
+    assert(!success);
+    assert(CJSON_get(json, "[3]")->type == CJSON_NUMBER);
+    assert(CJSON_get_string(json, "[3]", &success) == NULL);
+    assert(!success);
+
+    //the numbers that were read keep their lexemes
+    string = CJSON_to_string(json, 0U);
+    assert(string != NULL);
+    assert(strcmp(string, numbers) == 0);
+    free(string);
+
+    CJSON_Parser_free(&parser);
+
+    const char precise[] = "[1.0000000000000000000001]";
+    CJSON_Parser_init(&parser);
+    parser.options |= CJSON_PARSER_OPTION_LAZY_NUMBERS;
+    struct CJSON *const precise_json = CJSON_parse(&parser, precise, sizeof(precise) - 1);
+    assert(precise_json != NULL);
+    assert(CJSON_get_float64(precise_json, "[0]", &success) == 1.0);
+    assert(success);
+    string = CJSON_to_string(precise_json, 0U);
+    assert(string != NULL);
+    assert(strcmp(string, precise) == 0);
+    free(string);
+    CJSON_Parser_free(&parser);
+
+    //the grammar is still checked while parsing, with the same error as without the option
+    const char *const invalid_numbers[] = {"[-]", "[1e]", "[1.]", "[-.5]", "[1E+3.]"};
+    for(unsigned i = 0U; i < sizeof(invalid_numbers) / sizeof(invalid_numbers[0]); i++) {
+        CJSON_Parser_init(&parser);
+        assert(CJSON_parse(&parser, invalid_numbers[i], (unsigned)strlen(invalid_numbers[i])) == NULL);
+        const enum CJSON_Error error = parser.error;
+        assert(error != CJSON_ERROR_NONE);
+        CJSON_Parser_free(&parser);
+
+        for(unsigned single_pass = 0U; single_pass < 2U; single_pass++) {
+            CJSON_Parser_init(&parser);
+            parser.options |= CJSON_PARSER_OPTION_LAZY_NUMBERS;
+            if(single_pass == 1U) {
+                parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+            }
+            assert(CJSON_parse(&parser, invalid_numbers[i], (unsigned)strlen(invalid_numbers[i])) == NULL);
+            assert(parser.error == error);
+            CJSON_Parser_free(&parser);
+        }
+    }
+
+    //the range is only checked by the accessors, an input that fails without the option parses with it
+    const char *const out_of_range[]     = {"[1e400]", "[99999999999999999999999]", "[-99999999999999999999]"};
+    const enum CJSON_Error range_errors[] = {CJSON_ERROR_FLOAT64, CJSON_ERROR_UINT64, CJSON_ERROR_INT64};
+    for(unsigned i = 0U; i < sizeof(out_of_range) / sizeof(out_of_range[0]); i++) {
+        CJSON_Parser_init(&parser);
+        assert(CJSON_parse(&parser, out_of_range[i], (unsigned)strlen(out_of_range[i])) == NULL);
+        assert(parser.error == range_errors[i]);
+        CJSON_Parser_free(&parser);
+
+        CJSON_Parser_init(&parser);
+        parser.options |= CJSON_PARSER_OPTION_LAZY_NUMBERS;
+        struct CJSON *const range_json = CJSON_parse(&parser, out_of_range[i], (unsigned)strlen(out_of_range[i]));
+        assert(range_json != NULL && parser.error == CJSON_ERROR_NONE);
+        CJSON_get_float64(range_json, "[0]", &success);
+        assert(i > 0U || !success);
+        CJSON_get_int64(range_json, "[0]", &success);
+        assert(!success);
+        CJSON_get_uint64(range_json, "[0]", &success);
+        assert(!success);
+        CJSON_Parser_free(&parser);
+    }
+
+    CJSON_Parser_init(&parser);
+    parser.options |= CJSON_PARSER_OPTION_LAZY_NUMBERS | CJSON_PARSER_OPTION_SINGLE_PASS;
+    struct CJSON *const single_pass_json = CJSON_parse(&parser, numbers, sizeof(numbers) - 1);
+    assert(single_pass_json != NULL);
+    string = CJSON_to_string(single_pass_json, 0U);
+    assert(string != NULL);
+    assert(strcmp(string, numbers) == 0);
+    free(string);
+    CJSON_Parser_free(&parser);
+}
+
+static void test_ondemand(void) {
+    const char document[] = 
+        "{\"skipped\": {\"a\": [1, {\"b\": \"]}\\\"\"}], \"c\": null},"
+        " \"user\": {\"name\": \"caf\\u00e9\", \"id\": 18446744073709551615, \"active\": true, \"ratio\": -2.5e-1},"
+        " \"items\": [10, [20, 21], {\"x\": 30}, \"forty\"],"
+        " \"k\\u0065y\": 1}";
+
+    struct CJSON_Doc doc;
+    CJSON_Doc_init(&doc, document, sizeof(document) - 1);
+
+    struct CJSON_Cursor root;
+    assert(CJSON_Doc_root(&doc, &root));
+    assert(CJSON_Cursor_type(&root) == CJSON_OBJECT);
+
+    assert(CJSON_Cursor_get_uint64(&root, "user.id", &success) == UINT64_MAX);
+    assert(success);
+    assert(CJSON_Cursor_get_bool(&root, "user.active", &success));
+    assert(success);
+    assert(CJSON_Cursor_get_float64(&root, ".user.ratio", &success) == -0.25);
+    assert(success);
+    assert(CJSON_Cursor_get_int64(&root, "items[1][1]", &success) == 21);
+    assert(success);
+    assert(CJSON_Cursor_get_int64(&root, "items[2].x", &success) == 30);
+    assert(success);
+    assert(CJSON_Cursor_get_int64(&root, "key", &success) == 1);
+    assert(success);
+
+    unsigned length;
+    const char *const raw = CJSON_Cursor_get_raw_string(&root, "items[3]", &length, &success);
+    assert(success);
+    assert(length == 5U && memcmp(raw, "forty", 5U) == 0);
+
+    struct CJSON_Cursor name;
+    assert(CJSON_Cursor_get(&root, "user.name", &name));
+    char decoded[16];
+    assert(CJSON_Cursor_decode_string(&name, decoded, &length));
+    assert(strcmp(decoded, "caf\xc3\xa9") == 0);
+
+    struct CJSON_Cursor null_value;
+    assert(CJSON_Cursor_get(&root, "skipped.c", &null_value));
+    assert(CJSON_Cursor_is_null(&null_value));
+
+    assert(!CJSON_Cursor_get(&root, "missing", &null_value));
+    assert(!CJSON_Cursor_get(&root, "items[4]", &null_value));
+    assert(!CJSON_Cursor_get(&root, "items.x", &null_value));
+    CJSON_Cursor_get_int64(&root, "user.name", &success);
+    assert(!success);
+    assert(doc.error == CJSON_ERROR_NONE);
+
+    struct CJSON_Cursor items, item;
+    assert(CJSON_Cursor_find_field(&root, "items", 5U, &items));
+    struct CJSON_ArrayIter iter;
+    assert(CJSON_Cursor_array_iter(&items, &iter));
+    const enum CJSON_Type types[] = {CJSON_NUMBER, CJSON_ARRAY, CJSON_OBJECT, CJSON_STRING};
+    unsigned count = 0U;
+    while(CJSON_ArrayIter_next(&iter, &item)) {
+        assert(CJSON_Cursor_type(&item) == types[count]);
+        count++;
+    }
+    assert(count == 4U);
+    assert(!CJSON_ArrayIter_next(&iter, &item));
+    assert(doc.error == CJSON_ERROR_NONE);
+
+    const char invalid[] = "{\"a\": [1, 2 3], \"b\": 1";
+    CJSON_Doc_init(&doc, invalid, sizeof(invalid) - 1);
+    assert(CJSON_Doc_root(&doc, &root));
+    assert(CJSON_Cursor_get_int64(&root, "a[0]", &success) == 1);
+    assert(success);
+    assert(!CJSON_Cursor_get(&root, "a[2]", &item));
+    assert(doc.error == CJSON_ERROR_MISSING_COMMA_OR_RBRACKET);
+    assert(!CJSON_Cursor_get(&root, "c", &item));
+    assert(doc.error == CJSON_ERROR_OBJECT);
+
+    //what follows the root value is not read
+    const char trailing[] = "[1] 2";
+    CJSON_Doc_init(&doc, trailing, sizeof(trailing) - 1);
+    assert(CJSON_Doc_root(&doc, &root));
+    assert(CJSON_Cursor_get_int64(&root, "[0]", &success) == 1 && success);
+    assert(doc.error == CJSON_ERROR_NONE);
+}
+
+struct Sax_Events {
+    char     buffer[256];
+    unsigned length,
+             stop_after;
+};
+
+static bool sax_append(void *const context, const char *const event) {
+    struct Sax_Events *const events = (struct Sax_Events*)context;
+    const size_t length = strlen(event);
+    assert(events->length + length < sizeof(events->buffer));
+    memcpy(events->buffer + events->length, event, length + 1U);
+    events->length += (unsigned)length;
+    return --events->stop_after > 0U;
+}
+
+static bool sax_start_object(void *const context) {
+    return sax_append(context, "{");
+}
+
+static bool sax_end_object(void *const context) {
+    return sax_append(context, "}");
+}
+
+static bool sax_start_array(void *const context) {
+    return sax_append(context, "[");
+}
+
+static bool sax_end_array(void *const context) {
+    return sax_append(context, "]");
+}
+
+static bool sax_key(void *const context, const char *const chars, const unsigned length) {
+    char event[32];
+    sprintf(event, "k:%.*s ", (int)length, chars);
+    return sax_append(context, event);
+}
+
+static bool sax_string(void *const context, const char *const chars, const unsigned length) {
+    char event[32];
+    sprintf(event, "s:%.*s ", (int)length, chars);
+    return sax_append(context, event);
+}
+
+static bool sax_int64(void *const context, const int64_t value) {
+    char event[32];
+    sprintf(event, "i:%lld ", (long long)value);
+    return sax_append(context, event);
+}
+
+static bool sax_uint64(void *const context, const uint64_t value) {
+    char event[32];
+    sprintf(event, "u:%llu ", (unsigned long long)value);
+    return sax_append(context, event);
+}
+
+static bool sax_float64(void *const context, const double value) {
+    char event[32];
+    sprintf(event, "f:%g ", value);
+    return sax_append(context, event);
+}
+
+static bool sax_boolean(void *const context, const bool value) {
+    return sax_append(context, value ? "true " : "false ");
+}
+
+static bool sax_null(void *const context) {
+    return sax_append(context, "null ");
+}
+
+static void test_sax(void) {
+    const char document[] = "{\"a\": [1, -2, 2.5, 1e2, \"x\\ty\", true, false, null, {}], \"b\\u0062\": {\"c\": []}}";
+
+    struct CJSON_Handler handler;
+    handler.start_object = sax_start_object;
+    handler.end_object   = sax_end_object;
+    handler.start_array  = sax_start_array;
+    handler.end_array    = sax_end_array;
+    handler.key          = sax_key;
+    handler.string       = sax_string;
+    handler.int64        = sax_int64;
+    handler.uint64       = sax_uint64;
+    handler.float64      = sax_float64;
+    handler.boolean      = sax_boolean;
+    handler.null         = sax_null;
+
+    struct Sax_Events events;
+    events.length     = 0U;
+    events.stop_after = UINT_MAX;
+    assert(CJSON_parse_sax(document, sizeof(document) - 1, &handler, &events) == CJSON_ERROR_NONE);
+    assert(strcmp(events.buffer, "{k:a [u:1 i:-2 f:2.5 u:100 s:x\ty true false null {}]k:bb {k:c []}}") == 0);
+
+    //the parsing stops as soon as a callback returns false
+    events.length     = 0U;
+    events.stop_after = 3U;
+    assert(CJSON_parse_sax(document, sizeof(document) - 1, &handler, &events) == CJSON_ERROR_HANDLER);
+    assert(strcmp(events.buffer, "{k:a [") == 0);
+
+    //callbacks can be left NULL
+    handler.key    = NULL;
+    handler.uint64 = NULL;
+    events.length     = 0U;
+    events.stop_after = UINT_MAX;
+    const char partial_document[] = "{\"key\": [1, \"2\"]}";
+    assert(CJSON_parse_sax(partial_document, sizeof(partial_document) - 1, &handler, &events) == CJSON_ERROR_NONE);
+    assert(strcmp(events.buffer, "{[s:2 ]}") == 0);
+
+    const char *const invalid_documents[] = {
+        "[1, 2",
+        "{\"key\" 1}",
+        "[1 2]",
+        "[18446744073709551616]",
+        "[1, ]",
+        "1 1",
+        "[ ]]",
+        "{} []"
+    };
+    const enum CJSON_Error errors[] = {
+        CJSON_ERROR_ARRAY,
+        CJSON_ERROR_OBJECT,
+        CJSON_ERROR_MISSING_COMMA_OR_RBRACKET,
+        CJSON_ERROR_UINT64,
+        CJSON_ERROR_ARRAY,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN
+    };
+
+    for(unsigned i = 0U; i < sizeof(invalid_documents) / sizeof(invalid_documents[0]); i++) {
+        events.length     = 0U;
+        events.stop_after = UINT_MAX;
+        assert(CJSON_parse_sax(invalid_documents[i], (unsigned)strlen(invalid_documents[i]), &handler, &events) == errors[i]);
+    }
+}
+
+static void test_stream(void) {
+    const char document[] = 
+        "{\"key1\": [1, -2.5, 3e2, true, false, null, 12345678901234567890], \"esc\\\"aped\": \"a\\u00e9\\n\\\\\","
+        " \"key2\": {\"nested\": [[], {}, [[\"deep\"]]]}}  ";
+    const unsigned length = sizeof(document) - 1;
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    const struct CJSON *const expected_json = CJSON_parse(&parser, document, length);
+    assert(expected_json != NULL);
+    char *const expected_string = CJSON_to_string(expected_json, 0U);
+    assert(expected_string != NULL);
+
+    //every chunk size cuts the tokens at different places
+    for(unsigned chunk_size = 1U; chunk_size <= length; chunk_size++) {
+        struct CJSON_Parser stream_parser;
+        CJSON_Parser_init(&stream_parser);
+        stream_parser.options |= CJSON_PARSER_OPTION_ZERO_COPY;
+
+        struct CJSON_StreamParser stream;
+        CJSON_StreamParser_init(&stream, &stream_parser);
+        for(unsigned position = 0U; position < length; position += chunk_size) {
+            //the chunk is overwritten after each call like a network buffer would be
+            char chunk[sizeof(document)];
+            const unsigned chunk_length = length - position < chunk_size ? length - position : chunk_size;
+            memcpy(chunk, document + position, chunk_length);
+            assert(CJSON_StreamParser_feed(&stream, chunk, chunk_length));
+            memset(chunk, 'x', sizeof(chunk));
+        }
+
+        const struct CJSON *const json = CJSON_StreamParser_finish(&stream);
+        assert(json != NULL);
+        assert(stream_parser.error == CJSON_ERROR_NONE);
+
+        char *const string = CJSON_to_string(json, 0U);
+        assert(string != NULL);
+        assert(strcmp(string, expected_string) == 0);
+        free(string);
+
+        CJSON_Parser_free(&stream_parser);
+    }
+
+    free(expected_string);
+    CJSON_Parser_free(&parser);
+
+    const char *const invalid_documents[] = {
+        "[1, 2",
+        "[\"unterminated",
+        "[tru",
+        "[1 2]",
+        "",
+        "1 1",
+        "[1] 2",
+        "[ ]]",
+        "{} []"
+    };
+    const enum CJSON_Error errors[] = {
+        CJSON_ERROR_ARRAY,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_MISSING_COMMA_OR_RBRACKET,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN
+    };
+
+    for(unsigned i = 0U; i < sizeof(invalid_documents) / sizeof(invalid_documents[0]); i++) {
+        CJSON_Parser_init(&parser);
+        struct CJSON_StreamParser stream;
+        CJSON_StreamParser_init(&stream, &parser);
+
+        const char *const invalid_document = invalid_documents[i];
+        const unsigned    invalid_length   = (unsigned)strlen(invalid_document);
+        bool is_fed = true;
+        for(unsigned position = 0U; position < invalid_length && is_fed; position += 2U) {
+            is_fed = CJSON_StreamParser_feed(&stream, invalid_document + position, invalid_length - position < 2U ? invalid_length - position : 2U);
+        }
+        if(is_fed) {
+            assert(CJSON_StreamParser_finish(&stream) == NULL);
+        }
+        assert(parser.error == errors[i]);
+        CJSON_StreamParser_free(&stream);
+        CJSON_Parser_free(&parser);
+    }
+}
+
+static void test_array_reader(void) {
+    const unsigned record_count = 5000U;
+    const unsigned big_record   = 1234U;
+
+    //records spanning several blocks, one of them bigger than a block
+    struct CJSON_FileContents file_contents;
+    file_contents.data = (unsigned char*)malloc((size_t)record_count * 64U + 200000U);
+    assert(file_contents.data != NULL);
+    char *output = (char*)file_contents.data;
+    output += sprintf(output, " [\n");
+    for(unsigned i = 0U; i < record_count; i++) {
+        if(i == big_record) {
+            output += sprintf(output, "{\"id\": %u, \"padding\": \"", i);
+            memset(output, 'x', 150000U);
+            output += 150000U;
+            output += sprintf(output, "\\\"]}\"}");
+        } else {
+            output += sprintf(output, "{\"id\": %u, \"tags\": [\"a\", \"b]\"], \"nested\": {\"x\": [%u]}}", i, i);
+        }
+        output += sprintf(output, i + 1U < record_count ? ",\n" : "\n]\n");
+    }
+    file_contents.size = (unsigned)(output - (char*)file_contents.data);
+    assert(CJSON_FileContents_put(&file_contents, "test_output.txt") == CJSON_FILECONTENTS_ERROR_NONE);
+    CJSON_FileContents_free(&file_contents);
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    struct CJSON_ArrayReader reader;
+    assert(CJSON_ArrayReader_open(&reader, &parser, "test_output.txt"));
+
+    unsigned count = 0U;
+    unsigned node_count = 0U;
+    struct CJSON *json;
+    while((json = CJSON_ArrayReader_next(&reader)) != NULL) {
+        assert(CJSON_get_uint64(json, "id", &success) == count);
+        assert(success);
+        if(count == big_record) {
+            unsigned length;
+            CJSON_get_string_n(json, "padding", &length, &success);
+            assert(success);
+            assert(length == 150000U + 3U);
+        } else {
+            assert(CJSON_get_uint64(json, "nested.x[0]", &success) == count);
+            assert(success);
+        }
+
+        //the arenas are reused from one element to the next
+        if(count == 10U || count == big_record) {
+            node_count = parser.string_arena.node_count;
+        } else if(count > 10U) {
+            assert(parser.string_arena.node_count == node_count);
+        }
+        count++;
+    }
+    assert(parser.error == CJSON_ERROR_NONE);
+    assert(count == record_count);
+    CJSON_ArrayReader_close(&reader);
+    CJSON_Parser_free(&parser);
+
+    const char *const documents[] = {"[]", "[1, 2", "[1 2]", "{}", "[1, ]"};
+    const unsigned counts[] = {0U, 2U, 1U, 0U, 1U};
+    const enum CJSON_Error errors[] = {
+        CJSON_ERROR_NONE,
+        CJSON_ERROR_ARRAY,
+        CJSON_ERROR_MISSING_COMMA_OR_RBRACKET,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_ARRAY_VALUE
+    };
+
+    for(unsigned i = 0U; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        FILE *const file = fopen("test_output.txt", "wb");
+        assert(file != NULL);
+        fputs(documents[i], file);
+        fclose(file);
+
+        CJSON_Parser_init(&parser);
+        count = 0U;
+        if(CJSON_ArrayReader_open(&reader, &parser, "test_output.txt")) {
+            while(CJSON_ArrayReader_next(&reader) != NULL) {
+                count++;
+            }
+            CJSON_ArrayReader_close(&reader);
+        }
+        assert(count == counts[i]);
+        assert(parser.error == errors[i]);
+        CJSON_Parser_free(&parser);
+    }
+
+    assert(remove("test_output.txt") == 0);
+}
+
+struct Many_Records {
+    unsigned         count,
+                     stop_after,
+                     lines[8];
+    uint64_t         ids[8];
+    enum CJSON_Error errors[8];
+};
+
+static bool many_record(void *const context, struct CJSON_Parser *const parser, struct CJSON *const json, const unsigned line) {
+    struct Many_Records *const records = (struct Many_Records*)context;
+
+    assert(records->count < 8U);
+    records->lines[records->count]  = line;
+    records->errors[records->count] = parser->error;
+    records->ids[records->count]    = 0U;
+    if(json != NULL) {
+        records->ids[records->count] = CJSON_get_uint64(json, "id", &success);
+        assert(success);
+    }
+    records->count++;
+
+    return records->count < records->stop_after;
+}
+
+static void test_parse_many(void) {
+    const char document[] =
+        "{\"id\": 1, \"name\": \"a\"}\n"
+        "  \r\n"
+        "{\"id\": 2, \"tags\": [\"x\\ny\", {}]}\r\n"
+        "[1, 2\n"
+        "\n"
+        "{\"id\" 3, \"a\": 1}\n"
+        "{\"id\": 4}";
+    const unsigned         lines[]  = {1U, 3U, 4U, 6U, 7U};
+    const uint64_t         ids[]    = {1U, 2U, 0U, 0U, 4U};
+    const enum CJSON_Error errors[] = {
+        CJSON_ERROR_NONE,
+        CJSON_ERROR_NONE,
+        CJSON_ERROR_ARRAY,
+        CJSON_ERROR_MISSING_COLON,
+        CJSON_ERROR_NONE
+    };
+    const unsigned options[] = {CJSON_PARSER_OPTION_NONE, CJSON_PARSER_OPTION_SINGLE_PASS};
+
+    for(unsigned i = 0U; i < sizeof(options) / sizeof(options[0]); i++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        parser.options = options[i];
+
+        //a record that fails doesn't stop the next ones
+        struct Many_Records records;
+        records.count      = 0U;
+        records.stop_after = UINT_MAX;
+        assert(CJSON_parse_many(&parser, document, sizeof(document) - 1, many_record, &records));
+        assert(parser.error == CJSON_ERROR_NONE);
+        assert(records.count == sizeof(lines) / sizeof(lines[0]));
+        for(unsigned j = 0U; j < records.count; j++) {
+            assert(records.lines[j]  == lines[j]);
+            assert(records.ids[j]    == ids[j]);
+            assert(records.errors[j] == errors[j]);
+        }
+
+        //the arenas of a record are reused by the next one
+        const unsigned node_count = parser.json_arena.node_count;
+        records.count = 0U;
+        assert(CJSON_parse_many(&parser, document, sizeof(document) - 1, many_record, &records));
+        assert(parser.json_arena.node_count == node_count);
+
+        records.count      = 0U;
+        records.stop_after = 2U;
+        assert(!CJSON_parse_many(&parser, document, sizeof(document) - 1, many_record, &records));
+        assert(parser.error == CJSON_ERROR_HANDLER);
+        assert(records.count == 2U);
+
+        CJSON_Parser_free(&parser);
+    }
+}
+
+struct Parallel_Records {
+    const char    *data;
+    unsigned       count,
+                   stop_after,
+                   last_offset;
+    unsigned char *seen; //a byte per offset so the threads never write the same byte
+};
+
+static bool parallel_record(void *const context, struct CJSON_Parser *const parser, struct CJSON *const json, const unsigned offset) {
+    struct Parallel_Records *const records = (struct Parallel_Records*)context;
+
+    if(json == NULL) {
+        assert(parser->error == CJSON_ERROR_MISSING_COMMA_OR_RCURLY);
+        assert(strncmp(records->data + offset, "{\"id\": 3", 8U) == 0);
+    } else {
+        //the threads can't share the global success
+        bool is_uint64;
+        char expected[32];
+        sprintf(expected, "{\"id\": %" PRIu64 ",", CJSON_get_uint64(json, "id", &is_uint64));
+        assert(is_uint64);
+        assert(strncmp(records->data + offset, expected, strlen(expected)) == 0);
+    }
+    records->seen[offset]++;
+
+    return true;
+}
+
+static bool parallel_ordered_record(void *const context, struct CJSON_Parser *const parser, struct CJSON *const json, const unsigned offset) {
+    struct Parallel_Records *const records = (struct Parallel_Records*)context;
+
+    assert(records->count == 0U || offset > records->last_offset);
+    records->last_offset = offset;
+    records->count++;
+
+    parallel_record(context, parser, json, offset);
+    return records->count < records->stop_after;
+}
+
+static void test_parse_many_parallel(void) {
+    const unsigned record_count = 60000U;
+    const unsigned big_record   = 20000U;
+
+    //records spread over several chunks, one of them longer than a chunk, and a record that fails to parse
+    char *const data = (char*)malloc((size_t)record_count * 96U + 3000000U);
+    assert(data != NULL);
+    unsigned length = 0U;
+    for(unsigned i = 0U; i < record_count; i++) {
+        if(i == 3U) {
+            length += (unsigned)sprintf(data + length, "{\"id\": 3 \"broken\": true}\n");
+        } else if(i == big_record) {
+            length += (unsigned)sprintf(data + length, "{\"id\": %u, \"padding\": \"", i);
+            memset(data + length, 'x', 2500000U);
+            length += 2500000U;
+            length += (unsigned)sprintf(data + length, "\"}\n");
+        } else {
+            length += (unsigned)sprintf(data + length, "{\"id\": %u, \"tags\": [\"a\", \"b\"], \"nested\": {\"x\": [%u.5]}}\n%s", i, i, i % 100U == 0U ? "\n" : "");
+        }
+    }
+
+    struct Parallel_Records records;
+    records.data = data;
+    records.seen = (unsigned char*)calloc((size_t)length, 1U);
+    assert(records.seen != NULL);
+
+    const unsigned options[]       = {CJSON_PARSER_OPTION_NONE, CJSON_PARSER_OPTION_SINGLE_PASS};
+    const unsigned thread_counts[] = {1U, 4U};
+    for(unsigned i = 0U; i < sizeof(options) / sizeof(options[0]); i++) {
+        for(unsigned j = 0U; j < sizeof(thread_counts) / sizeof(thread_counts[0]); j++) {
+            memset(records.seen, 0, (size_t)length);
+            assert(CJSON_parse_many_parallel(data, length, options[i], thread_counts[j], CJSON_PARALLEL_ORDER_COMPLETION, parallel_record, &records) == CJSON_ERROR_NONE);
+
+            //every record is given once
+            unsigned count = 0U;
+            for(unsigned offset = 0U; offset < length; offset++) {
+                assert(records.seen[offset] <= 1U);
+                count += records.seen[offset];
+                assert(records.seen[offset] == 0U || offset == 0U || data[offset - 1U] == '\n');
+            }
+            assert(count == record_count);
+
+            memset(records.seen, 0, (size_t)length);
+            records.count      = 0U;
+            records.stop_after = UINT_MAX;
+            assert(CJSON_parse_many_parallel(data, length, options[i], thread_counts[j], CJSON_PARALLEL_ORDER_INPUT, parallel_ordered_record, &records) == CJSON_ERROR_NONE);
+            assert(records.count == record_count);
+        }
+    }
+
+    //the callbacks stop right away in the input order
+    records.count      = 0U;
+    records.stop_after = 30000U;
+    assert(CJSON_parse_many_parallel(data, length, CJSON_PARSER_OPTION_NONE, 4U, CJSON_PARALLEL_ORDER_INPUT, parallel_ordered_record, &records) == CJSON_ERROR_HANDLER);
+    assert(records.count == 30000U);
+
+    free(records.seen);
+    free(data);
+}
+
+//a document of a few chunks, the strings have escaped quotes, backslashes and brackets so the chunks fall anywhere
+static unsigned write_parallel_document(char *const output, const bool is_object) {
+    unsigned length = (unsigned)sprintf(output, is_object ? "{" : "[\n");
+    for(unsigned i = 0U; i < 40000U; i++) {
+        if(i > 0U) {
+            length += (unsigned)sprintf(output + length, ",\n");
+        }
+        if(is_object) {
+            //a key seen again replaces the first one
+            length += (unsigned)sprintf(output + length, "\"key%u\": ", i == 39000U ? 5U : i);
+        }
+        length += (unsigned)sprintf(
+            output + length,
+            "{\"id\": %u, \"text\": \"a \\\"quoted\\\" [%u], {x} \\\\\\\\\\\\\", \"path\": \"C:\\\\dir\\\\\", \"values\": [%u.25, -%u, true, null, [[], {}]]}",
+            i, i, i, i
+        );
+        if(i % 1000U == 0U) {
+            length += (unsigned)sprintf(output + length, ", \"padding %u\"", i);
+            memset(output + length - 1U, ' ', 1U);
+            memset(output + length, 'p', 2000U);
+            length += 2000U;
+            output[length++] = '"';
+            if(is_object) {
+                length += (unsigned)sprintf(output + length, ": [\"padding\"]");
+            }
+        }
+    }
+    length += (unsigned)sprintf(output + length, is_object ? "}" : "\n]\n");
+
+    return length;
+}
+
+static void test_parse_parallel(void) {
+    char *const document = (char*)malloc(8000000U);
+    assert(document != NULL);
+
+    const bool     is_objects[]    = {false, true};
+    const unsigned thread_counts[] = {2U, 3U, 5U};
+    for(unsigned i = 0U; i < sizeof(is_objects) / sizeof(is_objects[0]); i++) {
+        const unsigned length = write_parallel_document(document, is_objects[i]);
+        assert(length >= 5U * CJSON_PARALLEL_CHUNK_SIZE);
+
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        const struct CJSON *const expected_json = CJSON_parse(&parser, document, length);
+        assert(expected_json != NULL);
+        char *const expected_string = CJSON_to_string(expected_json, 0U);
+        assert(expected_string != NULL);
+        CJSON_Parser_free(&parser);
+
+        for(unsigned j = 0U; j < sizeof(thread_counts) / sizeof(thread_counts[0]); j++) {
+            CJSON_Parser_init(&parser);
+            const struct CJSON *const json = CJSON_parse_parallel(&parser, document, length, thread_counts[j]);
+            assert(json != NULL);
+            char *const string = CJSON_to_string(json, 0U);
+            assert(string != NULL);
+            assert(strcmp(string, expected_string) == 0);
+            free(string);
+            CJSON_Parser_free(&parser);
+        }
+        free(expected_string);
+
+        //the errors are the ones of CJSON_parse
+        const char *const breaks[] = {", \"path\"", "\"text\": \"a", "\n]", "}"};
+        const char *const replacements[] = {"  \"path\"", "\"text\": 1 ", "\n}", "]"};
+        for(unsigned j = 0U; j < sizeof(breaks) / sizeof(breaks[0]); j++) {
+            char *const position = j < 2U ? strstr(document + length / 2U, breaks[j]) : strrchr(document, breaks[j][strlen(breaks[j]) - 1U]) - strlen(breaks[j]) + 1U;
+            assert(position != NULL);
+            char saved[16];
+            memcpy(saved, position, strlen(breaks[j]));
+            memcpy(position, replacements[j], strlen(replacements[j]));
+
+            CJSON_Parser_init(&parser);
+            assert(CJSON_parse(&parser, document, length) == NULL);
+            const enum CJSON_Error expected_error = parser.error;
+            CJSON_Parser_init(&parser);
+            assert(CJSON_parse_parallel(&parser, document, length, 4U) == NULL);
+            assert(parser.error == expected_error);
+
+            memcpy(position, saved, strlen(breaks[j]));
+        }
+    }
+
+    free(document);
+}
+
 static void test_null(void) {
     const char null_value[] = "{\"key\": null}";
     
@@ -409,6 +1255,58 @@ static void test_deep_nesting(void) {
     CJSON_Parser_free(&parser);
 }
 
+static void test_max_depth(void) {
+    const unsigned options[] = {CJSON_PARSER_OPTION_NONE, CJSON_PARSER_OPTION_SINGLE_PASS};
+    const unsigned deep      = 100000U;
+
+    char *const document = (char*)malloc((size_t)deep * 2U);
+    assert(document != NULL);
+    memset(document, '[', (size_t)deep);
+    memset(document + deep, ']', (size_t)deep);
+
+    for(unsigned i = 0U; i < sizeof(options) / sizeof(options[0]); i++) {
+        struct CJSON_Parser parser;
+
+        CJSON_Parser_init(&parser);
+        parser.options = options[i];
+        assert(parser.max_depth == CJSON_PARSER_DEFAULT_MAX_DEPTH);
+        assert(CJSON_parse(&parser, document, deep * 2U) == NULL);
+        assert(parser.error == CJSON_ERROR_DEPTH);
+        assert(strcmp(CJSON_get_error(&parser), "Too deeply nested.") == 0);
+
+        //no recursion, only the heap limits the depth
+        CJSON_Parser_init(&parser);
+        parser.options   = options[i];
+        parser.max_depth = UINT_MAX;
+        const struct CJSON *json = CJSON_parse(&parser, document, deep * 2U);
+        assert(json != NULL);
+        for(unsigned j = 1U; j < deep; j++) {
+            assert(json->type == CJSON_ARRAY);
+            assert(json->value.array.count == 1U);
+            json = json->value.array.values;
+        }
+        assert(json->type == CJSON_ARRAY);
+        assert(json->value.array.count == 0U);
+        CJSON_Parser_free(&parser);
+
+        const char three[] = "{\"a\": [1, {\"b\": null}], \"c\": []}";
+        CJSON_Parser_init(&parser);
+        parser.options   = options[i];
+        parser.max_depth = 3U;
+        assert(CJSON_parse(&parser, three, sizeof(three) - 1) != NULL);
+        CJSON_Parser_free(&parser);
+
+        const char four[] = "{\"a\": [1, {\"b\": [null]}], \"c\": []}";
+        CJSON_Parser_init(&parser);
+        parser.options   = options[i];
+        parser.max_depth = 3U;
+        assert(CJSON_parse(&parser, four, sizeof(four) - 1) == NULL);
+        assert(parser.error == CJSON_ERROR_DEPTH);
+    }
+
+    free(document);
+}
+
 static void test_no_quotes_key(void) {
     const char no_quotes_key[] = "{ key: 1 }";
 
@@ -631,6 +1529,951 @@ static void test_create_object(void) {
     CJSON_Parser_free(&parser);
 }
 
+static void test_object_table(void) {
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    struct CJSON *const json = CJSON_new(&parser);
+    assert(json != NULL);
+
+    struct CJSON_Object *const object = CJSON_make_object(json, &parser);
+    assert(object != NULL);
+    assert(CJSON_Object_is_empty(object));
+
+    char key[16];
+    for(unsigned i = 0U; i < 1000U; i++) {
+        snprintf(key, sizeof(key), "key%u", i);
+        assert(CJSON_Object_set_uint64(object, &parser, key, (uint64_t)i));
+    }
+    //everything but the capacity is in the allocation of the object, it doesn't make a CJSON bigger than an array does
+    assert(sizeof(struct CJSON_Object) == sizeof(struct CJSON_Array));
+
+    const unsigned slot_count = object->header->slot_count;
+    assert(CJSON_Object_count(object) == 1000U && CJSON_Object_length(object) == 1000U);
+    assert((slot_count & (slot_count - 1U)) == 0U);
+    assert(object->capacity <= slot_count - slot_count / 8U);
+    assert(!CJSON_Object_is_empty(object));
+
+    for(unsigned i = 0U; i < 1000U; i += 2U) {
+        snprintf(key, sizeof(key), "key%u", i);
+        CJSON_Object_delete(object, key);
+    }
+    assert(CJSON_Object_count(object) == 500U);
+
+    for(unsigned i = 0U; i < 1000U; i++) {
+        snprintf(key, sizeof(key), "key%u", i);
+        assert((CJSON_Object_get(object, key) == NULL) == (i % 2U == 0U));
+    }
+
+    //the keys added again go after the others
+    for(unsigned i = 0U; i < 1000U; i += 2U) {
+        snprintf(key, sizeof(key), "key%u", i);
+        assert(CJSON_Object_set_uint64(object, &parser, key, (uint64_t)i * 2U));
+    }
+    assert(CJSON_Object_count(object) == 1000U);
+
+    for(unsigned i = 0U; i < 1000U; i++) {
+        snprintf(key, sizeof(key), "key%u", i);
+        assert(CJSON_Object_get_uint64(object, key, &success) == (i % 2U == 0U ? (uint64_t)i * 2U : (uint64_t)i));
+        assert(success);
+    }
+
+    unsigned used = 0U;
+    for(unsigned i = 0U; i < CJSON_Object_length(object); i++) {
+        unsigned          key_length;
+        const char *const entry_key = CJSON_Object_key_at(object, i, &key_length);
+        if(entry_key != NULL) {
+            const unsigned expected = used < 500U ? used * 2U + 1U : (used - 500U) * 2U;
+            snprintf(key, sizeof(key), "key%u", expected);
+            assert(strcmp(entry_key, key) == 0);
+            used++;
+        }
+    }
+    assert(used == 1000U);
+
+    CJSON_Parser_free(&parser);
+
+    //a parsed object is sized from its element count and keeps the order of the input
+    char data[64 * 300];
+    unsigned length = 0U;
+    data[length++] = '{';
+    for(unsigned i = 0U; i < 300U; i++) {
+        length += (unsigned)snprintf(data + length, sizeof(data) - length, "%s\"member%u\":%u", i > 0U ? "," : "", i, i);
+    }
+    data[length++] = '}';
+
+    CJSON_Parser_init(&parser);
+    struct CJSON *const root = CJSON_parse(&parser, data, length);
+    assert(root != NULL);
+    assert(CJSON_Object_count(&root->value.object) == 300U);
+    assert(root->value.object.capacity == 300U);
+    assert(root->value.object.header->slot_count == CJSON_Object_slot_count(300U));
+    for(unsigned i = 0U; i < 300U; i++) {
+        snprintf(key, sizeof(key), "member%u", i);
+        assert(CJSON_get_uint64(root, key, &success) == (uint64_t)i);
+        assert(success);
+        unsigned key_length;
+        assert(strcmp(CJSON_Object_key_at(&root->value.object, i, &key_length), key) == 0);
+    }
+    assert(CJSON_get(root, "member300") == NULL);
+
+    CJSON_Parser_free(&parser);
+}
+
+static void test_key_length(void) {
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+
+    const char data[] = "{\"a\\u0000b\": 1, \"a\": 2, \"abc\": 3}";
+    struct CJSON *const json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+    assert(json != NULL);
+    assert(json->type == CJSON_OBJECT);
+
+    struct CJSON_Object *const object = &json->value.object;
+    assert(CJSON_Object_count(object) == 3U);
+
+    const struct CJSON *value = CJSON_Object_get_n(object, "a\0b", 3U);
+    assert(value != NULL && value->type == CJSON_UINT64 && value->value.uint64 == 1U);
+    value = CJSON_Object_get(object, "a");
+    assert(value != NULL && value->value.uint64 == 2U);
+    assert(CJSON_Object_get_n(object, "abc", 2U) == NULL);
+
+    const unsigned hash = CJSON_hash("abc", 3U);
+    value = CJSON_Object_get_hashed(object, "abc", 3U, hash);
+    assert(value != NULL && value->value.uint64 == 3U);
+
+    struct CJSON new_value;
+    new_value.type          = CJSON_BOOL;
+    new_value.value.boolean = true;
+    assert(CJSON_Object_set_n(object, &parser, "x\0y\0z", 5U, &new_value));
+    assert(CJSON_Object_get(object, "x") == NULL);
+    value = CJSON_Object_get_n(object, "x\0y\0z", 5U);
+    assert(value != NULL && value->type == CJSON_BOOL);
+
+    CJSON_Object_delete_n(object, "a\0b", 3U);
+    assert(CJSON_Object_get_n(object, "a\0b", 3U) == NULL);
+    assert(CJSON_Object_get(object, "a") != NULL);
+    assert(CJSON_Object_count(object) == 3U);
+
+    CJSON_Parser_free(&parser);
+
+    //the NUL and the other control characters are escaped again when the document is written
+    const char escaped[] = "{\"a\\u0000b\":1,\"s\":\"q\\\"\\\\\\n\\t\\u001f\"}";
+    CJSON_Parser_init(&parser);
+    struct CJSON *const escaped_json = CJSON_parse(&parser, escaped, (unsigned)sizeof(escaped) - 1U);
+    assert(escaped_json != NULL);
+    char *const string = CJSON_to_string(escaped_json, 0U);
+    assert(string != NULL);
+    assert(strcmp(string, escaped) == 0);
+    free(string);
+    CJSON_Parser_free(&parser);
+
+    struct CJSON_Tape tape;
+    CJSON_Tape_init(&tape);
+    assert(CJSON_Tape_parse(&tape, escaped, (unsigned)sizeof(escaped) - 1U));
+    char *const tape_string = CJSON_Tape_to_string(&tape);
+    assert(tape_string != NULL);
+    assert(strcmp(tape_string, escaped) == 0);
+    CJSON_FREE(tape_string);
+    CJSON_Tape_free(&tape);
+}
+
+static void test_key_handles(void) {
+    //built by the compiler in C++
+    const struct CJSON_Key id      = CJSON_KEY("id");
+    const struct CJSON_Key payload = CJSON_KEY("a payload key longer than 16 bytes");
+    const struct CJSON_Key nul     = CJSON_KEY("a\0b");
+    const struct CJSON_Key missing = CJSON_KEY("missing");
+
+    assert(id.length == 2U && id.hash == CJSON_hash("id", 2U));
+    assert(payload.length == 34U && payload.hash == CJSON_hash(payload.chars, payload.length));
+    assert(nul.length == 3U && nul.hash == CJSON_hash("a\0b", 3U));
+
+    const struct CJSON_Key made = CJSON_Key_make("id", 2U);
+    assert(made.hash == id.hash);
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+
+    const char data[] = "{\"id\": 1, \"a payload key longer than 16 bytes\": [2], \"a\\u0000b\": 3}";
+    struct CJSON *const json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+    assert(json != NULL);
+
+    const struct CJSON *value = CJSON_get_key(json, &id);
+    assert(value != NULL && value->value.uint64 == 1U);
+    value = CJSON_Object_get_key(&json->value.object, &payload);
+    assert(value != NULL && value->type == CJSON_ARRAY);
+    value = CJSON_get_key(json, &nul);
+    assert(value != NULL && value->value.uint64 == 3U);
+    assert(CJSON_get_key(json, &missing) == NULL);
+    assert(CJSON_get_key(CJSON_Array_get(&CJSON_get_key(json, &payload)->value.array, 0U), &id) == NULL);
+
+    assert(CJSON_get(json, "id") == CJSON_get_key(json, &id));
+
+    CJSON_Parser_free(&parser);
+}
+
+static const char *test_entry_key(const struct CJSON_Object *const object, const char *const key) {
+    for(unsigned i = 0U; i < CJSON_Object_length(object); i++) {
+        unsigned          key_length;
+        const char *const entry_key = CJSON_Object_key_at(object, i, &key_length);
+        if(entry_key != NULL && key_length == strlen(key) && memcmp(entry_key, key, strlen(key)) == 0) {
+            return entry_key;
+        }
+    }
+
+    return NULL;
+}
+
+static void test_key_interning(void) {
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+
+    const char data[] = "[{\"id\": 1, \"ab\": 2}, {\"id\": 3, \"a\\u0062\": 4}]";
+    struct CJSON *json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+    assert(json != NULL);
+
+    const struct CJSON_Object *first  = &CJSON_Array_get(&json->value.array, 0U)->value.object;
+    const struct CJSON_Object *second = &CJSON_Array_get(&json->value.array, 1U)->value.object;
+
+    //each distinct key is stored once, even when it was escaped
+    const char *const id = test_entry_key(first, "id");
+    const char *const ab = test_entry_key(first, "ab");
+    assert(id != NULL && ab != NULL);
+    assert(id < data || id >= data + sizeof(data));
+    assert(test_entry_key(second, "id") == id);
+    assert(test_entry_key(second, "ab") == ab);
+    //the escaped key was not copied in the strings first
+    assert(parser.string_arena.current == NULL || parser.string_arena.current->offset == 0U);
+
+    const struct CJSON_Key key = CJSON_Parser_key(&parser, "id", 2U);
+    assert(key.chars == id);
+    assert(CJSON_Object_get_key(second, &key)->value.uint64 == 3U);
+
+    //the keys are kept by a reset and by the single pass parser
+    CJSON_Parser_reset(&parser);
+    parser.options = CJSON_PARSER_OPTION_SINGLE_PASS;
+    json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+    assert(json != NULL);
+    first = &CJSON_Array_get(&json->value.array, 0U)->value.object;
+    assert(test_entry_key(first, "id") == id);
+    assert(parser.symbols.count == 2U);
+
+    //long keys are copied
+    char long_data[CJSON_SYMBOLS_MAXIMUM_LENGTH + 32U];
+    long_data[0] = '[';
+    long_data[1] = '{';
+    long_data[2] = '"';
+    memset(long_data + 3, 'k', CJSON_SYMBOLS_MAXIMUM_LENGTH + 1U);
+    memcpy(long_data + 4U + CJSON_SYMBOLS_MAXIMUM_LENGTH, "\":1}]", 6U);
+    parser.options = CJSON_PARSER_OPTION_NONE;
+    json = CJSON_parse(&parser, long_data, CJSON_SYMBOLS_MAXIMUM_LENGTH + 9U);
+    assert(json != NULL);
+    assert(parser.symbols.count == 2U);
+
+    //zero copy keys stay in the input
+    parser.options = CJSON_PARSER_OPTION_ZERO_COPY;
+    json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+    assert(json != NULL);
+    first = &CJSON_Array_get(&json->value.array, 0U)->value.object;
+    const char *const zero_copy_id = test_entry_key(first, "id");
+    assert(zero_copy_id > data && zero_copy_id < data + sizeof(data));
+
+    CJSON_Parser_free(&parser);
+}
+
+static void test_small_object(void) {
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+
+    const char data[] = "{\"id\": 1, \"\": 2, \"name\": \"x\", \"nan\": 3}";
+    struct CJSON *const json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+    assert(json != NULL);
+
+    struct CJSON_Object *const object = &json->value.object;
+    assert(object->header->slot_count == 0U);
+    assert(object->capacity == 4U);
+
+    assert(CJSON_Object_get_uint64(object, "id", &success) == 1U && success);
+    assert(CJSON_Object_get_uint64(object, "", &success) == 2U && success);
+    assert(CJSON_Object_get_uint64(object, "nan", &success) == 3U && success);
+    assert(CJSON_Object_get(object, "na") == NULL);
+    assert(CJSON_Object_get(object, "nam") == NULL);
+
+    const struct CJSON_Key name = CJSON_KEY("name");
+    assert(CJSON_Object_get_key(object, &name)->type == CJSON_STRING);
+
+    CJSON_Object_delete(object, "");
+    assert(CJSON_Object_get(object, "") == NULL);
+    assert(CJSON_Object_count(object) == 3U);
+
+    //the object gets slots once it grows past the small capacity
+    char key[16];
+    for(unsigned i = 0U; i < CJSON_OBJECT_SMALL_CAPACITY; i++) {
+        snprintf(key, sizeof(key), "key%u", i);
+        assert(CJSON_Object_set_uint64(object, &parser, key, (uint64_t)i));
+    }
+    unsigned key_length;
+    assert(CJSON_Object_count(object) == CJSON_OBJECT_SMALL_CAPACITY + 3U);
+    assert(object->header->slot_count > 0U);
+    assert(strcmp(CJSON_Object_key_at(object, 0U, &key_length), "id") == 0);
+    assert(strcmp(CJSON_Object_key_at(object, 1U, &key_length), "name") == 0);
+    assert(CJSON_Object_get(object, "") == NULL);
+    assert(CJSON_Object_get_key(object, &name)->type == CJSON_STRING);
+    for(unsigned i = 0U; i < CJSON_OBJECT_SMALL_CAPACITY; i++) {
+        snprintf(key, sizeof(key), "key%u", i);
+        assert(CJSON_Object_get_uint64(object, key, &success) == (uint64_t)i && success);
+    }
+
+    CJSON_Parser_free(&parser);
+}
+
+static void test_object_shapes(void) {
+    const char data[] = "[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"id\":3,\"name\":\"c\"},"
+                        "{\"id\":4,\"other\":5},{\"name\":\"e\",\"id\":5},{\"id\":6,\"name\":{\"id\":7}}]";
+
+    for(unsigned single_pass = 0U; single_pass < 2U; single_pass++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        if(single_pass == 1U) {
+            parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+        }
+
+        struct CJSON *const json = CJSON_parse(&parser, data, (unsigned)sizeof(data) - 1U);
+        assert(json != NULL);
+
+        struct CJSON_Object *objects[6];
+        for(unsigned i = 0U; i < 6U; i++) {
+            objects[i] = CJSON_Array_get_object(&json->value.array, i, &success);
+            assert(success);
+            assert(CJSON_Object_get_uint64(objects[i], "id", &success) == (uint64_t)i + 1U && success);
+        }
+
+        //the shape is made by the second object, the objects with other keys get their own entries
+        assert(objects[0]->header->shape == NULL && objects[1]->header->shape == NULL);
+        assert(objects[2]->header->shape != NULL && objects[2]->header != NULL);
+        assert(objects[3]->header->shape == NULL && objects[4]->header->shape == NULL);
+        assert(objects[5]->header->shape == objects[2]->header->shape);
+        struct CJSON_Entry entry;
+        assert(CJSON_Object_find_entry(objects[2], "id", 2U, &entry));
+        assert(entry.key_length == 2U && memcmp(entry.key, "id", 2U) == 0 && entry.value == CJSON_Object_value_at(objects[2], 0U));
+        assert(!CJSON_Object_find_entry(objects[2], "other", 5U, &entry));
+        assert(CJSON_Object_get_uint64(objects[3], "other", &success) == 5U && success);
+        assert(CJSON_Object_get(objects[2], "other") == NULL);
+        assert(strcmp(CJSON_Object_get_string(objects[2], "name", &success), "c") == 0 && success);
+        assert(CJSON_get_uint64(json, "[5].name.id", &success) == 7U && success);
+
+        unsigned key_length;
+        assert(strcmp(CJSON_Object_key_at(objects[2], 1U, &key_length), "name") == 0 && key_length == 4U);
+        assert(CJSON_Object_value_at(objects[2], 0U)->value.uint64 == 3U);
+
+        char *string = CJSON_to_string(json, 0U);
+        assert(string != NULL);
+        assert(strcmp(string, data) == 0);
+        free(string);
+
+        //setting a key of the shape keeps it, a new key gives the object its own entries
+        assert(CJSON_Object_set_uint64(objects[2], &parser, "id", 30U));
+        assert(objects[2]->header->shape != NULL);
+        assert(CJSON_Object_set_bool(objects[2], &parser, "extra", true));
+        assert(objects[2]->header->shape == NULL && CJSON_Object_count(objects[2]) == 3U);
+        assert(CJSON_Object_get_uint64(objects[2], "id", &success) == 30U && success);
+        assert(CJSON_Object_get_bool(objects[2], "extra", &success) && success);
+
+        //a deleted key of a shaped object is skipped until it's set again
+        CJSON_Object_delete(objects[5], "id");
+        assert(objects[5]->header->shape != NULL && CJSON_Object_count(objects[5]) == 1U);
+        assert(CJSON_Object_get(objects[5], "id") == NULL);
+        assert(CJSON_Object_key_at(objects[5], 0U, &key_length) == NULL);
+        string = CJSON_to_string(CJSON_Array_get(&json->value.array, 5U), 0U);
+        assert(string != NULL);
+        assert(strcmp(string, "{\"name\":{\"id\":7}}") == 0);
+        free(string);
+
+        assert(CJSON_Object_set_uint64(objects[5], &parser, "id", 6U));
+        assert(objects[5]->header->shape == NULL && CJSON_Object_count(objects[5]) == 2U);
+        string = CJSON_to_string(CJSON_Array_get(&json->value.array, 5U), 0U);
+        assert(string != NULL);
+        assert(strcmp(string, "{\"name\":{\"id\":7},\"id\":6}") == 0);
+        free(string);
+
+        assert(CJSON_get_uint64(json, "[1].id", &success) == 2U && success);
+
+        //an object with the count of the shape allocates nothing until its first key is known
+        assert(parser.shape != NULL && CJSON_Object_count(&parser.shape->keys) == 2U);
+        struct CJSON_Object object;
+        const unsigned offset = parser.object_arena.current->offset;
+        assert(CJSON_Object_start(&object, &parser, 2U));
+        assert(object.header == NULL && parser.object_arena.current->offset == offset);
+        assert(CJSON_Object_add(&object, &parser, "name", 4U, CJSON_hash("name", 4U)) != NULL);
+        assert(object.header->shape == NULL);
+        assert(CJSON_Object_add(&object, &parser, "id", 2U, CJSON_hash("id", 2U)) != NULL);
+        CJSON_Object_finish(&object, &parser);
+        assert(CJSON_Object_count(&object) == 2U && CJSON_Object_find_entry(&object, "id", 2U, &entry));
+
+        CJSON_Parser_free(&parser);
+    }
+
+    //a shape with more keys than a small object is looked up with its slots
+    char document[1024];
+    unsigned length = 0U;
+    document[length++] = '[';
+    for(unsigned i = 0U; i < 4U; i++) {
+        if(i > 0U) {
+            document[length++] = ',';
+        }
+        document[length++] = '{';
+        for(unsigned j = 0U; j < 12U; j++) {
+            length += (unsigned)snprintf(document + length, sizeof(document) - length, "%s\"key%u\":%u", j > 0U ? "," : "", j, i * 100U + j);
+        }
+        document[length++] = '}';
+    }
+    document[length++] = ']';
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    struct CJSON *const json = CJSON_parse(&parser, document, length);
+    assert(json != NULL);
+
+    const struct CJSON_Object *const object = CJSON_Array_get_object(&json->value.array, 3U, &success);
+    assert(success);
+    assert(object->header->shape != NULL && object->header->shape->keys.header->slot_count > 0U);
+    assert(CJSON_Object_get_uint64(object, "key11", &success) == 311U && success);
+    const struct CJSON_Key key = CJSON_Parser_key(&parser, "key7", 4U);
+    assert(CJSON_Object_get_key(object, &key)->value.uint64 == 307U);
+    assert(CJSON_Object_get(object, "key12") == NULL);
+
+    CJSON_Parser_free(&parser);
+}
+
+static void test_compact(void) {
+    const char data[] = "{\"id\": 18446744073709551615, \"name\": \"caf\\u00e9\", \"ratio\": -2.5, \"ok\": true, \"none\": null,"
+                        " \"list\": [1, -2, [], {}], \"id\": 7, \"nested\": {\"deep\": [\"x\"]}}";
+
+    assert(sizeof(struct CJSON_Compact) == 16U);
+
+    for(unsigned lazy = 0U; lazy < 2U; lazy++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        if(lazy == 1U) {
+            parser.options |= CJSON_PARSER_OPTION_LAZY_NUMBERS;
+        }
+
+        struct CJSON_Compact *const json = CJSON_parse_compact(&parser, data, (unsigned)sizeof(data) - 1U);
+        assert(json != NULL);
+        assert(parser.error == CJSON_ERROR_NONE);
+        assert(json->type == CJSON_OBJECT && json->length == 8U);
+        assert(strcmp(json->value.members[1].key, "name") == 0);
+
+        //a duplicated key is kept, the lookup finds the last one
+        assert(CJSON_Compact_as_uint64(CJSON_Compact_get(json, "id"), &success) == 7U && success);
+        assert(CJSON_Compact_as_uint64(&json->value.members[0].value, &success) == UINT64_MAX && success);
+        CJSON_Compact_as_int64(&json->value.members[0].value, &success);
+        assert(!success);
+
+        unsigned length;
+        const char *const name = CJSON_Compact_as_string_n(CJSON_Compact_get(json, "name"), &length, &success);
+        assert(success && length == 5U && strcmp(name, "caf\xC3\xA9") == 0);
+        assert(CJSON_Compact_as_float64(CJSON_Compact_get(json, "ratio"), &success) == -2.5 && success);
+        assert(CJSON_Compact_as_int64(CJSON_Compact_get(json, "ratio"), &success) == -2 && success);
+        assert(CJSON_Compact_as_bool(CJSON_Compact_get(json, "ok"), &success) && success);
+        assert(CJSON_Compact_is_null(CJSON_Compact_get(json, "none")));
+        CJSON_Compact_as_string(CJSON_Compact_get(json, "none"), &success);
+        assert(!success);
+        assert(CJSON_Compact_get(json, "missing") == NULL);
+
+        const struct CJSON_Key list_key = CJSON_KEY("list");
+        const struct CJSON_Compact *const list = CJSON_Compact_get_key(json, &list_key);
+        assert(list != NULL && list->type == CJSON_ARRAY && list->length == 4U);
+        assert(CJSON_Compact_as_int64(CJSON_Compact_at(list, 1U), &success) == -2 && success);
+        assert(CJSON_Compact_at(list, 2U)->type == CJSON_ARRAY && CJSON_Compact_at(list, 2U)->length == 0U);
+        assert(CJSON_Compact_at(list, 3U)->type == CJSON_OBJECT && CJSON_Compact_at(list, 3U)->length == 0U);
+        assert(CJSON_Compact_at(list, 4U) == NULL);
+        assert(CJSON_Compact_at(json, 0U) == NULL);
+        assert(CJSON_Compact_get(list, "id") == NULL);
+
+        const struct CJSON_Compact *const deep = CJSON_Compact_get(CJSON_Compact_get(json, "nested"), "deep");
+        assert(strcmp(CJSON_Compact_as_string(CJSON_Compact_at(deep, 0U), &success), "x") == 0 && success);
+
+        CJSON_Parser_free(&parser);
+    }
+
+    //a big object is looked up through its hash index, still finding the last duplicated key
+    char big[2048];
+    unsigned big_length = 0U;
+    big[big_length++] = '{';
+    for(unsigned i = 0U; i < 100U; i++) {
+        big_length += (unsigned)sprintf(big + big_length, "\"key%u\": %u, ", i, i);
+    }
+    big_length += (unsigned)sprintf(big + big_length, "\"key5\": 500}");
+    {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        struct CJSON_Compact *const json = CJSON_parse_compact(&parser, big, big_length);
+        assert(json != NULL && json->type == CJSON_OBJECT && json->length == 101U);
+        for(unsigned i = 0U; i < 100U; i++) {
+            char key[16];
+            sprintf(key, "key%u", i);
+            assert(CJSON_Compact_as_uint64(CJSON_Compact_get(json, key), &success) == (i == 5U ? 500U : i) && success);
+        }
+        const struct CJSON_Key key = CJSON_Parser_key(&parser, "key99", 5U);
+        assert(CJSON_Compact_as_uint64(CJSON_Compact_get_key(json, &key), &success) == 99U && success);
+        assert(CJSON_Compact_get(json, "key100") == NULL);
+        assert(CJSON_Compact_get(json, "") == NULL);
+        CJSON_Parser_free(&parser);
+    }
+
+    const char *const invalid[] = {"[1, 2", "{\"a\" 1}", "{\"a\": 1,}", "[1 2]", "{1: 2}"};
+    for(unsigned i = 0U; i < sizeof(invalid) / sizeof(*invalid); i++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        assert(CJSON_parse_compact(&parser, invalid[i], (unsigned)strlen(invalid[i])) == NULL);
+        assert(parser.error != CJSON_ERROR_NONE);
+    }
+}
+
+static void test_tape(void) {
+    const char data[] = "{\"id\": 18446744073709551615, \"name\": \"caf\\u00e9\", \"ratio\": -2.5, \"ok\": true, \"none\": null,"
+                        " \"list\": [1, -2, [], {}], \"id\": 7, \"nested\": {\"deep\": [\"x\"]}}";
+
+    struct CJSON_Tape tape;
+    CJSON_Tape_init(&tape);
+    assert(CJSON_Tape_parse(&tape, data, (unsigned)sizeof(data) - 1U));
+    assert(tape.error == CJSON_ERROR_NONE);
+
+    //the root object is linked to its closing curly, the last word of the tape
+    assert(tape.words[0] >> 56 == CJSON_TAPE_TAG_OBJECT && (unsigned)tape.words[0] == tape.word_count);
+    assert(tape.words[tape.word_count - 1U] >> 56 == CJSON_TAPE_TAG_OBJECT_END);
+
+    struct CJSON_TapeValue root;
+    assert(CJSON_Tape_root(&tape, &root));
+    assert(CJSON_TapeValue_type(&root) == CJSON_OBJECT && CJSON_TapeValue_length(&root) == 8U);
+
+    //a duplicated key is kept, the lookup finds the first one
+    assert(CJSON_TapeValue_get_uint64(&root, "id", &success) == UINT64_MAX && success);
+    CJSON_TapeValue_get_int64(&root, "id", &success);
+    assert(!success);
+
+    unsigned length;
+    const char *const name = CJSON_TapeValue_get_string_n(&root, "name", &length, &success);
+    assert(success && length == 5U && strcmp(name, "caf\xC3\xA9") == 0);
+    assert(CJSON_TapeValue_get_float64(&root, "ratio", &success) == -2.5 && success);
+    assert(CJSON_TapeValue_get_int64(&root, "ratio", &success) == -2 && success);
+    assert(CJSON_TapeValue_get_bool(&root, "ok", &success) && success);
+    CJSON_TapeValue_get_string_n(&root, "none", &length, &success);
+    assert(!success);
+    CJSON_TapeValue_get_bool(&root, "missing", &success);
+    assert(!success);
+
+    struct CJSON_TapeValue value;
+    assert(CJSON_TapeValue_get(&root, "none", &value) && CJSON_TapeValue_is_null(&value));
+    assert(CJSON_TapeValue_get(&root, "list", &value) && CJSON_TapeValue_type(&value) == CJSON_ARRAY && CJSON_TapeValue_length(&value) == 4U);
+    assert(CJSON_TapeValue_get_int64(&root, "list[1]", &success) == -2 && success);
+    assert(CJSON_TapeValue_get(&root, "list[2]", &value) && CJSON_TapeValue_type(&value) == CJSON_ARRAY && CJSON_TapeValue_length(&value) == 0U);
+    assert(CJSON_TapeValue_get(&root, "list[3]", &value) && CJSON_TapeValue_type(&value) == CJSON_OBJECT && CJSON_TapeValue_length(&value) == 0U);
+    assert(!CJSON_TapeValue_get(&root, "list[4]", &value));
+    assert(!CJSON_TapeValue_at(&root, 0U, &value));
+    assert(strcmp(CJSON_TapeValue_get_string_n(&root, "nested.deep[0]", &length, &success), "x") == 0 && success && length == 1U);
+
+    //the copy owns its words and strings
+    struct CJSON_Tape copy;
+    CJSON_Tape_init(&copy);
+    assert(CJSON_Tape_copy(&copy, &tape));
+    CJSON_Tape_free(&tape);
+
+    char *const string = CJSON_Tape_to_string(&copy);
+    assert(string != NULL);
+    assert(strcmp(string, "{\"id\":18446744073709551615,\"name\":\"caf\xC3\xA9\",\"ratio\":-2.5,\"ok\":true,\"none\":null,"
+                          "\"list\":[1,-2,[],{}],\"id\":7,\"nested\":{\"deep\":[\"x\"]}}") == 0);
+    CJSON_FREE(string);
+    CJSON_Tape_free(&copy);
+
+    const char *const invalid[] = {"[1, 2", "{\"a\" 1}", "{\"a\": 1,}", "[1 2]", "{1: 2}", "\"\\u00\"", "[1] 2"};
+    for(unsigned i = 0U; i < sizeof(invalid) / sizeof(*invalid); i++) {
+        assert(!CJSON_Tape_parse(&tape, invalid[i], (unsigned)strlen(invalid[i])));
+        assert(tape.error != CJSON_ERROR_NONE && tape.words == NULL);
+        assert(!CJSON_Tape_root(&tape, &root));
+    }
+
+    assert(CJSON_Tape_parse(&tape, "[3]", 3U));
+    assert(CJSON_Tape_root(&tape, &root) && CJSON_TapeValue_get_int64(&root, "[0]", &success) == 3 && success);
+    CJSON_Tape_free(&tape);
+}
+
+static void test_compact_tokens(void) {
+    const char document[] = "{\"key\": [1, \"two\", null], \"other\": -3.5}";
+
+    struct CJSON_Tokens   tokens;
+    struct CJSON_Counters counters;
+    struct CJSON_Lexer    lexer;
+
+    assert(sizeof(struct CJSON_Token) == 8U);
+
+    CJSON_Tokens_init(&tokens);
+    CJSON_Counters_init(&counters);
+    CJSON_Lexer_init(&lexer, document, sizeof(document) - 1);
+    assert(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) == CJSON_LEXER_ERROR_DONE);
+    assert(tokens.input == document);
+    assert(tokens.count == 16U);
+
+    //the opening curly and bracket hold their number of elements once the containers are counted
+    assert(tokens.data[0].type == CJSON_TOKEN_LCURLY);
+    assert(tokens.data[0].length == 2U);
+    assert(tokens.data[3].type == CJSON_TOKEN_LBRACKET);
+    assert(tokens.data[3].length == 3U);
+
+    assert(tokens.data[1].type == CJSON_TOKEN_STRING);
+    assert(tokens.data[1].length == 5U);
+    assert(strncmp(tokens.input + tokens.data[1].offset, "\"key\"", 5) == 0);
+
+    assert(tokens.data[13].type == CJSON_TOKEN_FLOAT);
+    assert(strncmp(tokens.input + tokens.data[13].offset, "-3.5", tokens.data[13].length) == 0);
+
+    assert(tokens.data[15].type == CJSON_TOKEN_DONE);
+    assert(tokens.data[15].offset == sizeof(document) - 1);
+
+    CJSON_Tokens_free(&tokens);
+
+    //the containers are counted while lexing but an invalid token is still the error over an unmatched bracket
+    const char unmatched[] = "[[1, 2], 3]] nope";
+    CJSON_Tokens_init(&tokens);
+    CJSON_Counters_init(&counters);
+    CJSON_Lexer_init(&lexer, unmatched, sizeof(unmatched) - 1);
+    assert(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) == CJSON_LEXER_ERROR_TOKEN);
+    assert(tokens.data[0].length == 2U);
+    assert(tokens.data[1].length == 2U);
+    CJSON_Tokens_free(&tokens);
+}
+
+//a string longer than a token length is read again and a container with more elements than it has its count capped
+static void test_token_limits(void) {
+    const unsigned string_length = CJSON_TOKEN_MAXIMUM_LENGTH + 16U;
+    char *const long_string = (char*)malloc((size_t)string_length + 2U);
+    assert(long_string != NULL);
+    long_string[0] = '"';
+    memset(long_string + 1, 'a', string_length);
+    memcpy(long_string + string_length - 3U, "\\\"a", 3U);
+    long_string[string_length + 1U] = '"';
+
+    struct CJSON_Tokens   tokens;
+    struct CJSON_Counters counters;
+    struct CJSON_Lexer    lexer;
+
+    const enum CJSON_Indexer_Backend backends[] = {CJSON_INDEXER_BACKEND_SCALAR, CJSON_INDEXER_BACKEND_SSE2};
+    for(unsigned i = 0U; i < sizeof(backends) / sizeof(*backends); i++) {
+        if(!CJSON_Indexer_set_backend(backends[i])) {
+            continue;
+        }
+        CJSON_Tokens_init(&tokens);
+        CJSON_Counters_init(&counters);
+        CJSON_Lexer_init(&lexer, long_string, string_length + 2U);
+        assert(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) == CJSON_LEXER_ERROR_DONE);
+        assert(tokens.count == 2U);
+        assert(tokens.data[0].length == CJSON_TOKEN_MAXIMUM_LENGTH);
+        assert(CJSON_Token_length(tokens.data, long_string) == string_length + 2U);
+        assert(counters.chars == string_length + 1U);
+        CJSON_Tokens_free(&tokens);
+    }
+    assert(CJSON_Indexer_set_backend(CJSON_INDEXER_BACKEND_SCALAR));
+
+    const unsigned options[] = {CJSON_PARSER_OPTION_NONE, CJSON_PARSER_OPTION_SINGLE_PASS};
+    for(unsigned i = 0U; i < sizeof(options) / sizeof(*options); i++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        parser.options = options[i];
+        struct CJSON *const json = CJSON_parse(&parser, long_string, string_length + 2U);
+        assert(json != NULL);
+        assert(json->type == CJSON_STRING);
+        assert(json->value.string.length == string_length - 1U);
+        assert(memcmp(json->value.string.chars + string_length - 4U, "\"a", 2U) == 0);
+        CJSON_Parser_free(&parser);
+    }
+    free(long_string);
+
+    //the lexer counts all the elements, the opening token only holds a hint the array grows past
+    const char document[] = "[1, {\"a\": 2, \"b\": 3, \"c\": 4}, [5, 6], 7]";
+    CJSON_Tokens_init(&tokens);
+    CJSON_Counters_init(&counters);
+    CJSON_Lexer_init(&lexer, document, sizeof(document) - 1);
+    assert(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) == CJSON_LEXER_ERROR_DONE);
+    assert(tokens.data[0].length == 4U);
+    assert(tokens.data[3].length == 3U);
+
+    tokens.data[0].length = CJSON_TOKEN_MAXIMUM_LENGTH;
+    assert(CJSON_Token_count(tokens.data) == 4U);
+    tokens.data[0].length = 1U;
+    tokens.data[3].length = 1U;
+
+    struct CJSON_Parser parser;
+    CJSON_Parser_init(&parser);
+    assert(CJSON_Parser_reserve(&parser, &counters));
+    struct CJSON *const json = CJSON_new(&parser);
+    assert(json != NULL);
+    tokens.current_token = tokens.data;
+    assert(CJSON_parse_token(&parser, json, &tokens));
+    assert(json->type == CJSON_ARRAY);
+    assert(json->value.array.count == 4U);
+    assert(CJSON_get_int64(json->value.array.values + 1, "c", &success) == 4);
+    assert(success);
+    assert(json->value.array.values[2].value.array.count == 2U);
+    assert(CJSON_get_int64(json, "[3]", &success) == 7);
+    assert(success);
+    CJSON_Parser_free(&parser);
+    CJSON_Tokens_free(&tokens);
+}
+
+static void test_indexer_backends(void) {
+    const char document[] = "{\"key1\": [1, -2.5, 3e2, true, false, null],"
+        "\"key2\": \"escaped \\\" quote and \\\\ backslash\","
+        "\"key3\": {\"nested\": \"{[:,]}\", \"empty\": {}},"
+        "\"a long enough key to cross the 64 bytes block boundary of the indexer\": []}";
+
+    struct CJSON_Tokens   expected_tokens, tokens;
+    struct CJSON_Counters expected_counters, counters;
+    struct CJSON_Lexer    lexer;
+
+    assert(CJSON_Indexer_set_backend(CJSON_INDEXER_BACKEND_SCALAR));
+    CJSON_Tokens_init(&expected_tokens);
+    CJSON_Counters_init(&expected_counters);
+    CJSON_Lexer_init(&lexer, document, sizeof(document) - 1);
+    assert(CJSON_Lexer_tokenize(&lexer, &expected_tokens, &expected_counters) == CJSON_LEXER_ERROR_DONE);
+
+    const enum CJSON_Indexer_Backend backends[] = {CJSON_INDEXER_BACKEND_SSE2, CJSON_INDEXER_BACKEND_AVX2};
+    for(unsigned i = 0U; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if(!CJSON_Indexer_set_backend(backends[i])) {
+            continue;
+        }
+
+        CJSON_Tokens_init(&tokens);
+        CJSON_Counters_init(&counters);
+        CJSON_Lexer_init(&lexer, document, sizeof(document) - 1);
+        assert(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) == CJSON_LEXER_ERROR_DONE);
+        assert(tokens.count == expected_tokens.count);
+        assert(memcmp(&counters, &expected_counters, sizeof(counters)) == 0);
+        for(unsigned j = 0U; j < tokens.count; j++) {
+            assert(tokens.data[j].type   == expected_tokens.data[j].type);
+            assert(tokens.data[j].length == expected_tokens.data[j].length);
+            assert(tokens.data[j].type == CJSON_TOKEN_DONE || tokens.data[j].offset == expected_tokens.data[j].offset);
+        }
+        CJSON_Tokens_free(&tokens);
+
+        const char unterminated[] = "[\"this string is never closed\\\"]";
+        CJSON_Tokens_init(&tokens);
+        CJSON_Counters_init(&counters);
+        CJSON_Lexer_init(&lexer, unterminated, sizeof(unterminated) - 1);
+        assert(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) == CJSON_LEXER_ERROR_TOKEN);
+        CJSON_Tokens_free(&tokens);
+    }
+
+    CJSON_Tokens_free(&expected_tokens);
+    assert(CJSON_Indexer_set_backend(CJSON_INDEXER_BACKEND_SCALAR));
+    assert(CJSON_Indexer_get_backend() == CJSON_INDEXER_BACKEND_SCALAR);
+}
+
+static void test_single_pass(void) {
+    const char *const documents[] = {
+        "{\"key1\": [1, -2.5, 3e2, true, false, null], \"key2\": {\"nested\": [[], {}, [[\"deep\"]]]}, \"key1\": \"dup\"}",
+        "[{\"a\": 1, \"b\": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]}, {\"a\": 2, \"b\": []}, \"escaped \\\" \\u00e9\"]",
+        "  -12  ",
+        "\"string\""
+    };
+
+    for(unsigned i = 0U; i < sizeof(documents) / sizeof(documents[0]); i++) {
+        const unsigned length = (unsigned)strlen(documents[i]);
+
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        const struct CJSON *const expected_json = CJSON_parse(&parser, documents[i], length);
+        assert(expected_json != NULL);
+
+        struct CJSON_Parser single_pass_parser;
+        CJSON_Parser_init(&single_pass_parser);
+        single_pass_parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+        const struct CJSON *const json = CJSON_parse(&single_pass_parser, documents[i], length);
+        assert(json != NULL);
+        assert(single_pass_parser.error == CJSON_ERROR_NONE);
+
+        char *const expected_string = CJSON_to_string(expected_json, 0U);
+        char *const string          = CJSON_to_string(json, 0U);
+        assert(expected_string != NULL && string != NULL);
+        assert(strcmp(expected_string, string) == 0);
+        free(expected_string);
+        free(string);
+
+        CJSON_Parser_free(&parser);
+        CJSON_Parser_free(&single_pass_parser);
+    }
+
+    const char *const invalid_documents[] = {
+        "[1, 2",
+        "{\"key\": 1",
+        "{\"key\" 1}",
+        "{key: 1}",
+        "[1 2]",
+        "{\"key\": 1 \"key2\": 2}",
+        "[1, ]",
+        "[1, 2] ]x",
+        "   ",
+        "1 1",
+        "1 1,",
+        "[ ]]",
+        "{} []"
+    };
+    const enum CJSON_Error errors[] = {
+        CJSON_ERROR_ARRAY,
+        CJSON_ERROR_OBJECT,
+        CJSON_ERROR_MISSING_COLON,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_MISSING_COMMA_OR_RBRACKET,
+        CJSON_ERROR_MISSING_COMMA_OR_RCURLY,
+        CJSON_ERROR_ARRAY_VALUE,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN,
+        CJSON_ERROR_TOKEN
+    };
+
+    for(unsigned i = 0U; i < sizeof(invalid_documents) / sizeof(invalid_documents[0]); i++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+        assert(CJSON_parse(&parser, invalid_documents[i], (unsigned)strlen(invalid_documents[i])) == NULL);
+        assert(parser.error == errors[i]);
+        CJSON_Parser_free(&parser);
+    }
+
+    //the tokens after the root value are rejected the same way without the option
+    const char *const trailing_documents[] = {"1 1", "1 1,", "[ ]]", "{} []"};
+    for(unsigned i = 0U; i < sizeof(trailing_documents) / sizeof(trailing_documents[0]); i++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        assert(CJSON_parse(&parser, trailing_documents[i], (unsigned)strlen(trailing_documents[i])) == NULL);
+        assert(parser.error == CJSON_ERROR_TOKEN);
+        CJSON_Parser_free(&parser);
+    }
+}
+
+static void test_zero_copy(void) {
+    const char document[] = "{\"plain\": \"value\", \"escaped\": \"tab\\there\", \"list\": [\"a\", \"\\u00e9\"], \"plain\": \"last\"}";
+    const char *const end = document + sizeof(document) - 1;
+
+    for(unsigned single_pass = 0U; single_pass < 2U; single_pass++) {
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        parser.options |= CJSON_PARSER_OPTION_ZERO_COPY;
+        if(single_pass == 1U) {
+            parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+        }
+
+        struct CJSON *const json = CJSON_parse(&parser, document, sizeof(document) - 1);
+        assert(json != NULL);
+        assert(parser.error == CJSON_ERROR_NONE);
+
+        unsigned length;
+        const char *value = CJSON_get_string_n(json, "plain", &length, &success);
+        assert(success);
+        assert(length == 4U);
+        assert(memcmp(value, "last", 4U) == 0);
+        assert(value > document && value < end);
+
+        value = CJSON_Object_get_string_n(&json->value.object, "escaped", &length, &success);
+        assert(success);
+        assert(length == 8U);
+        assert(strcmp(value, "tab\there") == 0);
+        assert(value < document || value >= end);
+
+        const struct CJSON_Array *const list = CJSON_get_array(json, "list", &success);
+        assert(success);
+        value = CJSON_Array_get_string_n(list, 0U, &length, &success);
+        assert(success);
+        assert(length == 1U && value[0] == 'a');
+        value = CJSON_Array_get_string_n(list, 1U, &length, &success);
+        assert(success);
+        assert(length == 2U && strcmp(value, "\xC3\xA9") == 0);
+
+        for(unsigned i = 0U; i < CJSON_Object_length(&json->value.object); i++) {
+            unsigned          key_length;
+            const char *const key = CJSON_Object_key_at(&json->value.object, i, &key_length);
+            if(key != NULL) {
+                assert(key > document && key < end);
+            }
+        }
+
+        CJSON_Object_set_bool(&json->value.object, &parser, "added", true);
+        assert(CJSON_get_bool(json, "added", &success));
+        assert(success);
+
+        char *const string = CJSON_to_string(json, 0U);
+        assert(string != NULL);
+        assert(strstr(string, "\"plain\":\"last\"") != NULL);
+        assert(strstr(string, "\"escaped\":\"tab\\there\"") != NULL);
+        free(string);
+
+        CJSON_Parser_free(&parser);
+    }
+}
+
+static void test_insitu(void) {
+    const char document[] = "{\"plain\": \"value\", \"escaped\": \"tab\\there \\u00e9\", \"list\": [\"a\", \"\", 1]}";
+
+    for(unsigned single_pass = 0U; single_pass < 2U; single_pass++) {
+        char buffer[sizeof(document)];
+        memcpy(buffer, document, sizeof(document));
+
+        struct CJSON_Parser parser;
+        CJSON_Parser_init(&parser);
+        if(single_pass == 1U) {
+            parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+        }
+
+        struct CJSON *const json = CJSON_parse_insitu(&parser, buffer, sizeof(buffer) - 1);
+        assert(json != NULL);
+        assert(parser.error == CJSON_ERROR_NONE);
+        assert(parser.insitu == NULL);
+
+        const char *value = CJSON_get_string(json, "plain", &success);
+        assert(success);
+        assert(strcmp(value, "value") == 0);
+        assert(value > buffer && value < buffer + sizeof(buffer));
+
+        value = CJSON_get_string(json, "escaped", &success);
+        assert(success);
+        assert(strcmp(value, "tab\there \xC3\xA9") == 0);
+        assert(value > buffer && value < buffer + sizeof(buffer));
+
+        value = CJSON_get_string(json, "list[1]", &success);
+        assert(success);
+        assert(value[0] == '\0');
+
+        for(unsigned i = 0U; i < CJSON_Object_length(&json->value.object); i++) {
+            unsigned          key_length;
+            const char *const key = CJSON_Object_key_at(&json->value.object, i, &key_length);
+            if(key != NULL) {
+                assert(key > buffer && key < buffer + sizeof(buffer));
+                assert(strlen(key) == key_length);
+            }
+        }
+
+        CJSON_Parser_free(&parser);
+
+        struct CJSON_FileContents file_contents;
+        file_contents.data = (unsigned char*)buffer;
+        file_contents.size = sizeof(document) - 1;
+        memcpy(buffer, document, sizeof(document));
+        assert(CJSON_FileContents_put(&file_contents, "test_output.txt") == CJSON_FILECONTENTS_ERROR_NONE);
+
+        CJSON_Parser_init(&parser);
+        struct CJSON *const file_json = CJSON_parse_file(&parser, "test_output.txt");
+        assert(file_json != NULL);
+        value = CJSON_get_string(file_json, "escaped", &success);
+        assert(success);
+        assert(strcmp(value, "tab\there \xC3\xA9") == 0);
+        CJSON_Parser_free(&parser);
+        remove("test_output.txt");
+    }
+}
+
 int main(void) {
     test_empty_object();
     test_empty_array();
@@ -642,10 +2485,20 @@ int main(void) {
     test_escaped_unicode();
     test_bools();
     test_exponent();
+    test_numbers();
+    test_lazy_numbers();
+    test_ondemand();
+    test_sax();
+    test_stream();
+    test_array_reader();
+    test_parse_many();
+    test_parse_many_parallel();
+    test_parse_parallel();
     test_null();
     test_missing_value();
     test_comments();
     test_deep_nesting();
+    test_max_depth();
     test_no_quotes_key();
     test_nested_arrays();
     test_duplicate_keys();
@@ -653,6 +2506,20 @@ int main(void) {
     test_create_primitives();
     test_create_array();
     test_create_object();
+    test_object_table();
+    test_key_length();
+    test_key_handles();
+    test_key_interning();
+    test_small_object();
+    test_object_shapes();
+    test_compact();
+    test_tape();
+    test_compact_tokens();
+    test_token_limits();
+    test_indexer_backends();
+    test_single_pass();
+    test_zero_copy();
+    test_insitu();
 
     puts("All tests successful");
 
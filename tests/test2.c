@@ -1,12 +1,17 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 
 #include "../cjson.h"
 #include "../util.h"
 #include "../file.h"
 #include "../allocator.h"
+#include "../indexer.h"
+#include "../lexer.h"
+#include "../tokens.h"
+#include "../counters.h"
 
 int main(void) {
     struct CJSON_FileContents file_contents;
@@ -17,16 +22,117 @@ int main(void) {
         return EXIT_FAILURE;
     }
 
-    const uint64_t start = CJSON_usec_timestamp();
+    const enum CJSON_Indexer_Backend backends[] = {
+        CJSON_INDEXER_BACKEND_SCALAR,
+        CJSON_INDEXER_BACKEND_SSE2,
+        CJSON_INDEXER_BACKEND_AVX2
+    };
+    const char *const backend_names[] = {"scalar", "sse2", "avx2"};
+
+    //the lexer alone is faster with the blocks but a whole parse is not on every CPU, so the scalar backend is the default
     struct CJSON_Parser parser;
     CJSON_Parser_init(&parser);
+    for(unsigned i = 0U; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if(!CJSON_Indexer_set_backend(backends[i])) {
+            continue;
+        }
+
+        struct CJSON_Tokens tokens;
+        struct CJSON_Counters counters;
+        struct CJSON_Lexer lexer;
+        CJSON_Tokens_init(&tokens);
+        CJSON_Counters_init(&counters);
+        CJSON_Lexer_init(&lexer, (const char*)file_contents.data, file_contents.size);
+        uint64_t start = CJSON_usec_timestamp();
+        if(CJSON_Lexer_tokenize(&lexer, &tokens, &counters) != CJSON_LEXER_ERROR_DONE) {
+            CJSON_Tokens_free(&tokens);
+            CJSON_FileContents_free(&file_contents);
+            return EXIT_FAILURE;
+        }
+        uint64_t end = CJSON_usec_timestamp();
+        printf("Lexing time (%s): %" PRIu64 " microseconds\n", backend_names[i], end - start);
+        CJSON_Tokens_free(&tokens);
+
+        start = CJSON_usec_timestamp();
+        if(CJSON_parse(&parser, (const char*)file_contents.data, file_contents.size) == NULL) {
+            fputs(CJSON_get_error(&parser), stderr);
+            CJSON_FileContents_free(&file_contents);
+            return EXIT_FAILURE;
+        }
+        end = CJSON_usec_timestamp();
+        printf("Parsing time (%s): %" PRIu64 " microseconds\n", backend_names[i], end - start);
+
+        CJSON_Parser_free(&parser);
+    }
+    CJSON_Indexer_set_backend(CJSON_INDEXER_BACKEND_SCALAR);
+
+    parser.options |= CJSON_PARSER_OPTION_SINGLE_PASS;
+    uint64_t start = CJSON_usec_timestamp();
     if(CJSON_parse(&parser, (const char*)file_contents.data, file_contents.size) == NULL) {
         fputs(CJSON_get_error(&parser), stderr);
         CJSON_FileContents_free(&file_contents);
         return EXIT_FAILURE;
     }
-    const uint64_t end = CJSON_usec_timestamp();
-    printf("Parsing time: %" PRIu64 " microseconds\n", end - start);
+    uint64_t end = CJSON_usec_timestamp();
+    printf("Parsing time (single pass): %" PRIu64 " microseconds\n", end - start);
+    CJSON_Parser_free(&parser);
+
+    parser.options = CJSON_PARSER_OPTION_LAZY_NUMBERS;
+    start = CJSON_usec_timestamp();
+    if(CJSON_parse(&parser, (const char*)file_contents.data, file_contents.size) == NULL) {
+        fputs(CJSON_get_error(&parser), stderr);
+        CJSON_FileContents_free(&file_contents);
+        return EXIT_FAILURE;
+    }
+    end = CJSON_usec_timestamp();
+    printf("Parsing time (lazy numbers): %" PRIu64 " microseconds\n", end - start);
+    CJSON_Parser_free(&parser);
+
+    struct CJSON_Handler handler;
+    memset(&handler, 0, sizeof(handler));
+    start = CJSON_usec_timestamp();
+    if(CJSON_parse_sax((const char*)file_contents.data, file_contents.size, &handler, NULL) != CJSON_ERROR_NONE) {
+        CJSON_FileContents_free(&file_contents);
+        return EXIT_FAILURE;
+    }
+    end = CJSON_usec_timestamp();
+    printf("Parsing time (sax): %" PRIu64 " microseconds\n", end - start);
+
+    //the stream is timed like the plain parse, without the lazy numbers of the run before
+    parser.options = CJSON_PARSER_OPTION_NONE;
+    struct CJSON_StreamParser stream;
+    CJSON_StreamParser_init(&stream, &parser);
+    start = CJSON_usec_timestamp();
+    for(unsigned position = 0U; position < file_contents.size; position += 16384U) {
+        const unsigned chunk_length = MIN(16384U, file_contents.size - position);
+        if(!CJSON_StreamParser_feed(&stream, (const char*)file_contents.data + position, chunk_length)) {
+            fputs(CJSON_get_error(&parser), stderr);
+            CJSON_StreamParser_free(&stream);
+            CJSON_FileContents_free(&file_contents);
+            return EXIT_FAILURE;
+        }
+    }
+    if(CJSON_StreamParser_finish(&stream) == NULL) {
+        fputs(CJSON_get_error(&parser), stderr);
+        CJSON_StreamParser_free(&stream);
+        CJSON_FileContents_free(&file_contents);
+        return EXIT_FAILURE;
+    }
+    end = CJSON_usec_timestamp();
+    printf("Parsing time (16 KB chunks): %" PRIu64 " microseconds\n", end - start);
+    CJSON_StreamParser_free(&stream);
+    CJSON_Parser_free(&parser);
+
+    //in situ parsing overwrites the input so it has to be the last one
+    parser.options = CJSON_PARSER_OPTION_NONE;
+    start = CJSON_usec_timestamp();
+    if(CJSON_parse_insitu(&parser, (char*)file_contents.data, file_contents.size) == NULL) {
+        fputs(CJSON_get_error(&parser), stderr);
+        CJSON_FileContents_free(&file_contents);
+        return EXIT_FAILURE;
+    }
+    end = CJSON_usec_timestamp();
+    printf("Parsing time (in situ): %" PRIu64 " microseconds\n", end - start);
 
     CJSON_FileContents_free(&file_contents);
     CJSON_Parser_free(&parser);
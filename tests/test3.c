@@ -64,6 +64,21 @@ static void test_object_to_string(void) {
     CJSON_FREE(string);
 }
 
+static void test_object_order_to_string(void) {
+    const char object[] = "{\"zeta\": 1, \"alpha\": 2, \"mid\": 3, \"beta\": 4}";
+    const char expected[] = "{\"zeta\":1,\"mid\":3,\"beta\":4,\"gamma\":true}";
+
+    struct CJSON *const json = CJSON_parse(&parser, object, (unsigned)(sizeof(object)) - 1U);
+    assert(json != NULL);
+    CJSON_Object_delete(&json->value.object, "alpha");
+    assert(CJSON_Object_set_bool(&json->value.object, &parser, "gamma", true));
+    const unsigned size = CJSON_to_string_size(json, 0U);
+    assert(size == static_strlen(expected));
+    char *const string = CJSON_to_string(json, 0U);
+    assert(strcmp(string, expected) == 0);
+    CJSON_FREE(string);
+}
+
 static void test_array_of_object_to_string(void) {
     const char array[] = "["
         "{\"key1\": \"value1\"},"
@@ -147,6 +162,7 @@ int main(void) {
     test_string_to_string();
     test_numbers_to_string();
     test_object_to_string();
+    test_object_order_to_string();
     test_array_of_object_to_string();
     test_deeply_nested_array();
     test_to_string();
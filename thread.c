@@ -0,0 +1,175 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+
+#include "thread.h"
+#include "util.h"
+
+#ifdef _WIN32
+
+static DWORD WINAPI CJSON_Thread_start(LPVOID argument) {
+    struct CJSON_Thread *const thread = (struct CJSON_Thread*)argument;
+    thread->function(thread->argument);
+
+    return 0;
+}
+
+EXTERN_C bool CJSON_Thread_create(struct CJSON_Thread *const thread, void (*const function)(void*), void *const argument) {
+    assert(thread != NULL);
+    assert(function != NULL);
+
+    thread->function = function;
+    thread->argument = argument;
+    thread->handle   = CreateThread(NULL, 0U, CJSON_Thread_start, thread, 0U, NULL);
+
+    return thread->handle != NULL;
+}
+
+EXTERN_C void CJSON_Thread_join(struct CJSON_Thread *const thread) {
+    assert(thread != NULL);
+
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+EXTERN_C unsigned CJSON_Thread_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    return info.dwNumberOfProcessors > 0U ? (unsigned)info.dwNumberOfProcessors : 1U;
+}
+
+EXTERN_C bool CJSON_Mutex_init(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    InitializeCriticalSection(&mutex->handle);
+    return true;
+}
+
+EXTERN_C void CJSON_Mutex_free(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    DeleteCriticalSection(&mutex->handle);
+}
+
+EXTERN_C void CJSON_Mutex_lock(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    EnterCriticalSection(&mutex->handle);
+}
+
+EXTERN_C void CJSON_Mutex_unlock(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    LeaveCriticalSection(&mutex->handle);
+}
+
+EXTERN_C bool CJSON_Condition_init(struct CJSON_Condition *const condition) {
+    assert(condition != NULL);
+
+    InitializeConditionVariable(&condition->handle);
+    return true;
+}
+
+EXTERN_C void CJSON_Condition_free(struct CJSON_Condition *const condition) {
+    assert(condition != NULL);
+    (void)condition;
+}
+
+EXTERN_C void CJSON_Condition_wait(struct CJSON_Condition *const condition, struct CJSON_Mutex *const mutex) {
+    assert(condition != NULL);
+    assert(mutex != NULL);
+
+    SleepConditionVariableCS(&condition->handle, &mutex->handle, INFINITE);
+}
+
+EXTERN_C void CJSON_Condition_broadcast(struct CJSON_Condition *const condition) {
+    assert(condition != NULL);
+
+    WakeAllConditionVariable(&condition->handle);
+}
+
+#else
+
+static void *CJSON_Thread_start(void *const argument) {
+    struct CJSON_Thread *const thread = (struct CJSON_Thread*)argument;
+    thread->function(thread->argument);
+
+    return NULL;
+}
+
+EXTERN_C bool CJSON_Thread_create(struct CJSON_Thread *const thread, void (*const function)(void*), void *const argument) {
+    assert(thread != NULL);
+    assert(function != NULL);
+
+    thread->function = function;
+    thread->argument = argument;
+
+    return pthread_create(&thread->handle, NULL, CJSON_Thread_start, thread) == 0;
+}
+
+EXTERN_C void CJSON_Thread_join(struct CJSON_Thread *const thread) {
+    assert(thread != NULL);
+
+    pthread_join(thread->handle, NULL);
+}
+
+EXTERN_C unsigned CJSON_Thread_count(void) {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0L ? (unsigned)count : 1U;
+}
+
+EXTERN_C bool CJSON_Mutex_init(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    return pthread_mutex_init(&mutex->handle, NULL) == 0;
+}
+
+EXTERN_C void CJSON_Mutex_free(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    pthread_mutex_destroy(&mutex->handle);
+}
+
+EXTERN_C void CJSON_Mutex_lock(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    pthread_mutex_lock(&mutex->handle);
+}
+
+EXTERN_C void CJSON_Mutex_unlock(struct CJSON_Mutex *const mutex) {
+    assert(mutex != NULL);
+
+    pthread_mutex_unlock(&mutex->handle);
+}
+
+EXTERN_C bool CJSON_Condition_init(struct CJSON_Condition *const condition) {
+    assert(condition != NULL);
+
+    return pthread_cond_init(&condition->handle, NULL) == 0;
+}
+
+EXTERN_C void CJSON_Condition_free(struct CJSON_Condition *const condition) {
+    assert(condition != NULL);
+
+    pthread_cond_destroy(&condition->handle);
+}
+
+EXTERN_C void CJSON_Condition_wait(struct CJSON_Condition *const condition, struct CJSON_Mutex *const mutex) {
+    assert(condition != NULL);
+    assert(mutex != NULL);
+
+    pthread_cond_wait(&condition->handle, &mutex->handle);
+}
+
+EXTERN_C void CJSON_Condition_broadcast(struct CJSON_Condition *const condition) {
+    assert(condition != NULL);
+
+    pthread_cond_broadcast(&condition->handle);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_THREAD_H
+#define CJSON_THREAD_H
+
+#include <stdbool.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+struct CJSON_Thread {
+#ifdef _WIN32
+    HANDLE             handle;
+#else
+    pthread_t          handle;
+#endif
+    void             (*function)(void*);
+    void              *argument;
+};
+
+struct CJSON_Mutex {
+#ifdef _WIN32
+    CRITICAL_SECTION   handle;
+#else
+    pthread_mutex_t    handle;
+#endif
+};
+
+struct CJSON_Condition {
+#ifdef _WIN32
+    CONDITION_VARIABLE handle;
+#else
+    pthread_cond_t     handle;
+#endif
+};
+
+//the thread struct must stay at the same address until CJSON_Thread_join returns
+bool     CJSON_Thread_create(struct CJSON_Thread*, void (*function)(void*), void *argument);
+void     CJSON_Thread_join  (struct CJSON_Thread*);
+//the number of processors online, at least 1
+unsigned CJSON_Thread_count (void);
+
+bool     CJSON_Mutex_init   (struct CJSON_Mutex*);
+void     CJSON_Mutex_free   (struct CJSON_Mutex*);
+void     CJSON_Mutex_lock   (struct CJSON_Mutex*);
+void     CJSON_Mutex_unlock (struct CJSON_Mutex*);
+
+bool     CJSON_Condition_init     (struct CJSON_Condition*);
+void     CJSON_Condition_free     (struct CJSON_Condition*);
+void     CJSON_Condition_wait     (struct CJSON_Condition*, struct CJSON_Mutex*);
+void     CJSON_Condition_broadcast(struct CJSON_Condition*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -24,12 +24,22 @@ enum CJSON_Token_Type {
     CJSON_TOKEN_DONE
 };
 
+//the biggest length a token holds. A longer string has this length and CJSON_Token_length finds its end again,
+//a longer number fails to lex. A bigger container has this count and CJSON_Token_count counts its elements again
+#define CJSON_TOKEN_MAXIMUM_LENGTH ((1U << 28) - 1U)
+
+//8 bytes, the token is the input from offset to offset + CJSON_Token_length
 struct CJSON_Token {
-    const char           *value;
-    unsigned              length;
-    enum CJSON_Token_Type type;
+    unsigned offset;
+    unsigned length : 28; //the number of elements for an opening bracket or curly once the containers are counted, capped
+    unsigned type   : 4;  //enum CJSON_Token_Type
 };
 
+//the length of the token in data, the input its offset points into
+unsigned CJSON_Token_length(const struct CJSON_Token*, const char *data);
+//the number of elements of a counted container, the tokens up to its closing one follow it
+unsigned CJSON_Token_count(const struct CJSON_Token*);
+
 #endif
 
 #ifdef __cplusplus
@@ -9,6 +9,7 @@
 EXTERN_C void CJSON_Tokens_init(struct CJSON_Tokens *const tokens) {
     assert(tokens != NULL);
 
+    tokens->input         = NULL;
     tokens->data          = NULL;
     tokens->current_token = NULL;
     tokens->capacity      = 0U;
@@ -11,6 +11,7 @@ extern "C" {
 #include "token.h"
 
 struct CJSON_Tokens {
+    const char         *input; //the input the offsets of the tokens point into
     struct CJSON_Token *data,
                        *current_token;
     unsigned count,
@@ -42,6 +42,19 @@ EXTERN_C bool CJSON_is_delimiter(const char c) {
     }
 }
 
+//true when the data is only whitespace
+EXTERN_C bool CJSON_is_blank(const char *const data, const unsigned length) {
+    assert(data != NULL);
+
+    for(unsigned i = 0U; i < length; i++) {
+        if(!CJSON_is_whitespace(data[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 EXTERN_C bool CJSON_is_control_char(const char c) {
     return c >= (char)0x00 && c <= (char)0x1F;
 }
@@ -0,0 +1,228 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "walker.h"
+#include "stack.h"
+#include "util.h"
+
+//a container is open, its first element is the next value unless it's empty
+static void *CJSON_Walker_open(const struct CJSON_Walker *const walker, void *const value, struct CJSON_Tokens *const tokens, bool *const is_empty) {
+    assert(walker != NULL);
+    assert(tokens != NULL);
+    assert(tokens->current_token != NULL);
+    assert(is_empty != NULL);
+
+    const struct CJSON_Token *const token     = tokens->current_token;
+    const bool                      is_object = token->type == CJSON_TOKEN_LCURLY;
+    tokens->current_token++;
+
+    const struct CJSON_Token *const last_token = tokens->data + tokens->count - 1U;
+    if(tokens->current_token == last_token) {
+        *walker->error = is_object ? CJSON_ERROR_OBJECT : CJSON_ERROR_ARRAY;
+        return NULL;
+    }
+
+    void *const container = walker->open(walker->context, value, token);
+    if(container == NULL) {
+        return NULL;
+    }
+
+    *is_empty = tokens->current_token->type == (is_object ? CJSON_TOKEN_RCURLY : CJSON_TOKEN_RBRACKET);
+    if(*is_empty && !walker->close(walker->context, container, tokens->current_token++)) {
+        return NULL;
+    }
+
+    return container;
+}
+
+//the value of the next element of an open container: the key and the colon of an object member are read here
+static void *CJSON_Walker_element(const struct CJSON_Walker *const walker, void *const container, const bool is_object, struct CJSON_Tokens *const tokens) {
+    assert(walker != NULL);
+    assert(tokens != NULL);
+    assert(tokens->current_token != NULL);
+
+    const struct CJSON_Token *const last_token = tokens->data + tokens->count - 1U;
+
+    if(!is_object) {
+        if(last_token - tokens->current_token < 2) {
+            *walker->error = CJSON_ERROR_ARRAY;
+            return NULL;
+        }
+
+        return walker->element(walker->context, container, NULL);
+    }
+
+    if(last_token - tokens->current_token < 4) {
+        *walker->error = CJSON_ERROR_OBJECT;
+        return NULL;
+    }
+
+    const struct CJSON_Token *const key = tokens->current_token;
+    if(key->type != CJSON_TOKEN_STRING) {
+        *walker->error = CJSON_ERROR_OBJECT_KEY;
+        return NULL;
+    }
+
+    tokens->current_token++;
+
+    if(tokens->current_token->type != CJSON_TOKEN_COLON) {
+        *walker->error = CJSON_ERROR_MISSING_COLON;
+        return NULL;
+    }
+
+    tokens->current_token++;
+
+    return walker->element(walker->context, container, key);
+}
+
+//the open containers are kept on the containers stack with whether they are objects on top of each of them.
+//depth is the number of containers the value is already in
+static bool CJSON_Walker_value(
+    const struct CJSON_Walker *const walker,
+    void *value,
+    struct CJSON_Tokens *const tokens,
+    struct CJSON_Stack *const containers,
+    const unsigned depth
+) {
+    assert(walker != NULL);
+    assert(tokens != NULL);
+    assert(tokens->current_token != NULL);
+    assert(containers != NULL);
+    assert(containers->count == 0U);
+
+    while(true) {
+        const struct CJSON_Token *const token = tokens->current_token;
+        void *container = NULL;
+
+        switch(token->type) {
+        case CJSON_TOKEN_STRING:
+        case CJSON_TOKEN_INT:
+        case CJSON_TOKEN_FLOAT:
+        case CJSON_TOKEN_SCIENTIFIC_INT:
+        case CJSON_TOKEN_BOOL:
+        case CJSON_TOKEN_NULL:
+            if(!walker->scalar(walker->context, value, token)) {
+                return false;
+            }
+            tokens->current_token++;
+            break;
+
+        case CJSON_TOKEN_LBRACKET:
+        case CJSON_TOKEN_LCURLY: {
+            if(depth + containers->count / 2U >= walker->max_depth) {
+                *walker->error = CJSON_ERROR_DEPTH;
+                return false;
+            }
+
+            bool is_empty;
+            if((container = CJSON_Walker_open(walker, value, tokens, &is_empty)) == NULL) {
+                return false;
+            }
+            if(is_empty) {
+                container = NULL;
+            }
+            break;
+        }
+
+        default:
+            if(containers->count == 0U) {
+                *walker->error = CJSON_ERROR_TOKEN;
+            } else {
+                void *const flag = CJSON_Stack_unsafe_peek(containers);
+                *walker->error = VOID_PTR_TO_UNSIGNED(flag) != 0U ? CJSON_ERROR_OBJECT_VALUE : CJSON_ERROR_ARRAY_VALUE;
+            }
+            return false;
+        }
+
+        if(container != NULL) {
+            const bool is_object = token->type == CJSON_TOKEN_LCURLY;
+            if(!CJSON_Stack_push(containers, container) || !CJSON_Stack_push(containers, UNSIGNED_TO_VOID_PTR(is_object ? 1U : 0U))) {
+                *walker->error = CJSON_ERROR_MEMORY;
+                return false;
+            }
+            if((value = CJSON_Walker_element(walker, container, is_object, tokens)) == NULL) {
+                return false;
+            }
+            continue;
+        }
+
+        //the value is complete, the containers it closes are popped until one has a next element
+        value = NULL;
+        while(containers->count > 0U && value == NULL) {
+            void *const flag      = containers->data[containers->count - 1U];
+            void *const top       = containers->data[containers->count - 2U];
+            const bool  is_object = VOID_PTR_TO_UNSIGNED(flag) != 0U;
+
+            if(tokens->current_token->type == CJSON_TOKEN_COMMA) {
+                tokens->current_token++;
+                if((value = CJSON_Walker_element(walker, top, is_object, tokens)) == NULL) {
+                    return false;
+                }
+            } else if(tokens->current_token->type == (is_object ? CJSON_TOKEN_RCURLY : CJSON_TOKEN_RBRACKET)) {
+                containers->count -= 2U;
+                if(!walker->close(walker->context, top, tokens->current_token++)) {
+                    return false;
+                }
+            } else {
+                *walker->error = is_object ? CJSON_ERROR_MISSING_COMMA_OR_RCURLY : CJSON_ERROR_MISSING_COMMA_OR_RBRACKET;
+                return false;
+            }
+        }
+
+        if(value == NULL) {
+            return true;
+        }
+    }
+}
+
+EXTERN_C bool CJSON_walk(const struct CJSON_Walker *const walker, void *const value, struct CJSON_Tokens *const tokens) {
+    assert(walker != NULL);
+    assert(tokens != NULL);
+
+    struct CJSON_Stack containers;
+    CJSON_Stack_init(&containers);
+
+    const bool success = CJSON_Walker_value(walker, value, tokens, &containers, 0U);
+    CJSON_Stack_free(&containers);
+    if(!success) {
+        return false;
+    }
+
+    //nothing can follow the root value
+    if(tokens->current_token->type != CJSON_TOKEN_DONE) {
+        *walker->error = CJSON_ERROR_TOKEN;
+        return false;
+    }
+
+    return true;
+}
+
+EXTERN_C bool CJSON_walk_elements(const struct CJSON_Walker *const walker, const bool is_object, const unsigned count, struct CJSON_Tokens *const tokens) {
+    assert(walker != NULL);
+    assert(tokens != NULL);
+    assert(tokens->current_token != NULL);
+
+    struct CJSON_Stack containers;
+    CJSON_Stack_init(&containers);
+
+    bool success = true;
+    for(unsigned i = 0U; i < count && success; i++) {
+        if(i > 0U) {
+            if(tokens->current_token->type != CJSON_TOKEN_COMMA) {
+                *walker->error = is_object ? CJSON_ERROR_MISSING_COMMA_OR_RCURLY : CJSON_ERROR_MISSING_COMMA_OR_RBRACKET;
+                success = false;
+                break;
+            }
+            tokens->current_token++;
+        }
+
+        void *const value = CJSON_Walker_element(walker, NULL, is_object, tokens);
+        success = value != NULL && CJSON_Walker_value(walker, value, tokens, &containers, 1U);
+        if(!success && *walker->error == CJSON_ERROR_TOKEN) {
+            *walker->error = is_object ? CJSON_ERROR_OBJECT_VALUE : CJSON_ERROR_ARRAY_VALUE;
+        }
+    }
+
+    CJSON_Stack_free(&containers);
+    return success;
+}
@@ -0,0 +1,35 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CJSON_WALKER_H
+#define CJSON_WALKER_H
+
+#include <stdbool.h>
+#include "json.h"
+#include "tokens.h"
+
+//the grammar of the token buffer, the documents built from it only get the values through the callbacks.
+//open makes a container of the value and element gives the value of its next element with the token of its key for an object,
+//they return NULL when they fail. close gets the closing token, an empty container is closed as well. A failing callback sets *error
+struct CJSON_Walker {
+    void *(*open)   (void *context, void *value, const struct CJSON_Token *token);
+    void *(*element)(void *context, void *container, const struct CJSON_Token *key);
+    bool  (*scalar) (void *context, void *value, const struct CJSON_Token *token);
+    bool  (*close)  (void *context, void *container, const struct CJSON_Token *token);
+    void             *context;
+    enum CJSON_Error *error;
+    unsigned          max_depth;
+};
+
+//walks the value at tokens->current_token without recursion, nothing can follow it
+bool CJSON_walk         (const struct CJSON_Walker*, void *value, struct CJSON_Tokens*);
+//walks count elements separated by commas from tokens->current_token as if their container was open, element gets
+//a NULL container for them. The token after the last one is left to the caller
+bool CJSON_walk_elements(const struct CJSON_Walker*, bool is_object, unsigned count, struct CJSON_Tokens*);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif